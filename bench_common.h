@@ -0,0 +1,988 @@
+#ifndef FAAQ_BENCH_COMMON_H
+#define FAAQ_BENCH_COMMON_H
+
+// Helpers shared by the benchmark programs. Header-only; every function is
+// static so each benchmark gets its own copy.
+//
+// Benchmarks must define _GNU_SOURCE before including any system header.
+
+#include <linux/perf_event.h>
+#include <math.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <threads.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+inline static uint64_t
+rdtsc_serialized(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+    unsigned int aux;
+    return __rdtscp(&aux);
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    uint64_t val;
+    __asm__ volatile("dmb ish" : : : "memory");
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(val));
+    return val;
+#else
+#warning "Serialized RDTSC benchmarking not supported on this architecture."
+    return 0;
+#endif
+}
+
+#define RDTSC() rdtsc_serialized()
+
+// Monotonic clock in nanoseconds, unaffected by wall clock adjustments.
+inline static uint64_t
+bench_now_ns(void) {
+    struct timespec ts;
+    // clock_gettime is a non-standard POSIX function
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+inline static int
+bench_online_cpus(void) {
+    // sysconf is a non-standard POSIX function
+    int num_cores = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    return num_cores > 0 ? num_cores : 1;
+}
+
+// Pins the calling thread to exactly 'cpu'.
+inline static void
+bench_pin_cpu(int cpu) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+
+    // sched_setaffinity is a non-standard POSIX function
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &cpuset) != 0) {
+        // Not fatal, but might affect results stability
+    }
+}
+
+// Pins the calling thread to 'cpu' (modulo the online CPU count).
+inline static void
+bench_pin_thread(int cpu) {
+    bench_pin_cpu(cpu % bench_online_cpus());
+}
+
+// --- CPU Placement ---
+//
+// Orders the CPUs the process may run on so that thread i can be pinned to
+// entry i (modulo the count). Topology comes from sysfs; where it is missing
+// every CPU counts as its own core and both orders are by CPU number.
+
+typedef enum {
+    BENCH_AFFINITY_COMPACT, // SMT siblings first, then the next core, then the next package.
+    BENCH_AFFINITY_SCATTER, // One thread per package, then per core, before SMT siblings.
+    BENCH_AFFINITY_NONE,    // No pinning; placement is left to the scheduler.
+} bench_affinity_t;
+
+inline static bool
+bench_parse_affinity(char const *name, bench_affinity_t *affinity) {
+    static char const *const names[] = {"compact", "scatter", "none"};
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *affinity = (bench_affinity_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline static char const *
+bench_affinity_name(bench_affinity_t affinity) {
+    return affinity == BENCH_AFFINITY_COMPACT ? "compact" : affinity == BENCH_AFFINITY_SCATTER ? "scatter" : "none";
+}
+
+typedef struct {
+    int cpu;
+    int package;
+    int core;
+    int smt; // Rank among the CPUs sharing this core.
+    int l3;  // Last-level cache id; the package when unknown.
+} bench_cpu_t;
+
+// Reads one integer from a CPU's sysfs topology directory.
+inline static int
+bench_cpu_topology(int cpu, char const *file, int fallback) {
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, file);
+    FILE *f     = fopen(path, "r");
+    int   value = fallback;
+    if (f) {
+        if (fscanf(f, "%d", &value) != 1) {
+            value = fallback;
+        }
+        fclose(f);
+    }
+    return value;
+}
+
+inline static int
+bench_cpu_compare_compact(void const *a, void const *b) {
+    bench_cpu_t const *x = a, *y = b;
+    if (x->package != y->package) {
+        return x->package - y->package;
+    }
+    if (x->core != y->core) {
+        return x->core - y->core;
+    }
+    return x->smt != y->smt ? x->smt - y->smt : x->cpu - y->cpu;
+}
+
+inline static int
+bench_cpu_compare_scatter(void const *a, void const *b) {
+    bench_cpu_t const *x = a, *y = b;
+    if (x->smt != y->smt) {
+        return x->smt - y->smt;
+    }
+    if (x->core != y->core) {
+        return x->core - y->core;
+    }
+    return x->package != y->package ? x->package - y->package : x->cpu - y->cpu;
+}
+
+// Id of the level 3 cache 'cpu' sits behind, or 'fallback' if sysfs does
+// not describe one.
+inline static int
+bench_cpu_l3_id(int cpu, int fallback) {
+    for (int index = 0; index < 8; index++) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, index);
+        FILE *f     = fopen(path, "r");
+        int   level = 0;
+        if (!f) {
+            break;
+        }
+        if (fscanf(f, "%d", &level) != 1) {
+            level = 0;
+        }
+        fclose(f);
+        if (level != 3) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/id", cpu, index);
+        f      = fopen(path, "r");
+        int id = fallback;
+        if (f) {
+            if (fscanf(f, "%d", &id) != 1) {
+                id = fallback;
+            }
+            fclose(f);
+        }
+        return id;
+    }
+    return fallback;
+}
+
+// Fills 'info' with the topology of up to 'max' CPUs this thread may run on,
+// in CPU number order, and returns how many there are.
+inline static int
+bench_cpu_info(bench_cpu_t *info, int max) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return 0;
+    }
+    int n = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && n < max; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        bench_cpu_t c = {
+            .cpu     = cpu,
+            .package = bench_cpu_topology(cpu, "physical_package_id", 0),
+            .core    = bench_cpu_topology(cpu, "core_id", cpu),
+            .smt     = 0,
+        };
+        c.l3 = bench_cpu_l3_id(cpu, c.package);
+        for (int i = 0; i < n; i++) {
+            c.smt += info[i].package == c.package && info[i].core == c.core;
+        }
+        info[n++] = c;
+    }
+    return n;
+}
+
+// Fills 'cpus' with up to 'max' CPU numbers in the order given by
+// 'affinity' and returns how many there are (at least one).
+inline static int
+bench_cpu_order(bench_affinity_t affinity, int *cpus, int max) {
+    bench_cpu_t *info = calloc(CPU_SETSIZE, sizeof(bench_cpu_t));
+    int const    n    = info ? bench_cpu_info(info, max) : 0;
+    if (n == 0) {
+        free(info);
+        cpus[0] = 0;
+        return 1;
+    }
+
+    qsort(
+        info,
+        (size_t) n,
+        sizeof(bench_cpu_t),
+        affinity == BENCH_AFFINITY_SCATTER ? bench_cpu_compare_scatter : bench_cpu_compare_compact
+    );
+    for (int i = 0; i < n; i++) {
+        cpus[i] = info[i].cpu;
+    }
+    free(info);
+    return n;
+}
+
+// --- Start Barrier ---
+
+typedef struct {
+    mtx_t mutex;
+    cnd_t cond;
+    int   count;
+    int   target;
+} bench_barrier_t;
+
+inline static bool
+bench_barrier_init(bench_barrier_t *b, int target) {
+    b->count  = 0;
+    b->target = target;
+    if (mtx_init(&b->mutex, mtx_plain) != thrd_success) {
+        return false;
+    }
+    if (cnd_init(&b->cond) != thrd_success) {
+        mtx_destroy(&b->mutex);
+        return false;
+    }
+    return true;
+}
+
+inline static void
+bench_barrier_wait(bench_barrier_t *b) {
+    mtx_lock(&b->mutex);
+    b->count++;
+    if (b->count == b->target) {
+        cnd_broadcast(&b->cond);
+    } else {
+        while (b->count < b->target) {
+            cnd_wait(&b->cond, &b->mutex);
+        }
+    }
+    mtx_unlock(&b->mutex);
+}
+
+inline static void
+bench_barrier_destroy(bench_barrier_t *b) {
+    mtx_destroy(&b->mutex);
+    cnd_destroy(&b->cond);
+}
+
+// --- Allocation ---
+
+// Allocates 'count' zeroed elements of 'size' bytes on a 128-byte boundary,
+// so aligned members of benchmark state keep their own cache lines. Exits on
+// failure; release with free().
+inline static void *
+bench_alloc(size_t count, size_t size) {
+    size_t const bytes = (count * size / 128 + 1) * 128;
+    void        *p     = aligned_alloc(128, bytes);
+    if (!p) {
+        fprintf(stderr, "Failed to allocate benchmark state.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(p, 0, bytes);
+    return p;
+}
+
+// --- Producer/Consumer Threads ---
+//
+// The threads of one run: 'producers' threads running one function followed
+// by 'consumers' threads running another, all held at a start barrier until
+// the caller reaches it too.
+
+typedef struct {
+    thrd_t          *threads;
+    int              count;
+    bench_barrier_t *barrier;
+} bench_threads_t;
+
+// Initializes 'barrier' for the threads plus the caller and starts the
+// threads. Thread 'tid' is passed (char *) args + tid * arg_size. The caller
+// releases them with bench_barrier_wait(). Exits on failure.
+inline static void
+bench_threads_start(
+    bench_threads_t *t,
+    bench_barrier_t *barrier,
+    int              producers,
+    thrd_start_t     producer,
+    int              consumers,
+    thrd_start_t     consumer,
+    void            *args,
+    size_t           arg_size
+) {
+    t->count   = producers + consumers;
+    t->threads = bench_alloc((size_t) t->count, sizeof(thrd_t));
+    t->barrier = barrier;
+    if (!bench_barrier_init(barrier, t->count + 1)) {
+        fprintf(stderr, "Failed to initialize mutex/condvar.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int tid = 0; tid < t->count; ++tid) {
+        thrd_start_t const fn = tid < producers ? producer : consumer;
+        if (thrd_create(&t->threads[tid], fn, (char *) args + (size_t) tid * arg_size) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", tid);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Joins every thread and destroys the barrier.
+inline static void
+bench_threads_join(bench_threads_t *t) {
+    for (int tid = 0; tid < t->count; ++tid) {
+        thrd_join(t->threads[tid], nullptr);
+    }
+    bench_barrier_destroy(t->barrier);
+    free(t->threads);
+    t->threads = nullptr;
+}
+
+// --- Event Counters ---
+//
+// A single perf counter for the calling process, including threads it creates
+// after the counter is opened. Opening fails harmlessly where the PMU is not
+// available (VMs, containers, perf_event_paranoid), in which case reads
+// return BENCH_EVENT_UNAVAILABLE.
+
+#define BENCH_EVENT_UNAVAILABLE UINT64_MAX
+
+typedef struct {
+    int fd;
+} bench_event_t;
+
+inline static void
+bench_event_open(bench_event_t *e, uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.inherit        = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    e->fd               = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// dTLB load misses, the cost of walking a chain of nodes spread over pages.
+inline static void
+bench_event_open_dtlb_misses(bench_event_t *e) {
+    bench_event_open(
+        e,
+        PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+    );
+}
+
+inline static uint64_t
+bench_event_read(bench_event_t const *e) {
+    uint64_t value;
+    if (e->fd < 0 || read(e->fd, &value, sizeof(value)) != (ssize_t) sizeof(value)) {
+        return BENCH_EVENT_UNAVAILABLE;
+    }
+    return value;
+}
+
+inline static void
+bench_event_close(bench_event_t *e) {
+    if (e->fd >= 0) {
+        close(e->fd);
+    }
+    e->fd = -1;
+}
+
+// Page faults (minor + major) taken by the process so far. Uses getrusage, so
+// it works without perf.
+inline static uint64_t
+bench_page_faults(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (uint64_t) ru.ru_minflt + (uint64_t) ru.ru_majflt;
+}
+
+// Resident set size of the process from /proc/self/statm, 0 if unavailable.
+inline static uint64_t
+bench_rss_bytes(void) {
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) {
+        return 0;
+    }
+    unsigned long long size, resident;
+    int const          n = fscanf(f, "%llu %llu", &size, &resident);
+    fclose(f);
+    return n == 2 ? (uint64_t) resident * (uint64_t) sysconf(_SC_PAGESIZE) : 0;
+}
+
+// --- Per-Thread Counter Groups ---
+//
+// Hardware counters for the calling thread only, opened as one perf group so
+// they are scheduled onto the PMU together and read in a single call. Each
+// thread wraps its measured loop in start/stop and the results are summed
+// with bench_counters_add(). Counters the PMU cannot provide read as
+// BENCH_EVENT_UNAVAILABLE; the software counters (CPU time, context switches,
+// faults) come from the kernel's per-thread accounting and are always there.
+//
+// There is no generic HITM event. Pass the model's raw event to count it,
+// e.g. 0x04d2 (MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM) on Skylake server parts;
+// 0 leaves it unavailable.
+
+enum {
+    BENCH_HW_INSTRUCTIONS,
+    BENCH_HW_CACHE_MISSES,
+    BENCH_HW_BRANCH_MISSES,
+    BENCH_HW_HITM,
+    BENCH_HW_COUNTERS,
+};
+
+static char const *const BENCH_HW_COUNTER_NAMES[BENCH_HW_COUNTERS] = {
+    "instructions",
+    "cache-misses",
+    "branch-misses",
+    "hitm",
+};
+
+typedef struct {
+    uint64_t hw[BENCH_HW_COUNTERS];
+    uint64_t cpu_ns;
+    uint64_t voluntary_switches;
+    uint64_t involuntary_switches;
+    uint64_t minor_faults;
+} bench_counters_t;
+
+typedef struct {
+    int              leader;
+    int              fds[BENCH_HW_COUNTERS];
+    int              slot[BENCH_HW_COUNTERS]; // Position in the group read, or -1.
+    int              members;
+    bench_counters_t start;
+} bench_counter_group_t;
+
+inline static void
+bench_thread_software_counters(bench_counters_t *c) {
+    struct rusage   ru;
+    struct timespec ts;
+    getrusage(RUSAGE_THREAD, &ru);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    c->cpu_ns               = (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+    c->voluntary_switches   = (uint64_t) ru.ru_nvcsw;
+    c->involuntary_switches = (uint64_t) ru.ru_nivcsw;
+    c->minor_faults         = (uint64_t) ru.ru_minflt;
+}
+
+// Opens the group disabled; the first counter that opens leads it.
+inline static void
+bench_counter_group_open(bench_counter_group_t *g, uint64_t hitm_config) {
+    static struct {
+        uint32_t type;
+        uint64_t config;
+    } const events[BENCH_HW_COUNTERS] = {
+        [BENCH_HW_INSTRUCTIONS]  = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        [BENCH_HW_CACHE_MISSES]  = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        [BENCH_HW_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        [BENCH_HW_HITM]          = {PERF_TYPE_RAW,      0                          },
+    };
+
+    g->leader  = -1;
+    g->members = 0;
+    for (int i = 0; i < BENCH_HW_COUNTERS; i++) {
+        g->fds[i]  = -1;
+        g->slot[i] = -1;
+        if (i == BENCH_HW_HITM && hitm_config == 0) {
+            continue;
+        }
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = events[i].type;
+        attr.config         = i == BENCH_HW_HITM ? hitm_config : events[i].config;
+        attr.disabled       = g->leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        g->fds[i]           = (int) syscall(SYS_perf_event_open, &attr, 0, -1, g->leader, 0);
+        if (g->fds[i] >= 0) {
+            g->leader  = g->leader < 0 ? g->fds[i] : g->leader;
+            g->slot[i] = g->members++;
+        }
+    }
+}
+
+inline static void
+bench_counter_group_start(bench_counter_group_t *g) {
+    if (g->leader >= 0) {
+        ioctl(g->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(g->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    bench_thread_software_counters(&g->start);
+}
+
+// Stores the counts since bench_counter_group_start() in 'out'. Hardware
+// counts are scaled up if the kernel had to multiplex the group.
+inline static void
+bench_counter_group_stop(bench_counter_group_t *g, bench_counters_t *out) {
+    bench_thread_software_counters(out);
+    out->cpu_ns               -= g->start.cpu_ns;
+    out->voluntary_switches   -= g->start.voluntary_switches;
+    out->involuntary_switches -= g->start.involuntary_switches;
+    out->minor_faults         -= g->start.minor_faults;
+
+    struct {
+        uint64_t nr;
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[BENCH_HW_COUNTERS];
+    } data;
+    bool ok = false;
+    if (g->leader >= 0) {
+        ioctl(g->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        ok = read(g->leader, &data, sizeof(data)) > 0 && data.nr == (uint64_t) g->members && data.time_running > 0;
+    }
+    for (int i = 0; i < BENCH_HW_COUNTERS; i++) {
+        if (!ok || g->slot[i] < 0) {
+            out->hw[i] = BENCH_EVENT_UNAVAILABLE;
+            continue;
+        }
+        out->hw[i] = (uint64_t) ((double) data.values[g->slot[i]] * (double) data.time_enabled
+                                 / (double) data.time_running);
+    }
+}
+
+inline static void
+bench_counter_group_close(bench_counter_group_t *g) {
+    for (int i = 0; i < BENCH_HW_COUNTERS; i++) {
+        if (g->fds[i] >= 0) {
+            close(g->fds[i]);
+        }
+        g->fds[i] = -1;
+    }
+    g->leader = -1;
+}
+
+// Adds 'src' to 'dst'. A hardware counter missing on either side stays
+// unavailable in the sum.
+inline static void
+bench_counters_add(bench_counters_t *dst, bench_counters_t const *src) {
+    for (int i = 0; i < BENCH_HW_COUNTERS; i++) {
+        bool const missing = dst->hw[i] == BENCH_EVENT_UNAVAILABLE || src->hw[i] == BENCH_EVENT_UNAVAILABLE;
+        dst->hw[i]         = missing ? BENCH_EVENT_UNAVAILABLE : dst->hw[i] + src->hw[i];
+    }
+    dst->cpu_ns               += src->cpu_ns;
+    dst->voluntary_switches   += src->voluntary_switches;
+    dst->involuntary_switches += src->involuntary_switches;
+    dst->minor_faults         += src->minor_faults;
+}
+
+// --- Cycle Histograms ---
+//
+// HDR-style log-linear buckets: values below 2^BENCH_HIST_SUB_BITS get a
+// bucket each, and every power of two above that is split into
+// 2^BENCH_HIST_SUB_BITS equal sub-buckets, so any recorded value is known to
+// within 1/16 (6.25%). Fixed-size and cheap enough to record from inside a
+// timed loop; per-thread histograms are combined with bench_hist_merge().
+
+#define BENCH_HIST_SUB_BITS 4
+#define BENCH_HIST_SUB      (1 << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS  ((64 - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_SUB)
+
+typedef struct {
+    uint64_t counts[BENCH_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} bench_hist_t;
+
+inline static void
+bench_hist_reset(bench_hist_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+inline static int
+bench_hist_bucket(uint64_t value) {
+    if (value < BENCH_HIST_SUB) {
+        return (int) value;
+    }
+    int const exp = 63 - __builtin_clzll(value);
+    int const sub = (int) (value >> (exp - BENCH_HIST_SUB_BITS)) & (BENCH_HIST_SUB - 1);
+    return (exp - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_SUB + sub;
+}
+
+// Smallest value of bucket 'b'.
+inline static uint64_t
+bench_hist_bucket_low(int b) {
+    if (b < BENCH_HIST_SUB) {
+        return (uint64_t) b;
+    }
+    int const exp = b / BENCH_HIST_SUB + BENCH_HIST_SUB_BITS - 1;
+    return (uint64_t) (BENCH_HIST_SUB + b % BENCH_HIST_SUB) << (exp - BENCH_HIST_SUB_BITS);
+}
+
+// Largest value of bucket 'b'.
+inline static uint64_t
+bench_hist_bucket_high(int b) {
+    if (b < BENCH_HIST_SUB) {
+        return (uint64_t) b;
+    }
+    int const exp = b / BENCH_HIST_SUB + BENCH_HIST_SUB_BITS - 1;
+    return bench_hist_bucket_low(b) + ((uint64_t) 1 << (exp - BENCH_HIST_SUB_BITS)) - 1;
+}
+
+inline static void
+bench_hist_record(bench_hist_t *h, uint64_t value) {
+    h->counts[bench_hist_bucket(value)]++;
+    h->total++;
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+inline static void
+bench_hist_merge(bench_hist_t *into, bench_hist_t const *from) {
+    for (int b = 0; b < BENCH_HIST_BUCKETS; b++) {
+        into->counts[b] += from->counts[b];
+    }
+    into->total += from->total;
+    if (from->max > into->max) {
+        into->max = from->max;
+    }
+}
+
+// Returns an upper bound for the 'q' quantile (0 < q <= 1): the top of the
+// bucket it falls in, capped at the largest recorded value.
+inline static uint64_t
+bench_hist_quantile(bench_hist_t const *h, double q) {
+    uint64_t const rank = (uint64_t) (q * (double) h->total + 0.5);
+    uint64_t       seen = 0;
+    for (int b = 0; b < BENCH_HIST_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank && seen > 0) {
+            uint64_t const top = bench_hist_bucket_high(b);
+            return top < h->max ? top : h->max;
+        }
+    }
+    return h->max;
+}
+
+// Number of recorded values below 'limit', exact when 'limit' is a power of
+// two or below BENCH_HIST_SUB.
+inline static uint64_t
+bench_hist_count_below(bench_hist_t const *h, uint64_t limit) {
+    uint64_t count = 0;
+    for (int b = 0; b < BENCH_HIST_BUCKETS && bench_hist_bucket_low(b) < limit; b++) {
+        count += h->counts[b];
+    }
+    return count;
+}
+
+// --- Time Base ---
+
+// Estimates the cycle counter frequency against the wall clock, for turning
+// RDTSC() differences into nanoseconds and rates into cycle intervals.
+inline static double
+bench_cycles_per_ns(void) {
+    uint64_t const ns_start = bench_now_ns();
+    uint64_t const c_start  = RDTSC();
+    while (bench_now_ns() - ns_start < 50000000) {
+    }
+    uint64_t const c_end  = RDTSC();
+    uint64_t const ns_end = bench_now_ns();
+    return (double) (c_end - c_start) / (double) (ns_end - ns_start);
+}
+
+// --- Trial Statistics ---
+//
+// Robust summaries for repeated runs of one configuration. Benchmarks using
+// these must link with -lm.
+
+typedef struct {
+    int    n;
+    double median;
+    double mad;     // Median absolute deviation from the median.
+    double ci_low;  // Distribution-free 95% confidence interval of the
+    double ci_high; // median, from order statistics.
+} bench_summary_t;
+
+inline static int
+bench_compare_double(void const *a, void const *b) {
+    double const x = *(double const *) a, y = *(double const *) b;
+    return (x > y) - (x < y);
+}
+
+// Median of a sorted array.
+inline static double
+bench_sorted_median(double const *sorted, int n) {
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+// Summarizes 'n' > 0 samples. 'scratch' must hold 'n' doubles.
+inline static void
+bench_summarize(double const *samples, int n, double *scratch, bench_summary_t *out) {
+    memcpy(scratch, samples, (size_t) n * sizeof(double));
+    qsort(scratch, (size_t) n, sizeof(double), bench_compare_double);
+    out->n      = n;
+    out->median = bench_sorted_median(scratch, n);
+
+    // The ranks j < k with P(x_(j) <= median <= x_(k)) >= 95%, by the normal
+    // approximation to Binomial(n, 1/2). Small samples get the full range.
+    double const half = 1.96 * sqrt((double) n) / 2;
+    int          j    = (int) floor((double) n / 2 - half);
+    int          k    = (int) ceil((double) n / 2 + half);
+    j                 = j < 0 ? 0 : j;
+    k                 = k > n - 1 ? n - 1 : k;
+    out->ci_low       = scratch[j];
+    out->ci_high      = scratch[k];
+
+    for (int i = 0; i < n; i++) {
+        scratch[i] = fabs(samples[i] - out->median);
+    }
+    qsort(scratch, (size_t) n, sizeof(double), bench_compare_double);
+    out->mad = bench_sorted_median(scratch, n);
+}
+
+// Mann-Whitney U test of 'a' against 'b' with tie correction, returned as a
+// z score: positive when 'a' tends to be larger. |z| > 1.96 is significant
+// at the 5% level. Both sides need a handful of samples for the normal
+// approximation to hold.
+inline static double
+bench_mann_whitney_z(double const *a, int na, double const *b, int nb) {
+    int const n = na + nb;
+    struct {
+        double value;
+        bool   from_a;
+    } *all = calloc((size_t) n, sizeof(*all));
+    if (!all || na == 0 || nb == 0) {
+        free(all);
+        return 0;
+    }
+    for (int i = 0; i < na; i++) {
+        all[i].value  = a[i];
+        all[i].from_a = true;
+    }
+    for (int i = 0; i < nb; i++) {
+        all[na + i].value = b[i];
+    }
+    // Insertion sort; trial counts are small.
+    for (int i = 1; i < n; i++) {
+        typeof(*all) const x = all[i];
+        int                j = i - 1;
+        for (; j >= 0 && all[j].value > x.value; j--) {
+            all[j + 1] = all[j];
+        }
+        all[j + 1] = x;
+    }
+
+    double rank_sum_a = 0, tie_term = 0;
+    for (int i = 0; i < n;) {
+        int j = i;
+        while (j < n && all[j].value == all[i].value) {
+            j++;
+        }
+        double const rank = (i + 1 + j) / 2.0; // Average of ranks i+1 .. j.
+        for (int t = i; t < j; t++) {
+            rank_sum_a += all[t].from_a ? rank : 0;
+        }
+        double const ties  = j - i;
+        tie_term          += ties * ties * ties - ties;
+        i                  = j;
+    }
+    free(all);
+
+    double const u    = rank_sum_a - (double) na * (na + 1) / 2;
+    double const mean = (double) na * nb / 2;
+    double const var  = (double) na * nb / 12 * ((n + 1) - tie_term / ((double) n * (n - 1)));
+    return var > 0 ? (u - mean) / sqrt(var) : 0;
+}
+
+// --- Queue Engines ---
+//
+// A queue under test behind create, enqueue, dequeue and destroy functions,
+// and a producer/consumer workload that runs against any engine. Benchmarks
+// that compare queues list their engines in a table.
+
+typedef struct {
+    char const *name;
+    // 'producers' of the 'max_threads' threads enqueue. Returns nullptr on
+    // failure.
+    void *(*create)(int producers, int max_threads);
+    // Returns false if the queue is full or out of memory; the caller retries.
+    bool (*enqueue)(void *q, void *item, int tid);
+    // Returns nullptr if the queue is empty.
+    void *(*dequeue)(void *q, int tid);
+    void (*destroy)(void *q);
+} bench_engine_t;
+
+typedef struct {
+    int        producers;
+    int        consumers;
+    uint64_t   items;          // Split evenly between the producers.
+    int const *cpus;           // Thread 'tid' runs on cpus[tid % num_cpus];
+    int        num_cpus;       // nullptr leaves placement to the scheduler.
+    int        latency_period; // Every Nth operation per thread is timed; 0 for none.
+} bench_workload_t;
+
+typedef struct {
+    uint64_t     total_items;
+    uint64_t     ns;
+    bench_hist_t enqueue; // Cycles, including retries on a full queue.
+    bench_hist_t dequeue; // Cycles, only of dequeues that returned an item.
+} bench_workload_result_t;
+
+typedef struct {
+    bench_engine_t const   *engine;
+    bench_workload_t const *workload;
+    void                   *queue;
+    uint64_t                items_per_producer;
+    bench_barrier_t         barrier;
+    char                    payload; // Enqueued by every producer; never examined.
+    alignas(128) atomic_int producers_done;
+} bench_workload_ctx_t;
+
+typedef struct {
+    bench_workload_ctx_t *ctx;
+    int                   tid;
+    uint64_t              items; // Dequeued, for consumers.
+    bench_hist_t          latency;
+} bench_workload_arg_t;
+
+inline static void
+bench_workload_pin(bench_workload_t const *w, int tid) {
+    if (w->cpus) {
+        bench_pin_cpu(w->cpus[tid % w->num_cpus]);
+    }
+}
+
+// Operations between timed ones. UINT64_MAX, which no count reaches, times none.
+inline static uint64_t
+bench_workload_period(bench_workload_t const *w) {
+    return w->latency_period > 0 ? (uint64_t) w->latency_period : UINT64_MAX;
+}
+
+inline static int
+bench_workload_producer(void *arg) {
+    bench_workload_arg_t *a           = arg;
+    bench_workload_ctx_t *ctx         = a->ctx;
+    uint64_t const        period      = bench_workload_period(ctx->workload);
+    uint64_t              next_sample = period == UINT64_MAX ? UINT64_MAX : 0;
+    bench_workload_pin(ctx->workload, a->tid);
+
+    bench_barrier_wait(&ctx->barrier);
+    for (uint64_t i = 0; i < ctx->items_per_producer; ++i) {
+        bool const     sampled = i == next_sample;
+        uint64_t const start   = sampled ? RDTSC() : 0;
+        while (!ctx->engine->enqueue(ctx->queue, &ctx->payload, a->tid)) {
+            thrd_yield();
+        }
+        if (sampled) {
+            bench_hist_record(&a->latency, RDTSC() - start);
+            next_sample += period;
+        }
+    }
+    atomic_fetch_add_explicit(&ctx->producers_done, 1, memory_order_release);
+    return 0;
+}
+
+inline static int
+bench_workload_consumer(void *arg) {
+    bench_workload_arg_t *a           = arg;
+    bench_workload_ctx_t *ctx         = a->ctx;
+    int const             producers   = ctx->workload->producers;
+    uint64_t const        period      = bench_workload_period(ctx->workload);
+    uint64_t              next_sample = period == UINT64_MAX ? UINT64_MAX : 0;
+    uint64_t              items       = 0;
+    bench_workload_pin(ctx->workload, a->tid);
+
+    bench_barrier_wait(&ctx->barrier);
+    while (true) {
+        // Once every producer has finished, an empty queue stays empty.
+        bool const     finished = atomic_load_explicit(&ctx->producers_done, memory_order_acquire) == producers;
+        bool const     sampled  = items == next_sample;
+        uint64_t const start    = sampled ? RDTSC() : 0;
+        if (ctx->engine->dequeue(ctx->queue, a->tid) != nullptr) {
+            if (sampled) {
+                bench_hist_record(&a->latency, RDTSC() - start);
+                next_sample += period;
+            }
+            items++;
+        } else if (finished) {
+            break;
+        } else {
+            thrd_yield();
+        }
+    }
+    a->items = items;
+    return 0;
+}
+
+// Runs 'w' against a fresh queue from 'engine'. Exits if the queue cannot be
+// created or loses items.
+inline static void
+bench_run_workload(bench_engine_t const *engine, bench_workload_t const *w, bench_workload_result_t *result) {
+    int const             threads_n = w->producers + w->consumers;
+    bench_workload_arg_t *args      = bench_alloc((size_t) threads_n, sizeof(bench_workload_arg_t));
+    bench_workload_ctx_t *ctx       = bench_alloc(1, sizeof(bench_workload_ctx_t));
+    ctx->engine                     = engine;
+    ctx->workload                   = w;
+    ctx->queue                      = engine->create(w->producers, threads_n);
+    if (!ctx->queue) {
+        fprintf(stderr, "Failed to create the %s queue.\n", engine->name);
+        exit(EXIT_FAILURE);
+    }
+    ctx->items_per_producer = w->items / (uint64_t) w->producers;
+    atomic_init(&ctx->producers_done, 0);
+    for (int tid = 0; tid < threads_n; ++tid) {
+        args[tid].ctx = ctx;
+        args[tid].tid = tid;
+    }
+
+    bench_threads_t threads;
+    bench_threads_start(
+        &threads,
+        &ctx->barrier,
+        w->producers,
+        bench_workload_producer,
+        w->consumers,
+        bench_workload_consumer,
+        args,
+        sizeof(args[0])
+    );
+    bench_barrier_wait(&ctx->barrier);
+    uint64_t const start = bench_now_ns();
+    bench_threads_join(&threads);
+    result->ns = bench_now_ns() - start;
+
+    result->total_items = ctx->items_per_producer * (uint64_t) w->producers;
+    bench_hist_reset(&result->enqueue);
+    bench_hist_reset(&result->dequeue);
+    uint64_t dequeued = 0;
+    for (int tid = 0; tid < threads_n; ++tid) {
+        bench_hist_merge(tid < w->producers ? &result->enqueue : &result->dequeue, &args[tid].latency);
+        dequeued += args[tid].items;
+    }
+    if (dequeued != result->total_items) {
+        fprintf(
+            stderr, "Error: %s lost items (%w64u of %w64u dequeued).\n", engine->name, dequeued, result->total_items
+        );
+        exit(EXIT_FAILURE);
+    }
+
+    engine->destroy(ctx->queue);
+    free(ctx);
+    free(args);
+}
+
+#endif // FAAQ_BENCH_COMMON_H
@@ -1,11 +1,118 @@
 #include "faaq.h"
+#include "faaq_inline.h"
 
 #include <assert.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <threads.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Test hook between the enqueue FAA and the slot CAS; see
+// faa_queue_set_preempt_hook().
+#ifdef FAAQ_PREEMPT_INJECTION
+static _Atomic(FAAPreemptHook_t) preempt_hook;
+
+static inline void
+preempt_point(void) {
+    FAAPreemptHook_t const hook = atomic_load_explicit(&preempt_hook, memory_order_relaxed);
+    if (hook) {
+        hook();
+    }
+}
+#else
+static inline void
+preempt_point(void) {
+}
+#endif
+
+// --- Node Pool ---
+
+struct FAA_NodePool {
+    // Node arena, nullptr for FAA_NODES_MALLOC.
+    FAAArena_t *arena;
+    // Maximum live nodes, 0 for unlimited.
+    uint64_t    budget_nodes;
+    // Live nodes plus one reference held by the queue. The pool is freed when
+    // both the queue and its last node are gone.
+    alignas(FAA_ALIGNMENT) _Atomic(uint64_t) refs;
+    alignas(FAA_ALIGNMENT) _Atomic(uint64_t) retired;
+    _Atomic(uint64_t) failed_enqueues;
+};
+
+static FAANodePool_t *
+pool_create(FAAQueueConfig_t const *cfg) {
+    FAANodePool_t *pool = aligned_alloc(FAA_ALIGNMENT, sizeof(FAANodePool_t));
+    if (!pool) {
+        return nullptr;
+    }
+    pool->arena        = nullptr;
+    pool->budget_nodes = cfg->memory_budget / sizeof(Node_t);
+    atomic_init(&pool->refs, 1);
+    atomic_init(&pool->retired, 0);
+    atomic_init(&pool->failed_enqueues, 0);
+
+    if (cfg->node_source != FAA_NODES_MALLOC) {
+        pool->arena = faa_arena_create(sizeof(Node_t), cfg->node_source == FAA_NODES_ARENA_HUGETLB);
+        if (!pool->arena) {
+            free(pool);
+            return nullptr;
+        }
+    }
+    return pool;
+}
+
+static void
+pool_unref(FAANodePool_t *pool) {
+    if (atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_release) == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        faa_arena_release(pool->arena);
+        free(pool);
+    }
+}
+
+static_assert(FAA_BUFFER_SIZE > 0 && FAA_BUFFER_SIZE % 8 == 0, "clear_slots() clears 64 bytes at a time");
+
+// Zeroes a dead node's slots so that create_node() can skip them. Uses
+// non-temporal stores where available: the reclaiming thread will not read
+// the node again, and 8 KB of slots would otherwise evict its working set.
+static void
+clear_slots(Node_t *node) {
+#if defined(__SSE2__)
+    __m128i const zero = _mm_setzero_si128();
+    char         *p    = (char *) node->items;
+    for (size_t off = 0; off < sizeof(node->items); off += 4 * sizeof(__m128i)) {
+        _mm_stream_si128((__m128i *) (p + off), zero);
+        _mm_stream_si128((__m128i *) (p + off + 16), zero);
+        _mm_stream_si128((__m128i *) (p + off + 32), zero);
+        _mm_stream_si128((__m128i *) (p + off + 48), zero);
+    }
+    // Streaming stores are weakly ordered; the fence makes them visible
+    // before the node is pushed on the freelist with a release CAS.
+    _mm_sfence();
+#else
+    memset((void *) node->items, 0, sizeof(node->items));
+#endif
+}
+
+// Returns a node's memory to its pool. Arena nodes are recycled with their
+// slots already zeroed; malloc'd nodes are freed and come back from calloc.
+static void
+node_free(Node_t *node) {
+    FAANodePool_t *pool = node->pool;
+    if (pool->arena) {
+        clear_slots(node);
+        faa_arena_free(pool->arena, node);
+    } else {
+        free(node);
+    }
+    pool_unref(pool);
+}
+
 // Reclamation function called by the HP library when the node is safe to
 // delete.
 static void
@@ -15,68 +122,157 @@ node_reclaim(hazptr_obj_t *obj) {
     }
     // The hp_base object is the first member, so casting to Node_t is safe.
     Node_t *node = (Node_t *) obj;
-    free(node);
+    atomic_fetch_sub_explicit(&node->pool->retired, 1, memory_order_relaxed);
+    node_free(node);
 }
 
+// Hands an unlinked node to the HP domain.
+static inline void
+node_retire(Node_t *node) {
+    atomic_fetch_add_explicit(&node->pool->retired, 1, memory_order_relaxed);
+    hazptr_retire(&node->hp_base, node_reclaim);
+}
+
+// Returns nullptr if the memory budget is exhausted or allocation fails.
+//
+// Every source hands out nodes whose slots are already zero: fresh arena
+// chunks are zero-filled by mmap, recycled arena nodes are cleared by
+// node_free(), and malloc'd nodes come from calloc, which can skip clearing
+// fresh pages. Only the header lines are written here, which keeps the 8 KB
+// of slots out of the enqueuer's path at a segment boundary.
 static Node_t *
-create_node(void *initial_item) {
-    Node_t *node = malloc(sizeof(Node_t));
+create_node(FAAArrayQueue_t *q, void *initial_item) {
+    FAANodePool_t *pool = q->pool;
+
+    // Reserve the node against the budget before allocating it. Retired nodes
+    // count against it until reclaimed, and hp.c only scans once enough
+    // objects are retired domain-wide, so a drained queue could stay over
+    // budget indefinitely. Force a scan before giving up.
+    uint64_t live = atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+    if (pool->budget_nodes != 0 && live > pool->budget_nodes) {
+        atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_relaxed);
+        if (atomic_load_explicit(&pool->retired, memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        hazptr_cleanup();
+        live = atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+        if (live > pool->budget_nodes) {
+            atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    Node_t *node = pool->arena ? faa_arena_alloc(pool->arena) : calloc(1, sizeof(Node_t));
     if (!node) {
-        perror("C23 FAAQueue Fatal Error: Failed to allocate Node_t");
-        abort(); // Fatal error in lock-free allocation
+        atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_relaxed);
+        return nullptr;
     }
 
     node->hp_base = (hazptr_obj_t) {};
+    node->seq     = 0;
+    node->pool    = pool;
 
     atomic_init(&node->deqidx, 0);
     atomic_init(&node->next, nullptr);
 
-    int start_idx;
-
     if (initial_item != nullptr) {
         atomic_init(&node->enqidx, 1);
         atomic_store_explicit(&node->items[0], initial_item, memory_order_relaxed);
-        start_idx = 1;
     } else {
         atomic_init(&node->enqidx, 0);
-        start_idx = 0;
-    }
-
-    for (size_t i = start_idx; i < FAA_BUFFER_SIZE; i++) {
-        atomic_init(&node->items[i], nullptr);
     }
 
     return node;
 }
 
+FAAQueueConfig_t
+faa_queue_config_default(void) {
+    return (FAAQueueConfig_t) {
+        .topology         = FAA_TOPOLOGY_MPMC,
+        .node_source      = FAA_NODES_MALLOC,
+        .wait_policy      = FAA_WAIT_SPIN,
+        .spin_limit       = FAA_DEFAULT_SPIN_LIMIT,
+        .yield_limit      = FAA_DEFAULT_YIELD_LIMIT,
+        .elimination_spin = 0,
+    };
+}
+
 FAAArrayQueue_t *
 faa_queue_create(int max_threads) {
+    return faa_queue_create_ex(max_threads, nullptr);
+}
+
+FAAArrayQueue_t *
+faa_queue_create_ex(int max_threads, FAAQueueConfig_t const *config) {
     if (max_threads <= 0) {
         fprintf(stderr, "C23 FAAQueue Error: max_threads must be > 0.\n");
         return nullptr;
     }
 
+    FAAQueueConfig_t const cfg = config ? *config : faa_queue_config_default();
+    if (cfg.memory_budget != 0 && cfg.memory_budget < sizeof(Node_t)) {
+        fprintf(stderr, "C23 FAAQueue Error: memory_budget must hold at least one node (%zu bytes).\n", sizeof(Node_t));
+        return nullptr;
+    }
+
     FAAArrayQueue_t *q = aligned_alloc(FAA_ALIGNMENT, sizeof(FAAArrayQueue_t));
     if (!q) {
         return nullptr;
     }
 
-    q->max_threads    = max_threads;
+    q->max_threads             = max_threads;
+    q->single_producer         = cfg.topology == FAA_TOPOLOGY_SPMC || cfg.topology == FAA_TOPOLOGY_SPSC;
+    q->single_consumer         = cfg.topology == FAA_TOPOLOGY_MPSC || cfg.topology == FAA_TOPOLOGY_SPSC;
+    q->wait_policy             = cfg.wait_policy;
+    q->spin_limit              = cfg.spin_limit;
+    q->yield_limit             = cfg.yield_limit;
+    q->elimination_spin        = cfg.topology == FAA_TOPOLOGY_MPMC ? cfg.elimination_spin : 0;
+    atomic_init(&q->nodes_allocated, 1); // The initial sentinel.
+    atomic_init(&q->burned_slots, 0);
+    atomic_init(&q->waited_slots, 0);
+    atomic_init(&q->eliminated, 0);
 
     q->taken_sentinel = malloc(sizeof(int));
     if (!q->taken_sentinel) {
         free(q);
         return nullptr;
     }
+    // Second unique non-null pointer, inside the same allocation.
+    q->elim_waiting = (char *) q->taken_sentinel + 1;
+
+    q->elim_slots   = nullptr;
+    if (q->elimination_spin > 0) {
+        q->elim_slots = aligned_alloc(FAA_ALIGNMENT, FAA_ELIM_SLOTS * sizeof(FAAElimSlot_t));
+        if (!q->elim_slots) {
+            free(q->taken_sentinel);
+            free(q);
+            return nullptr;
+        }
+        for (size_t i = 0; i < FAA_ELIM_SLOTS; i++) {
+            atomic_init(&q->elim_slots[i].value, nullptr);
+        }
+    }
 
-    Node_t *sentinel = create_node(nullptr);
+    q->pool          = pool_create(&cfg);
+    Node_t *sentinel = q->pool ? create_node(q, nullptr) : nullptr;
+    if (!sentinel) {
+        if (q->pool) {
+            pool_unref(q->pool);
+        }
+        free(q->elim_slots);
+        free(q->taken_sentinel);
+        free(q);
+        return nullptr;
+    }
 
     atomic_init(&q->head, sentinel);
     atomic_init(&q->tail, sentinel);
 
     q->holders = calloc(max_threads, sizeof(hazptr_holder_t));
     if (!q->holders) {
-        node_reclaim(&sentinel->hp_base);
+        node_free(sentinel);
+        pool_unref(q->pool);
+        free(q->elim_slots);
         free(q->taken_sentinel);
         free(q);
         return nullptr;
@@ -103,7 +299,7 @@ faa_queue_destroy(FAAArrayQueue_t *q) {
     Node_t *sentinel = atomic_load_explicit(&q->head, memory_order_relaxed);
     if (sentinel) {
         // We can free it directly since we assume quiescence.
-        node_reclaim(&sentinel->hp_base);
+        node_free(sentinel);
     }
 
     // Destroy HP holders.
@@ -114,11 +310,17 @@ faa_queue_destroy(FAAArrayQueue_t *q) {
         free(q->holders);
     }
 
+    free(q->elim_slots);
+
     // Delete the 'taken_sentinel'.
     if (q->taken_sentinel) {
         free(q->taken_sentinel);
     }
 
+    // Nodes still waiting in the HP domain hold their own references, so the
+    // pool (and its arena) outlives the queue until they are reclaimed.
+    pool_unref(q->pool);
+
     // Finally, free the queue structure itself.
     free(q);
 
@@ -126,26 +328,263 @@ faa_queue_destroy(FAAArrayQueue_t *q) {
     hazptr_cleanup();
 }
 
-void
+// Returns whether the queue is empty, using the same test as the dequeue
+// fast path. Leaves 'h' reset.
+static bool
+observed_empty(FAAArrayQueue_t *q, hazptr_holder_t *h) {
+    Node_t *lhead;
+    HAZPTR_PROTECT(lhead, h, &q->head);
+    size_t const  deq_idx = atomic_load_explicit(&lhead->deqidx, memory_order_acquire);
+    size_t const  enq_idx = atomic_load_explicit(&lhead->enqidx, memory_order_acquire);
+    Node_t const *lnext   = atomic_load_explicit(&lhead->next, memory_order_acquire);
+    hazptr_reset(h, nullptr);
+
+    return (deq_idx >= enq_idx || deq_idx >= FAA_BUFFER_SIZE) && lnext == nullptr;
+}
+
+// --- Elimination Layer ---
+//
+// Exchanger slot states: nullptr (free), q->elim_waiting (a dequeuer is
+// waiting) or an item (handed over, not yet picked up).
+//
+// FIFO order is preserved because a hand-off only happens when both sides
+// observed the queue empty while their operations overlapped: the pair can be
+// linearized at the later of the two observations, where no queued item could
+// be overtaken.
+
+// Producer side: hand 'item' to a waiting dequeuer if the queue is empty.
+static bool
+elim_try_handoff(FAAArrayQueue_t *q, hazptr_holder_t *h, void *item) {
+    void *const waiting = q->elim_waiting;
+    bool        checked = false;
+
+    for (size_t i = 0; i < FAA_ELIM_SLOTS; i++) {
+        _Atomic(void *) *slot = &q->elim_slots[i].value;
+        if (atomic_load_explicit(slot, memory_order_relaxed) != waiting) {
+            continue;
+        }
+        // Only worth checking (and only done once) when someone is waiting.
+        if (!checked) {
+            if (!observed_empty(q, h)) {
+                return false;
+            }
+            checked = true;
+        }
+        void *expected = waiting;
+        if (atomic_compare_exchange_strong_explicit(
+                slot, &expected, item, memory_order_release, memory_order_relaxed
+            )) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Consumer side: called after the queue was observed empty. Waits briefly in
+// an exchanger slot for a producer to hand over an item.
+static void *
+elim_await(FAAArrayQueue_t *q, int tid) {
+    void *const      waiting  = q->elim_waiting;
+    _Atomic(void *) *slot     = &q->elim_slots[(size_t) tid % FAA_ELIM_SLOTS].value;
+
+    void            *expected = nullptr;
+    if (!atomic_compare_exchange_strong_explicit(
+            slot, &expected, waiting, memory_order_relaxed, memory_order_relaxed
+        )) {
+        // Slot in use by another dequeuer.
+        return nullptr;
+    }
+
+    for (uint32_t i = 0; i < q->elimination_spin; i++) {
+        void *item = atomic_load_explicit(slot, memory_order_acquire);
+        if (item != waiting) {
+            atomic_store_explicit(slot, nullptr, memory_order_relaxed);
+            return item;
+        }
+        faa_cpu_relax();
+    }
+
+    // Withdraw. If this fails, a producer handed over an item meanwhile.
+    expected = waiting;
+    if (atomic_compare_exchange_strong_explicit(slot, &expected, nullptr, memory_order_acquire, memory_order_acquire)) {
+        return nullptr;
+    }
+    atomic_store_explicit(slot, nullptr, memory_order_relaxed);
+    return expected;
+}
+
+// Waits, according to the queue's wait policy, for the producer that claimed
+// 'slot' to store its item. Returns true if the item became visible.
+static bool
+await_slot(FAAArrayQueue_t const *q, _Atomic(void *) *slot) {
+    for (uint32_t i = 0; i < q->spin_limit; i++) {
+        if (atomic_load_explicit(slot, memory_order_relaxed) != nullptr) {
+            return true;
+        }
+        faa_cpu_relax();
+    }
+    if (q->wait_policy == FAA_WAIT_SPIN_YIELD) {
+        // The producer is most likely preempted; give it a chance to run.
+        for (uint32_t i = 0; i < q->yield_limit; i++) {
+            thrd_yield();
+            if (atomic_load_explicit(slot, memory_order_relaxed) != nullptr) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Waits, according to the queue's wait policy, for another producer to link a
+// successor to the full node 'ltail'. Returns the successor, or nullptr if
+// none appeared.
+static Node_t *
+await_successor(FAAArrayQueue_t const *q, Node_t *ltail) {
+    Node_t *lnext = atomic_load_explicit(&ltail->next, memory_order_acquire);
+    if (lnext != nullptr || q->wait_policy == FAA_WAIT_NONE) {
+        return lnext;
+    }
+    for (uint32_t i = 0; i < q->spin_limit; i++) {
+        faa_cpu_relax();
+        if ((lnext = atomic_load_explicit(&ltail->next, memory_order_acquire)) != nullptr) {
+            return lnext;
+        }
+    }
+    if (q->wait_policy == FAA_WAIT_SPIN_YIELD) {
+        for (uint32_t i = 0; i < q->yield_limit; i++) {
+            thrd_yield();
+            if ((lnext = atomic_load_explicit(&ltail->next, memory_order_acquire)) != nullptr) {
+                return lnext;
+            }
+        }
+    }
+    return nullptr;
+}
+
+// --- Single-Producer / Single-Consumer Paths ---
+
+// Enqueue for SPMC/SPSC queues. The lone producer is the only thread that
+// links nodes, so the tail node cannot be retired before it links a
+// successor: no hazard pointer and no FAA on enqidx are needed.
+static bool
+enqueue_single_producer(FAAArrayQueue_t *q, void *item) {
+    Node_t *ltail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t  idx   = atomic_load_explicit(&ltail->enqidx, memory_order_relaxed);
+
+    while (idx < FAA_BUFFER_SIZE) {
+        if (q->single_consumer) {
+            // Nobody else writes the slot: plain store, then publish enqidx.
+            atomic_store_explicit(&ltail->items[idx], item, memory_order_release);
+            atomic_store_explicit(&ltail->enqidx, idx + 1, memory_order_release);
+            return true;
+        }
+        // Consumers may have overtaken us and burned this slot.
+        void *expected = nullptr;
+        if (atomic_compare_exchange_strong_explicit(
+                &ltail->items[idx], &expected, item, memory_order_release, memory_order_relaxed
+            )) {
+            atomic_store_explicit(&ltail->enqidx, idx + 1, memory_order_release);
+            return true;
+        }
+        idx++;
+    }
+
+    // Node is full: link a new one with the item pre-filled.
+    Node_t *new_node = create_node(q, item);
+    if (!new_node) {
+        return false;
+    }
+    new_node->seq = ltail->seq + 1;
+    atomic_fetch_add_explicit(&q->nodes_allocated, 1, memory_order_relaxed);
+    // Consumers stop at this node until they observe 'next'.
+    atomic_store_explicit(&ltail->enqidx, FAA_BUFFER_SIZE, memory_order_relaxed);
+    atomic_store_explicit(&ltail->next, new_node, memory_order_release);
+    atomic_store_explicit(&q->tail, new_node, memory_order_release);
+    return true;
+}
+
+// Dequeue for MPSC/SPSC queues. The lone consumer is the only thread that
+// advances and retires the head, so the head node cannot disappear under it:
+// no hazard pointer and no FAA on deqidx are needed. Slots are never burned;
+// an in-flight slot is waited on according to the wait policy and otherwise
+// revisited by the next call.
+static void *
+dequeue_single_consumer(FAAArrayQueue_t *q) {
+    Node_t *lhead = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    while (true) {
+        size_t const idx = atomic_load_explicit(&lhead->deqidx, memory_order_relaxed);
+
+        if (idx >= FAA_BUFFER_SIZE) {
+            Node_t *lnext = atomic_load_explicit(&lhead->next, memory_order_acquire);
+            if (lnext == nullptr) {
+                return nullptr;
+            }
+            atomic_store_explicit(&q->head, lnext, memory_order_release);
+            // Producers and observers (peek, size) may still hold hazard
+            // pointers to the old head, so it goes through the HP domain.
+            node_retire(lhead);
+            lhead = lnext;
+            continue;
+        }
+
+        void *item = atomic_load_explicit(&lhead->items[idx], memory_order_acquire);
+        if (item == nullptr) {
+            size_t const enq_idx = atomic_load_explicit(&lhead->enqidx, memory_order_acquire);
+            if (idx >= enq_idx || q->single_producer) {
+                // Nothing has been published at this index yet.
+                return nullptr;
+            }
+            // A producer reserved the slot but has not stored its item.
+            if (q->wait_policy == FAA_WAIT_NONE || !await_slot(q, &lhead->items[idx])) {
+                return nullptr;
+            }
+            item = atomic_load_explicit(&lhead->items[idx], memory_order_acquire);
+            atomic_fetch_add_explicit(&q->waited_slots, 1, memory_order_relaxed);
+        }
+
+        atomic_store_explicit(&lhead->deqidx, idx + 1, memory_order_release);
+        return item;
+    }
+}
+
+bool
 faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid) {
     assert(q != nullptr);
     if (tid < 0 || tid >= q->max_threads) {
         fprintf(stderr, "C23 FAAQueue Error: Invalid thread ID %d.\n", tid);
         assert(false && "Invalid TID");
-        return;
+        return false;
     }
     if (item == nullptr) {
         fprintf(stderr, "C23 FAAQueue Error: item cannot be nullptr\n");
         abort();
     }
-    if (item == q->taken_sentinel) {
+    if (item == q->taken_sentinel || item == q->elim_waiting) {
         fprintf(stderr, "C23 FAAQueue Error: item matches internal sentinel\n");
         abort();
     }
+    return faa_queue_enqueue_slow(q, item, tid);
+}
+
+bool
+faa_queue_enqueue_slow(FAAArrayQueue_t *q, void *item, int tid) {
+    if (q->single_producer) {
+        if (!enqueue_single_producer(q, item)) {
+            atomic_fetch_add_explicit(&q->pool->failed_enqueues, 1, memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
 
     // Get the dedicated holder for this thread.
     hazptr_holder_t *h = &q->holders[tid];
 
+    if (q->elim_slots != nullptr && elim_try_handoff(q, h, item)) {
+        atomic_fetch_add_explicit(&q->eliminated, 1, memory_order_relaxed);
+        return true;
+    }
+
     while (true) {
         Node_t *ltail;
         // 1. Protect the tail pointer using the C23 HP macro.
@@ -166,7 +605,26 @@ faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid) {
 
             if (lnext == nullptr) {
                 // No next node. Create one with the item pre-filled.
-                Node_t *new_node      = create_node(item);
+                Node_t *new_node = create_node(q, item);
+                if (!new_node) {
+                    // Out of budget or memory. Another producer may hold the
+                    // last node of the budget for this tail and be about to
+                    // link it, and its free slots would take our item too.
+                    // Fail, without side effects, only if none shows up.
+                    lnext = await_successor(q, ltail);
+                    if (lnext == nullptr) {
+                        hazptr_reset(h, nullptr);
+                        atomic_fetch_add_explicit(&q->pool->failed_enqueues, 1, memory_order_relaxed);
+                        return false;
+                    }
+                    atomic_compare_exchange_weak_explicit(
+                        &q->tail, &ltail, lnext, memory_order_release, memory_order_relaxed
+                    );
+                    hazptr_reset(h, nullptr);
+                    continue;
+                }
+                new_node->seq         = ltail->seq + 1;
+                atomic_fetch_add_explicit(&q->nodes_allocated, 1, memory_order_relaxed);
 
                 Node_t *expected_next = nullptr;
                 if (atomic_compare_exchange_weak_explicit(
@@ -183,11 +641,11 @@ faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid) {
 
                     // Clear hazard pointer and return.
                     hazptr_reset(h, nullptr);
-                    return;
+                    return true;
                 } else {
                     // CAS failed, someone else added a node first.
                     // Free the unused node we created.
-                    node_reclaim(&new_node->hp_base);
+                    node_free(new_node);
                     // Continue the loop to retry.
                 }
             } else {
@@ -201,6 +659,7 @@ faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid) {
         }
 
         // --- We have a valid index (Fast path) ---
+        preempt_point();
 
         // 3. Try to store the item in the claimed slot.
         void *expected = nullptr;
@@ -209,7 +668,7 @@ faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid) {
             )) {
             // Success! Item enqueued.
             hazptr_reset(h, nullptr);
-            return;
+            return true;
         }
 
         // If CAS fails (handled by retrying). Reset HP before retry.
@@ -217,6 +676,56 @@ faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid) {
     }
 }
 
+// Tries to swing q->head from 'lhead' to its successor 'lnext'. Exactly one
+// thread succeeds and retires 'lhead'. Resets the caller's hazard pointer.
+static void
+advance_head(FAAArrayQueue_t *q, hazptr_holder_t *h, Node_t *lhead, Node_t *lnext) {
+    // We must use strong CAS here to ensure exactly one thread retires the
+    // node. lhead is updated by CAS on failure.
+    if (atomic_compare_exchange_strong_explicit(&q->head, &lhead, lnext, memory_order_release, memory_order_relaxed)) {
+        // Success: Head advanced. We are responsible for retiring the old head
+        // (lhead).
+
+        // CRITICAL: We reset the hazard pointer BEFORE retiring the object
+        // it was protecting. This allows prompt reclamation.
+        hazptr_reset(h, nullptr);
+
+        // Retire the old head node using the HP library.
+        node_retire(lhead);
+    } else {
+        // CAS failed. Reset HP before retrying.
+        hazptr_reset(h, nullptr);
+    }
+}
+
+// Consumes slot 'idx' of 'lhead', which the caller claimed with FAA and still
+// protects. Waits for an in-flight producer according to the wait policy, then
+// takes the item. Returns nullptr if the slot had to be burned.
+static inline void *
+take_slot(FAAArrayQueue_t *q, Node_t *lhead, size_t idx) {
+    // If the producer that claimed this index has not stored its item yet,
+    // give it a bounded amount of time before abandoning the slot.
+    bool waited = false;
+    if (q->wait_policy != FAA_WAIT_NONE && atomic_load_explicit(&lhead->items[idx], memory_order_relaxed) == nullptr) {
+        waited = await_slot(q, &lhead->items[idx]);
+    }
+
+    // Retrieve the item and mark the slot as taken simultaneously using
+    // Exchange.
+    void *item = atomic_exchange_explicit(&lhead->items[idx], q->taken_sentinel, memory_order_acquire);
+
+    if (item == nullptr) {
+        // The slot was empty. The enqueuer claimed the slot (FAA) but hasn't
+        // stored the item (CAS) yet; it will retry on a fresh index.
+        atomic_fetch_add_explicit(&q->burned_slots, 1, memory_order_relaxed);
+        return nullptr;
+    }
+    if (waited) {
+        atomic_fetch_add_explicit(&q->waited_slots, 1, memory_order_relaxed);
+    }
+    return item;
+}
+
 void *
 faa_queue_dequeue(FAAArrayQueue_t *q, int tid) {
     // Input validation.
@@ -226,9 +735,27 @@ faa_queue_dequeue(FAAArrayQueue_t *q, int tid) {
         assert(false && "Invalid TID");
         return nullptr;
     }
+    return faa_queue_dequeue_slow(q, tid);
+}
 
-    hazptr_holder_t *h     = &q->holders[tid];
-    void *const      taken = q->taken_sentinel;
+void *
+faa_queue_dequeue_claimed_slow(FAAArrayQueue_t *q, int tid, Node_t *lhead, size_t idx) {
+    void *item = take_slot(q, lhead, idx);
+    hazptr_reset(&q->holders[tid], nullptr);
+    if (item != nullptr) {
+        return item;
+    }
+    thrd_yield();
+    return faa_queue_dequeue_slow(q, tid);
+}
+
+void *
+faa_queue_dequeue_slow(FAAArrayQueue_t *q, int tid) {
+    if (q->single_consumer) {
+        return dequeue_single_consumer(q);
+    }
+
+    hazptr_holder_t *h = &q->holders[tid];
 
     while (true) {
         Node_t *lhead;
@@ -264,39 +791,19 @@ faa_queue_dequeue(FAAArrayQueue_t *q, int tid) {
                 break;
             }
 
-            // Try to advance the head pointer.
-            // We must use strong CAS here to ensure exactly one thread retires the
-            // node. lhead is updated by CAS on failure.
-            if (atomic_compare_exchange_strong_explicit(
-                    &q->head, &lhead, lnext, memory_order_release, memory_order_relaxed
-                )) {
-                // Success: Head advanced. We are responsible for retiring the old head
-                // (lhead).
-
-                // CRITICAL: We reset the hazard pointer BEFORE retiring the object
-                // it was protecting. This allows prompt reclamation.
-                hazptr_reset(h, nullptr);
-
-                // Retire the old head node using the HP library.
-                hazptr_retire(&lhead->hp_base, node_reclaim);
-            } else {
-                // CAS failed. Reset HP before retrying.
-                hazptr_reset(h, nullptr);
-            }
+            // Try to advance the head pointer (clears our hazard pointer).
+            advance_head(q, h, lhead, lnext);
             // Retry the loop with the (potentially new) head.
             continue;
         }
 
         // --- We have a valid index (Fast path) ---
 
-        // 3. Retrieve the item and mark the slot as taken simultaneously using
-        // Exchange.
-        void *item = atomic_exchange_explicit(&lhead->items[idx], taken,
-                                              memory_order_acquire); // NEW
+        // 3. Take the item, waiting for an in-flight producer if configured.
+        void *item = take_slot(q, lhead, idx);
 
         if (item == nullptr) {
-            // The slot was empty. The enqueuer claimed the slot (FAA) but hasn't
-            // stored the item (CAS) yet. We must retry the dequeue operation. Reset
+            // The slot was burned. We must retry the dequeue operation. Reset
             // HP before retry.
             hazptr_reset(h, nullptr);
             thrd_yield();
@@ -310,5 +817,192 @@ faa_queue_dequeue(FAAArrayQueue_t *q, int tid) {
 
     // Queue is empty.
     hazptr_reset(h, nullptr);
+
+    if (q->elim_slots != nullptr) {
+        return elim_await(q, tid);
+    }
     return nullptr;
 }
+
+void *
+faa_queue_peek(FAAArrayQueue_t *q, int tid) {
+    assert(q != nullptr);
+    if (tid < 0 || tid >= q->max_threads) {
+        fprintf(stderr, "C23 FAAQueue Error: Invalid thread ID %d.\n", tid);
+        assert(false && "Invalid TID");
+        return nullptr;
+    }
+
+    void *const      taken = q->taken_sentinel;
+
+    // Walk the chain hand-over-hand: 'cur' protects the node being scanned and
+    // 'nxt' protects its successor before 'cur' is released. A temporary
+    // holder is only acquired if the head node turns out to be consumed.
+    // Peek never moves the head, so it is also safe with a single consumer
+    // that owns it.
+    hazptr_holder_t  spare = {};
+    hazptr_holder_t *cur   = &q->holders[tid];
+    hazptr_holder_t *nxt   = &spare;
+    void            *found = nullptr;
+
+    Node_t          *node;
+    HAZPTR_PROTECT(node, cur, &q->head);
+
+    while (node != nullptr) {
+        size_t const deq_idx = atomic_load_explicit(&node->deqidx, memory_order_acquire);
+        size_t const enq_idx = atomic_load_explicit(&node->enqidx, memory_order_acquire);
+        size_t const end     = enq_idx < FAA_BUFFER_SIZE ? enq_idx : FAA_BUFFER_SIZE;
+
+        // Scan forward from the dequeue index, skipping slots that concurrent
+        // dequeuers have already consumed or burned.
+        bool         stop    = false;
+        for (size_t idx = deq_idx; idx < end; idx++) {
+            void *item = atomic_load_explicit(&node->items[idx], memory_order_acquire);
+            if (item != taken) {
+                // An empty slot belongs to a producer that has not stored its
+                // item yet. Nothing beyond it is at the head, so report none.
+                found = item;
+                stop  = true;
+                break;
+            }
+        }
+        if (stop || end < FAA_BUFFER_SIZE) {
+            // Found, or every published item in the last node is consumed.
+            break;
+        }
+
+        // This node is fully consumed; continue with its successor.
+        if (nxt->hprec == nullptr) {
+            hazptr_holder_init(nxt);
+        }
+        Node_t *lnext;
+        HAZPTR_PROTECT(lnext, nxt, &node->next);
+
+        // 'node->next' never changes once linked, so the protect above does
+        // not prove 'lnext' is still alive: consumers may have moved the head
+        // past it and retired it before the hazard pointer was published. A
+        // node is retired only once the head has moved past it, so it is safe
+        // while the head is still 'node' or 'lnext'. Otherwise start over from
+        // the current head.
+        Node_t *const lhead = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (lhead != node && lhead != lnext) {
+            hazptr_reset(nxt, nullptr);
+            HAZPTR_PROTECT(node, cur, &q->head);
+            continue;
+        }
+        hazptr_reset(cur, nullptr);
+
+        hazptr_holder_t *t = cur;
+        cur                = nxt;
+        nxt                = t;
+        node               = lnext;
+    }
+
+    hazptr_reset(cur, nullptr);
+    hazptr_holder_destroy(&spare);
+    return found;
+}
+
+size_t
+faa_queue_size_approx(FAAArrayQueue_t *q, int tid) {
+    assert(q != nullptr);
+    if (tid < 0 || tid >= q->max_threads) {
+        fprintf(stderr, "C23 FAAQueue Error: Invalid thread ID %d.\n", tid);
+        assert(false && "Invalid TID");
+        return 0;
+    }
+
+    hazptr_holder_t *h = &q->holders[tid];
+
+    // Read the tail first: if the head overtakes it in the meantime the
+    // difference is negative and we report 0 rather than a phantom backlog.
+    Node_t          *ltail;
+    HAZPTR_PROTECT(ltail, h, &q->tail);
+    uint64_t const tail_seq = ltail->seq;
+    size_t         enq_idx  = atomic_load_explicit(&ltail->enqidx, memory_order_acquire);
+
+    Node_t        *lhead;
+    HAZPTR_PROTECT(lhead, h, &q->head);
+    uint64_t const head_seq = lhead->seq;
+    size_t         deq_idx  = atomic_load_explicit(&lhead->deqidx, memory_order_acquire);
+
+    hazptr_reset(h, nullptr);
+
+    // Both indices overshoot FAA_BUFFER_SIZE once a node is exhausted.
+    enq_idx                 = enq_idx < FAA_BUFFER_SIZE ? enq_idx : FAA_BUFFER_SIZE;
+    deq_idx                 = deq_idx < FAA_BUFFER_SIZE ? deq_idx : FAA_BUFFER_SIZE;
+
+    uint64_t const produced = tail_seq * FAA_BUFFER_SIZE + enq_idx;
+    uint64_t const consumed = head_seq * FAA_BUFFER_SIZE + deq_idx;
+    return produced > consumed ? (size_t) (produced - consumed) : 0;
+}
+
+bool
+faa_queue_is_empty(FAAArrayQueue_t *q, int tid) {
+    assert(q != nullptr);
+    if (tid < 0 || tid >= q->max_threads) {
+        fprintf(stderr, "C23 FAAQueue Error: Invalid thread ID %d.\n", tid);
+        assert(false && "Invalid TID");
+        return true;
+    }
+
+    return observed_empty(q, &q->holders[tid]);
+}
+
+bool
+faa_queue_set_preempt_hook(FAAPreemptHook_t hook) {
+#ifdef FAAQ_PREEMPT_INJECTION
+    atomic_store_explicit(&preempt_hook, hook, memory_order_relaxed);
+    return true;
+#else
+    (void) hook;
+    return false;
+#endif
+}
+
+void
+faa_queue_memory_usage(FAAArrayQueue_t const *q, FAAQueueMemory_t *usage) {
+    assert(q != nullptr && usage != nullptr);
+    FAANodePool_t *pool  = q->pool;
+    uint64_t const live  = atomic_load_explicit(&pool->refs, memory_order_relaxed) - 1;
+
+    uint64_t       fixed = sizeof(FAAArrayQueue_t) + sizeof(FAANodePool_t) + sizeof(int)
+                   + (uint64_t) q->max_threads * sizeof(hazptr_holder_t);
+    if (q->elim_slots) {
+        fixed += FAA_ELIM_SLOTS * sizeof(FAAElimSlot_t);
+    }
+
+    uint64_t node_bytes = live * sizeof(Node_t);
+    if (pool->arena) {
+        FAAArenaStats_t arena;
+        faa_arena_stats(pool->arena, &arena);
+        node_bytes  = (uint64_t) arena.chunks * FAA_ARENA_CHUNK_SIZE;
+        fixed      += sizeof(FAAArena_t);
+    }
+
+    *usage = (FAAQueueMemory_t) {
+        .live_nodes      = live,
+        .retired_nodes   = atomic_load_explicit(&pool->retired, memory_order_relaxed),
+        .node_bytes      = node_bytes,
+        .total_bytes     = node_bytes + fixed,
+        .budget_bytes    = pool->budget_nodes * sizeof(Node_t),
+        .failed_enqueues = atomic_load_explicit(&pool->failed_enqueues, memory_order_relaxed),
+    };
+}
+
+void
+faa_queue_stats(FAAArrayQueue_t const *q, FAAQueueStats_t *stats) {
+    assert(q != nullptr && stats != nullptr);
+    *stats = (FAAQueueStats_t) {
+        .nodes_allocated = atomic_load_explicit(&q->nodes_allocated, memory_order_relaxed),
+        .burned_slots    = atomic_load_explicit(&q->burned_slots, memory_order_relaxed),
+        .waited_slots    = atomic_load_explicit(&q->waited_slots, memory_order_relaxed),
+        .eliminated      = atomic_load_explicit(&q->eliminated, memory_order_relaxed),
+    };
+    if (q->pool->arena) {
+        FAAArenaStats_t arena;
+        faa_arena_stats(q->pool->arena, &arena);
+        stats->arena_chunks         = arena.chunks;
+        stats->arena_hugetlb_chunks = arena.hugetlb_chunks;
+    }
+}
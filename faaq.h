@@ -4,19 +4,50 @@
 #include <stdalign.h>
 #include <stdatomic.h>
 #include <stddef.h>
+#include <stdint.h>
 
+#include "faaq_arena.h"
 #include "hp.h"
 
-constexpr static size_t FAA_BUFFER_SIZE = 1024;
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-constexpr static size_t FAA_ALIGNMENT   = 128;
+// Slots per node. Can be overridden at build time (-DFAAQ_BUFFER_SIZE=N, a
+// multiple of 8); the library and everything using it must agree on it.
+#ifndef FAAQ_BUFFER_SIZE
+#define FAAQ_BUFFER_SIZE 1024
+#endif
+constexpr static size_t   FAA_BUFFER_SIZE         = FAAQ_BUFFER_SIZE;
+
+constexpr static size_t   FAA_ALIGNMENT           = 128;
+
+// Default bounds for the in-flight slot wait (see FAAWaitPolicy_t).
+constexpr static uint32_t FAA_DEFAULT_SPIN_LIMIT  = 128;
+constexpr static uint32_t FAA_DEFAULT_YIELD_LIMIT = 4;
+
+// Number of exchanger slots in the optional elimination layer.
+constexpr static size_t   FAA_ELIM_SLOTS          = 8;
 
 typedef struct FAA_Node Node_t;
 
+// Per-queue source of nodes and their accounting (defined in faaq.c). Every
+// node points back at its pool, so the pool outlives the queue until the last
+// retired node has been reclaimed.
+typedef struct FAA_NodePool FAANodePool_t;
+
 struct FAA_Node {
     // HP reclaimation data
     hazptr_obj_t hp_base;
 
+    // Position of this node in the chain (sentinel is 0). Immutable once the
+    // node is linked, so readers can compare nodes without touching the hot
+    // index lines.
+    uint64_t     seq;
+
+    // Pool the node was allocated from.
+    FAANodePool_t *pool;
+
     alignas(FAA_ALIGNMENT) _Atomic(size_t) deqidx;
 
     alignas(FAA_ALIGNMENT) _Atomic(size_t) enqidx;
@@ -26,6 +57,130 @@ struct FAA_Node {
     alignas(FAA_ALIGNMENT) _Atomic(void *) items[FAA_BUFFER_SIZE];
 };
 
+/**
+ * @brief What a dequeuer does when the slot it claimed is still empty.
+ *
+ * An empty slot below enqidx means a producer has claimed the index (FAA) but
+ * has not stored its item (CAS) yet. Marking the slot taken right away forces
+ * that producer to retry on a fresh index, which burns the slot and, when
+ * producers are preempted, whole segments.
+ */
+typedef enum {
+    // Mark the slot taken immediately and retry (original behavior).
+    FAA_WAIT_NONE = 0,
+    // Spin on the slot with a CPU pause hint for up to `spin_limit` iterations.
+    FAA_WAIT_SPIN,
+    // Spin as above, then yield the CPU up to `yield_limit` times.
+    FAA_WAIT_SPIN_YIELD,
+} FAAWaitPolicy_t;
+
+/**
+ * @brief Which ends of the queue are shared, fixed at creation.
+ *
+ * Single-producer variants skip the FAA on enqidx and the hazard pointer on the
+ * tail: the lone producer is the only thread that links nodes, so the tail
+ * node cannot be retired under it. Single-consumer variants skip the FAA on
+ * deqidx and the hazard pointer on the head: the lone consumer is the only
+ * thread that advances (and retires) the head. Calling the single-sided end
+ * from more than one thread concurrently is undefined.
+ */
+typedef enum {
+    FAA_TOPOLOGY_MPMC = 0,
+    FAA_TOPOLOGY_MPSC,
+    FAA_TOPOLOGY_SPMC,
+    FAA_TOPOLOGY_SPSC,
+} FAATopology_t;
+
+/**
+ * @brief Where a queue gets its nodes from, fixed at creation.
+ *
+ * Each node spans several 4 KiB pages, so walking a deep queue touches many
+ * TLB entries, and every fresh malloc'ed node takes page faults. An arena maps
+ * 2 MiB chunks that huge pages can back and recycles reclaimed nodes through
+ * a freelist instead of returning them to malloc.
+ */
+typedef enum {
+    // One malloc per node (default).
+    FAA_NODES_MALLOC = 0,
+    // Per-queue arena with MADV_HUGEPAGE (transparent huge pages).
+    FAA_NODES_ARENA,
+    // Per-queue arena with MAP_HUGETLB, falling back to FAA_NODES_ARENA when
+    // no explicit huge pages are reserved.
+    FAA_NODES_ARENA_HUGETLB,
+} FAANodeSource_t;
+
+/**
+ * @brief Optional creation parameters. Obtain defaults from
+ * faa_queue_config_default() and override individual fields.
+ */
+typedef struct {
+    FAATopology_t   topology;
+    FAANodeSource_t node_source;
+    FAAWaitPolicy_t wait_policy;
+    uint32_t        spin_limit;
+    uint32_t        yield_limit;
+    // Elimination layer (MPMC only): a dequeuer that finds the queue empty
+    // waits up to this many spin iterations in an exchanger slot, where a
+    // producer that also sees the queue empty can hand its item over
+    // directly, without touching head or tail. 0 disables elimination
+    // (default).
+    uint32_t        elimination_spin;
+    // Node budget, given in bytes and rounded down to whole nodes: the queue
+    // holds at most memory_budget / sizeof(Node_t) nodes, including retired
+    // nodes not yet reclaimed. An enqueue that needs a new node beyond it
+    // forces a reclamation scan if any are retired; if still over, it uses a
+    // node another producer links meanwhile, or fails instead of allocating.
+    // 0 means unlimited (default). With an arena
+    // node source this bounds the node count only: the arena maps whole
+    // chunks and never unmaps them, so a queue holds at least one chunk
+    // (FAA_ARENA_CHUNK_SIZE) whatever the budget.
+    size_t          memory_budget;
+} FAAQueueConfig_t;
+
+/**
+ * @brief Counters describing slow-path activity. All values are cumulative
+ * since queue creation.
+ */
+typedef struct {
+    // Nodes allocated, including the initial sentinel and nodes discarded
+    // after losing the race to be linked.
+    uint64_t nodes_allocated;
+    // Slots a dequeuer marked taken before the producer could store into them.
+    uint64_t burned_slots;
+    // In-flight slots a dequeuer waited on and then consumed normally.
+    uint64_t waited_slots;
+    // Items handed from a producer to a waiting dequeuer by elimination.
+    uint64_t eliminated;
+    // Node arena chunks mapped, and how many of them use MAP_HUGETLB. Both are
+    // 0 for FAA_NODES_MALLOC.
+    uint32_t arena_chunks;
+    uint32_t arena_hugetlb_chunks;
+} FAAQueueStats_t;
+
+/**
+ * @brief Memory held by one queue. See faa_queue_memory_usage().
+ */
+typedef struct {
+    // Nodes allocated and not yet freed: linked nodes plus retired ones.
+    uint64_t live_nodes;
+    // Nodes unlinked and handed to the HP domain, not yet reclaimed.
+    uint64_t retired_nodes;
+    // Bytes held for nodes: live_nodes * sizeof(Node_t), or the mapped chunks
+    // for an arena.
+    uint64_t node_bytes;
+    // node_bytes plus the queue's fixed allocations.
+    uint64_t total_bytes;
+    // The effective budget (whole nodes), 0 if unlimited.
+    uint64_t budget_bytes;
+    // Enqueues that failed because of the budget or an allocation failure.
+    uint64_t failed_enqueues;
+} FAAQueueMemory_t;
+
+// One exchanger of the elimination layer, padded to its own cache line.
+typedef struct {
+    alignas(FAA_ALIGNMENT) _Atomic(void *) value;
+} FAAElimSlot_t;
+
 typedef struct {
     alignas(FAA_ALIGNMENT) _Atomic(Node_t *) head;
     alignas(FAA_ALIGNMENT) _Atomic(Node_t *) tail;
@@ -37,6 +192,32 @@ typedef struct {
     int              max_threads;
     hazptr_holder_t *holders;
 
+    // Node allocation and accounting (read-only after creation).
+    FAANodePool_t   *pool;
+
+    // Topology (read-only after creation).
+    bool             single_producer;
+    bool             single_consumer;
+
+    // In-flight slot handling (read-only after creation).
+    FAAWaitPolicy_t  wait_policy;
+    uint32_t         spin_limit;
+    uint32_t         yield_limit;
+
+    // Elimination layer (read-only after creation; slots are nullptr when
+    // elimination is disabled). 'elim_waiting' marks a slot with a waiting
+    // dequeuer and, like the taken sentinel, can never be a valid item.
+    // Elimination only applies to the MPMC topology.
+    uint32_t         elimination_spin;
+    void            *elim_waiting;
+    FAAElimSlot_t   *elim_slots;
+
+    // Statistics. Only touched on slow paths, kept off the head/tail lines.
+    alignas(FAA_ALIGNMENT) _Atomic(uint64_t) nodes_allocated;
+    _Atomic(uint64_t) burned_slots;
+    _Atomic(uint64_t) waited_slots;
+    _Atomic(uint64_t) eliminated;
+
 } FAAArrayQueue_t;
 
 // ----------------------------------------------------------------------------
@@ -53,6 +234,22 @@ typedef struct {
 [[nodiscard("Queue creation failure must be handled")]]
 FAAArrayQueue_t *faa_queue_create(int max_threads);
 
+/**
+ * @brief Returns the default configuration used by faa_queue_create().
+ */
+FAAQueueConfig_t faa_queue_config_default(void);
+
+/**
+ * @brief Creates a queue with explicit configuration.
+ *
+ * @param max_threads The maximum number of threads that will access the queue.
+ * Must be > 0.
+ * @param config Creation parameters, or nullptr for the defaults.
+ * @return A pointer to the new queue, or nullptr on failure.
+ */
+[[nodiscard("Queue creation failure must be handled")]]
+FAAArrayQueue_t *faa_queue_create_ex(int max_threads, FAAQueueConfig_t const *config);
+
 /**
  * @brief Destroys the queue. Assumes the queue is quiescent (no other threads
  * accessing it).
@@ -67,19 +264,122 @@ void             faa_queue_destroy(FAAArrayQueue_t *q);
  * @brief Enqueues an item into the queue.
  *
  * @param q Pointer to the queue structure.
- * @param item The item to enqueue (must not be nullptr or the internal
- * sentinel).
+ * @param item The item to enqueue (must not be nullptr or one of the internal
+ * sentinels).
  * @param tid The thread ID of the caller (0 <= tid < max_threads).
+ * @return true on success. false if a new node was needed and could not be
+ * allocated, either because of the memory budget or because the allocator
+ * failed; the queue is unchanged in that case.
  */
-void             faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid);
+bool             faa_queue_enqueue(FAAArrayQueue_t *q, void *item, int tid);
 
 /**
  * @brief Dequeues an item from the queue.
  *
+ * With a single-consumer topology (MPSC, SPSC), nullptr is also returned when
+ * the head slot has been reserved by a producer that has not published its
+ * item yet and the wait policy gave up on it (immediately with
+ * FAA_WAIT_NONE). Later items may already be queued; the slot is not burned,
+ * so the next call returns its item first. Multi-consumer topologies burn
+ * such a slot and move on instead.
+ *
  * @param q Pointer to the queue structure.
  * @param tid The thread ID of the caller (0 <= tid < max_threads).
- * @return The dequeued item, or nullptr if the queue is empty.
+ * @return The dequeued item, or nullptr if the queue is empty (see above for
+ * single-consumer topologies).
  */
 void            *faa_queue_dequeue(FAAArrayQueue_t *q, int tid);
 
+/**
+ * @brief Returns the item at the head of the queue without removing it.
+ *
+ * Reads the slots of the head node starting at its dequeue index, skipping
+ * slots already consumed by other dequeuers. Consistency is weak:
+ * - The result is a snapshot; a concurrent dequeuer may remove the item before
+ *   the caller acts on it, so a following dequeue may return a different item.
+ * - The item is not protected after return. Only dereference it if the
+ *   caller's own protocol keeps it alive (e.g. items are never freed while
+ *   peeks can be in progress).
+ * - nullptr is returned when the queue is empty, and also when the head slot
+ *   has been reserved by a producer that has not published its item yet.
+ *
+ * Performs no writes to shared queue state.
+ *
+ * @param q Pointer to the queue structure.
+ * @param tid The thread ID of the caller (0 <= tid < max_threads).
+ * @return The current head item, or nullptr.
+ */
+void            *faa_queue_peek(FAAArrayQueue_t *q, int tid);
+
+/**
+ * @brief Returns an approximation of the number of items in the queue.
+ *
+ * Computed from the head and tail node sequence numbers and their dequeue and
+ * enqueue indices. The two ends are read one after the other, so the result
+ * may be stale by the operations that completed in between, and slots claimed
+ * by producers that have not stored their item yet are counted as present.
+ * Performs no writes to shared queue state.
+ *
+ * @param q Pointer to the queue structure.
+ * @param tid The thread ID of the caller (0 <= tid < max_threads).
+ * @return The approximate number of items.
+ */
+size_t           faa_queue_size_approx(FAAArrayQueue_t *q, int tid);
+
+/**
+ * @brief Returns whether the queue appears empty.
+ *
+ * Uses the same check as the dequeue fast path, so a true result means a
+ * dequeue issued at the same instant would have returned nullptr. Performs no
+ * writes to shared queue state.
+ *
+ * @param q Pointer to the queue structure.
+ * @param tid The thread ID of the caller (0 <= tid < max_threads).
+ */
+bool             faa_queue_is_empty(FAAArrayQueue_t *q, int tid);
+
+/**
+ * @brief Takes a snapshot of the queue's slow-path counters.
+ *
+ * Safe to call concurrently with other operations; the individual counters are
+ * read independently and are not mutually consistent.
+ *
+ * @param q Pointer to the queue structure.
+ * @param stats Output snapshot.
+ */
+void             faa_queue_stats(FAAArrayQueue_t const *q, FAAQueueStats_t *stats);
+
+/**
+ * @brief Reports the memory held by the queue.
+ *
+ * Safe to call concurrently with other operations; the counters are read
+ * independently. Retired nodes are only reclaimed when the HP domain runs a
+ * scan, so retired_nodes can stay above zero for a while after a drain.
+ *
+ * @param q Pointer to the queue structure.
+ * @param usage Output snapshot.
+ */
+void             faa_queue_memory_usage(FAAArrayQueue_t const *q, FAAQueueMemory_t *usage);
+
+// Called by multi-producer enqueues between reserving a slot with FAA and
+// filling it, the window in which a preempted producer holds up whichever
+// consumer claims that slot.
+typedef void (*FAAPreemptHook_t)(void);
+
+/**
+ * @brief Installs a preemption hook for every queue, or removes it (nullptr).
+ *
+ * For testing preemption tolerance, e.g. with a hook that calls sched_yield
+ * at random. The hook point is only compiled in when the library is built
+ * with FAAQ_PREEMPT_INJECTION defined, so regular builds pay nothing for it.
+ *
+ * @return false if the library was built without FAAQ_PREEMPT_INJECTION; the
+ * hook is then never called.
+ */
+bool             faa_queue_set_preempt_hook(FAAPreemptHook_t hook);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // FAA_ARRAY_QUEUE_HP_H
@@ -0,0 +1,358 @@
+#ifndef FAAQ_HPP
+#define FAAQ_HPP
+
+// C++ front-end for the FAA array queue.
+//
+// faaq::queue<T, SegmentSize, Policy> owns an FAAArrayQueue_t and carries
+// values of type T instead of void pointers. Thread IDs are handed out by the
+// queue: a thread takes a handle, which holds one ID until it is destroyed.
+// push() and pop() go through the inline fast paths of faaq_inline.h.
+//
+// A value travels in the queue's pointer-sized slot in one of four ways,
+// chosen at compile time:
+//  - object pointers as they are (nullptr cannot be pushed);
+//  - std::unique_ptr with the default deleter as its released pointer, which
+//    pop() wraps again (an empty one cannot be pushed);
+//  - trivially copyable types smaller than a pointer inline, shifted up by one
+//    byte and tagged with 0b11 in the low bits, which no aligned pointer and
+//    neither of the queue's sentinels can have;
+//  - everything else, including other move-only types, moved into a heap cell
+//    that pop() moves the value out of and frees: one allocation and one free
+//    per value on top of the queue's own cost.
+//
+// Requires C++20.
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "faaq_inline.h"
+
+namespace faaq {
+
+namespace detail {
+
+// Owning handles whose ownership can travel as a plain pointer.
+template <class T>
+struct is_default_unique_ptr : std::false_type {};
+
+template <class U>
+struct is_default_unique_ptr<std::unique_ptr<U>> : std::true_type {};
+
+} // namespace detail
+
+// --- Policies ---
+
+/**
+ * @brief Reclamation backend: the hazard pointer domain of hp.c.
+ *
+ * The only backend libfaaq implements. The policy slot exists so that code
+ * naming it keeps compiling if another one is added.
+ */
+struct hazard_pointers {};
+
+/**
+ * @brief Wait strategies for a dequeuer that claimed a slot whose producer has
+ * not stored its item yet (see FAAWaitPolicy_t).
+ */
+struct no_wait {
+    static constexpr FAAWaitPolicy_t kind        = FAA_WAIT_NONE;
+    static constexpr uint32_t        spin_limit  = 0;
+    static constexpr uint32_t        yield_limit = 0;
+};
+
+template <uint32_t Spins = FAA_DEFAULT_SPIN_LIMIT>
+struct spin_wait {
+    static constexpr FAAWaitPolicy_t kind        = FAA_WAIT_SPIN;
+    static constexpr uint32_t        spin_limit  = Spins;
+    static constexpr uint32_t        yield_limit = 0;
+};
+
+template <uint32_t Spins = FAA_DEFAULT_SPIN_LIMIT, uint32_t Yields = FAA_DEFAULT_YIELD_LIMIT>
+struct spin_yield_wait {
+    static constexpr FAAWaitPolicy_t kind        = FAA_WAIT_SPIN_YIELD;
+    static constexpr uint32_t        spin_limit  = Spins;
+    static constexpr uint32_t        yield_limit = Yields;
+};
+
+/**
+ * @brief Compile-time queue configuration.
+ *
+ * The wait strategy and topology become the queue's FAAQueueConfig_t. A
+ * single-producer topology also sends push() straight to the out-of-line path
+ * (the inline one would only check for it and jump there); likewise for pop()
+ * and a single consumer.
+ */
+template <class Reclamation = hazard_pointers, class Wait = spin_wait<>, FAATopology_t Topology = FAA_TOPOLOGY_MPMC>
+struct policy {
+    using reclamation                       = Reclamation;
+    using wait                              = Wait;
+    static constexpr FAATopology_t topology = Topology;
+};
+
+// --- Queue ---
+
+template <class T, std::size_t SegmentSize = FAA_BUFFER_SIZE, class Policy = policy<>>
+class queue {
+    static_assert(SegmentSize == FAA_BUFFER_SIZE, "SegmentSize must match the FAAQ_BUFFER_SIZE libfaaq was built with");
+    static_assert(
+        std::is_same_v<typename Policy::reclamation, hazard_pointers>, "libfaaq only implements hazard pointers"
+    );
+    static_assert(std::is_object_v<T> && !std::is_const_v<T>, "T must be a non-const object type");
+    static_assert(std::is_move_constructible_v<T>, "T must be move constructible");
+
+    static constexpr bool single_producer =
+        Policy::topology == FAA_TOPOLOGY_SPMC || Policy::topology == FAA_TOPOLOGY_SPSC;
+    static constexpr bool single_consumer =
+        Policy::topology == FAA_TOPOLOGY_MPSC || Policy::topology == FAA_TOPOLOGY_SPSC;
+
+    static constexpr bool by_pointer = std::is_pointer_v<T> && std::is_object_v<std::remove_pointer_t<T>>;
+    static constexpr bool by_handle  = detail::is_default_unique_ptr<T>::value;
+    static constexpr bool by_value   = !by_pointer && std::is_trivially_copyable_v<T> && sizeof(T) < sizeof(void *);
+
+  public:
+    using value_type                          = T;
+    using policy_type                         = Policy;
+    static constexpr std::size_t segment_size = SegmentSize;
+    // True when values are stored in the slot itself rather than boxed.
+    static constexpr bool stores_inline = by_pointer || by_handle || by_value;
+
+    class handle;
+
+    /**
+     * @brief Creates a queue for up to 'max_threads' concurrent users.
+     *
+     * Throws std::bad_alloc if the queue cannot be created.
+     */
+    explicit queue(int max_threads) : max_threads_(max_threads) {
+        FAAQueueConfig_t cfg = faa_queue_config_default();
+        cfg.topology         = Policy::topology;
+        cfg.wait_policy      = Policy::wait::kind;
+        cfg.spin_limit       = Policy::wait::spin_limit;
+        cfg.yield_limit      = Policy::wait::yield_limit;
+        q_                   = faa_queue_create_ex(max_threads, &cfg);
+        if (q_ == nullptr) {
+            throw std::bad_alloc();
+        }
+        tids_ = std::make_unique<std::atomic<bool>[]>(static_cast<std::size_t>(max_threads));
+    }
+
+    /**
+     * @brief Destroys any values still in the queue, then the queue.
+     *
+     * No other thread may be using the queue, and no handle may outlive it.
+     */
+    ~queue() {
+        while (pop(0)) {
+        }
+        faa_queue_destroy(q_);
+    }
+
+    queue(queue const &)            = delete;
+    queue &operator=(queue const &) = delete;
+
+    /**
+     * @brief Reserves a thread ID for the calling thread.
+     *
+     * Throws std::length_error if all 'max_threads' IDs are held.
+     */
+    handle get_handle() {
+        for (int tid = 0; tid < max_threads_; tid++) {
+            if (!tids_[tid].load(std::memory_order_relaxed) && !tids_[tid].exchange(true, std::memory_order_acquire)) {
+                return handle(this, tid);
+            }
+        }
+        throw std::length_error("faaq::queue: all thread IDs are in use");
+    }
+
+    /**
+     * @brief Enqueues 'value' as thread 'tid'.
+     *
+     * Returns false if the queue's node budget is exhausted; the value is then
+     * left in 'value' (unless T is boxed and cannot be move-assigned).
+     */
+    bool push(T &&value, int tid) {
+        if constexpr (by_handle) {
+            assert(value != nullptr);
+            auto *const ptr = value.release();
+            if (!enqueue(ptr, tid)) {
+                value.reset(ptr);
+                return false;
+            }
+            return true;
+        } else if constexpr (stores_inline) {
+            return enqueue(encode(value), tid);
+        } else {
+            auto cell = std::make_unique<T>(std::move(value));
+            if (!enqueue(cell.get(), tid)) {
+                if constexpr (std::is_move_assignable_v<T>) {
+                    value = std::move(*cell);
+                }
+                return false;
+            }
+            cell.release();
+            return true;
+        }
+    }
+
+    bool push(T const &value, int tid)
+        requires std::is_copy_constructible_v<T>
+    {
+        T copy(value);
+        return push(std::move(copy), tid);
+    }
+
+    /**
+     * @brief Dequeues a value as thread 'tid', or std::nullopt if the queue is
+     * empty. As faa_queue_dequeue(), a single-consumer topology may also
+     * return std::nullopt while the head slot's producer is still in flight.
+     */
+    std::optional<T> pop(int tid) {
+        void *item;
+        if constexpr (single_consumer) {
+            assert(tid >= 0 && tid < max_threads_);
+            item = faa_queue_dequeue_slow(q_, tid);
+        } else {
+            item = faa_queue_dequeue_inline(q_, tid);
+        }
+        if (item == nullptr) {
+            return std::nullopt;
+        }
+        if constexpr (by_handle) {
+            return std::optional<T>(std::in_place, static_cast<typename T::pointer>(item));
+        } else if constexpr (stores_inline) {
+            return decode(item);
+        } else {
+            std::unique_ptr<T> cell(static_cast<T *>(item));
+            return std::optional<T>(std::move(*cell));
+        }
+    }
+
+    bool        empty(int tid) { return faa_queue_is_empty(q_, tid); }
+    std::size_t size_approx(int tid) { return faa_queue_size_approx(q_, tid); }
+    int         max_threads() const noexcept { return max_threads_; }
+
+    FAAQueueStats_t stats() const {
+        FAAQueueStats_t s;
+        faa_queue_stats(q_, &s);
+        return s;
+    }
+
+    FAAQueueMemory_t memory_usage() const {
+        FAAQueueMemory_t m;
+        faa_queue_memory_usage(q_, &m);
+        return m;
+    }
+
+    // The underlying C queue. Items pushed through it must use this queue's
+    // encoding of T.
+    FAAArrayQueue_t *native_handle() noexcept { return q_; }
+
+  private:
+    bool enqueue(void *item, int tid) {
+        if constexpr (single_producer) {
+            assert(tid >= 0 && tid < max_threads_);
+            return faa_queue_enqueue_slow(q_, item, tid);
+        } else {
+            return faa_queue_enqueue_inline(q_, item, tid);
+        }
+    }
+
+    struct raw {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    static void *encode(T const &value) {
+        if constexpr (by_pointer) {
+            assert(value != nullptr);
+            return const_cast<void *>(static_cast<void const *>(value));
+        } else {
+            raw const      r    = std::bit_cast<raw>(value);
+            std::uintptr_t bits = 0;
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                bits |= static_cast<std::uintptr_t>(r.bytes[i]) << (8 * i);
+            }
+            return reinterpret_cast<void *>((bits << 8) | 0x3);
+        }
+    }
+
+    static T decode(void *item) {
+        if constexpr (by_pointer) {
+            return static_cast<T>(item);
+        } else {
+            std::uintptr_t const bits = reinterpret_cast<std::uintptr_t>(item) >> 8;
+            raw                  r;
+            for (std::size_t i = 0; i < sizeof(T); i++) {
+                r.bytes[i] = static_cast<unsigned char>(bits >> (8 * i));
+            }
+            return std::bit_cast<T>(r);
+        }
+    }
+
+    void release_tid(int tid) noexcept { tids_[tid].store(false, std::memory_order_release); }
+
+    FAAArrayQueue_t                     *q_ = nullptr;
+    int                                  max_threads_;
+    std::unique_ptr<std::atomic<bool>[]> tids_;
+};
+
+/**
+ * @brief A thread ID reserved from a queue, released on destruction.
+ *
+ * Move-only, and meant to be used by one thread at a time.
+ */
+template <class T, std::size_t SegmentSize, class Policy>
+class queue<T, SegmentSize, Policy>::handle {
+  public:
+    handle(handle &&other) noexcept : q_(std::exchange(other.q_, nullptr)), tid_(other.tid_) {}
+
+    handle &operator=(handle &&other) noexcept {
+        if (this != &other) {
+            reset();
+            q_   = std::exchange(other.q_, nullptr);
+            tid_ = other.tid_;
+        }
+        return *this;
+    }
+
+    ~handle() { reset(); }
+
+    bool push(T &&value) { return q_->push(std::move(value), tid_); }
+
+    bool push(T const &value)
+        requires std::is_copy_constructible_v<T>
+    {
+        return q_->push(value, tid_);
+    }
+
+    std::optional<T> pop() { return q_->pop(tid_); }
+    bool             empty() { return q_->empty(tid_); }
+    std::size_t      size_approx() { return q_->size_approx(tid_); }
+    int              tid() const noexcept { return tid_; }
+
+  private:
+    friend class queue;
+
+    handle(queue *q, int tid) : q_(q), tid_(tid) {}
+
+    void reset() noexcept {
+        if (q_ != nullptr) {
+            q_->release_tid(tid_);
+            q_ = nullptr;
+        }
+    }
+
+    queue *q_;
+    int    tid_;
+};
+
+} // namespace faaq
+
+#endif // FAAQ_HPP
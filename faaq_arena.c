@@ -0,0 +1,230 @@
+#define _GNU_SOURCE
+#include "faaq_arena.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+constexpr static uint32_t FAA_ARENA_NIL = UINT32_MAX;
+
+// Every chunk starts with this header; objects follow at FAA_ARENA_ALIGNMENT.
+typedef struct {
+    uint32_t chunk_no;
+} FAAArenaChunk_t;
+
+static inline uint64_t
+tagged(uint64_t tag, uint32_t idx) {
+    return tag << 32 | idx;
+}
+
+static inline char *
+object_at(FAAArena_t *a, uint32_t idx) {
+    char *chunk = atomic_load_explicit(&a->chunks[idx / a->per_chunk], memory_order_acquire);
+    return chunk + FAA_ARENA_ALIGNMENT + (size_t) (idx % a->per_chunk) * a->obj_size;
+}
+
+static inline uint32_t
+index_of(FAAArena_t const *a, void const *obj) {
+    char const            *chunk = (char const *) ((uintptr_t) obj & ~(uintptr_t) (FAA_ARENA_CHUNK_SIZE - 1));
+    FAAArenaChunk_t const *hdr   = (FAAArenaChunk_t const *) chunk;
+    size_t const           slot  = (size_t) ((char const *) obj - chunk - FAA_ARENA_ALIGNMENT) / a->obj_size;
+    return hdr->chunk_no * a->per_chunk + (uint32_t) slot;
+}
+
+// A free object stores the index of the next free object in its first bytes.
+static inline _Atomic(uint32_t) *
+link_of(void *obj) {
+    return (_Atomic(uint32_t) *) obj;
+}
+
+// Maps one chunk aligned to FAA_ARENA_CHUNK_SIZE, preferring explicit huge
+// pages when requested. Returns nullptr on failure.
+static char *
+map_chunk(FAAArena_t *a) {
+#ifdef MAP_HUGETLB
+    if (a->hugetlb) {
+        void *p = mmap(
+            nullptr, FAA_ARENA_CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0
+        );
+        if (p != MAP_FAILED) {
+            if (((uintptr_t) p & (FAA_ARENA_CHUNK_SIZE - 1)) == 0) {
+                atomic_fetch_add_explicit(&a->hugetlb_chunks, 1, memory_order_relaxed);
+                return p;
+            }
+            // The default huge page size is smaller than a chunk.
+            munmap(p, FAA_ARENA_CHUNK_SIZE);
+        }
+    }
+#endif
+
+    // Over-map and trim so the chunk is aligned, which transparent huge pages
+    // need to back it with a single page.
+    size_t const span = 2 * FAA_ARENA_CHUNK_SIZE;
+    char        *raw  = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    uintptr_t const aligned = ((uintptr_t) raw + FAA_ARENA_CHUNK_SIZE - 1) & ~(uintptr_t) (FAA_ARENA_CHUNK_SIZE - 1);
+    char           *chunk   = (char *) aligned;
+    if (chunk > raw) {
+        munmap(raw, (size_t) (chunk - raw));
+    }
+    if (chunk + FAA_ARENA_CHUNK_SIZE < raw + span) {
+        munmap(chunk + FAA_ARENA_CHUNK_SIZE, (size_t) (raw + span - chunk - FAA_ARENA_CHUNK_SIZE));
+    }
+#ifdef MADV_HUGEPAGE
+    // Advisory only; fails harmlessly when THP is disabled.
+    madvise(chunk, FAA_ARENA_CHUNK_SIZE, MADV_HUGEPAGE);
+#endif
+    return chunk;
+}
+
+FAAArena_t *
+faa_arena_create(size_t obj_size, bool hugetlb) {
+    size_t const size = (obj_size + FAA_ARENA_ALIGNMENT - 1) / FAA_ARENA_ALIGNMENT * FAA_ARENA_ALIGNMENT;
+    if (size == 0 || size > FAA_ARENA_CHUNK_SIZE - FAA_ARENA_ALIGNMENT) {
+        fprintf(stderr, "C23 FAAQueue Error: Arena object size %zu does not fit a chunk.\n", obj_size);
+        return nullptr;
+    }
+
+    FAAArena_t *a = aligned_alloc(FAA_ARENA_ALIGNMENT, sizeof(FAAArena_t));
+    if (!a) {
+        return nullptr;
+    }
+    if (mtx_init(&a->grow_lock, mtx_plain) != thrd_success) {
+        free(a);
+        return nullptr;
+    }
+
+    a->obj_size  = size;
+    a->per_chunk = (uint32_t) ((FAA_ARENA_CHUNK_SIZE - FAA_ARENA_ALIGNMENT) / size);
+    a->hugetlb   = hugetlb;
+    for (uint32_t i = 0; i < FAA_ARENA_MAX_CHUNKS; i++) {
+        atomic_init(&a->chunks[i], nullptr);
+    }
+    atomic_init(&a->num_chunks, 0);
+    atomic_init(&a->hugetlb_chunks, 0);
+    atomic_init(&a->free_top, tagged(0, FAA_ARENA_NIL));
+    atomic_init(&a->refs, 1);
+    return a;
+}
+
+static void
+arena_destroy(FAAArena_t *a) {
+    uint32_t const n = atomic_load_explicit(&a->num_chunks, memory_order_relaxed);
+    for (uint32_t i = 0; i < n; i++) {
+        munmap(atomic_load_explicit(&a->chunks[i], memory_order_relaxed), FAA_ARENA_CHUNK_SIZE);
+    }
+    mtx_destroy(&a->grow_lock);
+    free(a);
+}
+
+static inline void
+arena_unref(FAAArena_t *a) {
+    if (atomic_fetch_sub_explicit(&a->refs, 1, memory_order_release) == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        arena_destroy(a);
+    }
+}
+
+static uint32_t
+pop_free(FAAArena_t *a) {
+    uint64_t old = atomic_load_explicit(&a->free_top, memory_order_acquire);
+    while (true) {
+        uint32_t const idx = (uint32_t) old;
+        if (idx == FAA_ARENA_NIL) {
+            return FAA_ARENA_NIL;
+        }
+        // The link may be stale if 'idx' was popped meanwhile; the tag makes
+        // the CAS below fail in that case.
+        uint32_t const next = atomic_load_explicit(link_of(object_at(a, idx)), memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(
+                &a->free_top, &old, tagged((old >> 32) + 1, next), memory_order_acquire, memory_order_acquire
+            )) {
+            return idx;
+        }
+    }
+}
+
+// Pushes the chain first..last, already linked through their first bytes.
+static void
+push_free(FAAArena_t *a, uint32_t first, void *last) {
+    uint64_t old = atomic_load_explicit(&a->free_top, memory_order_relaxed);
+    do {
+        atomic_store_explicit(link_of(last), (uint32_t) old, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(
+        &a->free_top, &old, tagged((old >> 32) + 1, first), memory_order_release, memory_order_relaxed
+    ));
+}
+
+// Maps a new chunk, keeps its first object and pushes the rest on the
+// freelist. Returns the kept object's index, or FAA_ARENA_NIL.
+static uint32_t
+grow(FAAArena_t *a) {
+    mtx_lock(&a->grow_lock);
+
+    // Another thread may have grown the arena while we waited.
+    uint32_t idx = pop_free(a);
+    if (idx != FAA_ARENA_NIL) {
+        mtx_unlock(&a->grow_lock);
+        return idx;
+    }
+
+    uint32_t const n = atomic_load_explicit(&a->num_chunks, memory_order_relaxed);
+    char          *chunk;
+    if (n == FAA_ARENA_MAX_CHUNKS || (chunk = map_chunk(a)) == nullptr) {
+        mtx_unlock(&a->grow_lock);
+        return FAA_ARENA_NIL;
+    }
+    ((FAAArenaChunk_t *) chunk)->chunk_no = n;
+    atomic_store_explicit(&a->chunks[n], chunk, memory_order_release);
+    atomic_store_explicit(&a->num_chunks, n + 1, memory_order_release);
+
+    uint32_t const base = n * a->per_chunk;
+    if (a->per_chunk > 1) {
+        for (uint32_t i = 1; i + 1 < a->per_chunk; i++) {
+            atomic_store_explicit(link_of(object_at(a, base + i)), base + i + 1, memory_order_relaxed);
+        }
+        push_free(a, base + 1, object_at(a, base + a->per_chunk - 1));
+    }
+
+    mtx_unlock(&a->grow_lock);
+    return base;
+}
+
+void *
+faa_arena_alloc(FAAArena_t *a) {
+    assert(a != nullptr);
+    uint32_t idx = pop_free(a);
+    if (idx == FAA_ARENA_NIL) {
+        idx = grow(a);
+        if (idx == FAA_ARENA_NIL) {
+            return nullptr;
+        }
+    }
+    atomic_fetch_add_explicit(&a->refs, 1, memory_order_relaxed);
+    return object_at(a, idx);
+}
+
+void
+faa_arena_free(FAAArena_t *a, void *obj) {
+    assert(a != nullptr && obj != nullptr);
+    push_free(a, index_of(a, obj), obj);
+    arena_unref(a);
+}
+
+void
+faa_arena_release(FAAArena_t *a) {
+    if (a) {
+        arena_unref(a);
+    }
+}
+
+void
+faa_arena_stats(FAAArena_t *a, FAAArenaStats_t *stats) {
+    assert(a != nullptr && stats != nullptr);
+    stats->chunks         = atomic_load_explicit(&a->num_chunks, memory_order_relaxed);
+    stats->hugetlb_chunks = atomic_load_explicit(&a->hugetlb_chunks, memory_order_relaxed);
+    stats->live           = atomic_load_explicit(&a->refs, memory_order_relaxed) - 1;
+}
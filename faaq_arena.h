@@ -0,0 +1,91 @@
+#ifndef FAA_ARENA_H
+#define FAA_ARENA_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-size object arena backed by huge pages.
+//
+// Memory is reserved in FAA_ARENA_CHUNK_SIZE chunks with mmap, each aligned to
+// its size so that it can be backed by a single 2 MiB huge page, and carved
+// into objects. Freed objects go to a lock-free freelist and are reused before
+// a new chunk is mapped. Chunks are only unmapped when the arena goes away.
+
+constexpr static size_t   FAA_ARENA_CHUNK_SIZE = (size_t) 2 << 20;
+constexpr static uint32_t FAA_ARENA_MAX_CHUNKS = 4096;
+constexpr static size_t   FAA_ARENA_ALIGNMENT  = 128;
+
+typedef struct {
+    // Chunk table; object index i lives in chunks[i / per_chunk].
+    _Atomic(char *) chunks[FAA_ARENA_MAX_CHUNKS];
+    size_t          obj_size;
+    uint32_t        per_chunk;
+    bool            hugetlb;
+
+    // Serializes mapping new chunks (rare).
+    mtx_t           grow_lock;
+    _Atomic(uint32_t) num_chunks;
+    _Atomic(uint32_t) hugetlb_chunks;
+
+    // Treiber stack of free object indices, tag in the upper 32 bits.
+    alignas(FAA_ARENA_ALIGNMENT) _Atomic(uint64_t) free_top;
+
+    // One reference for the owner plus one per object handed out. The arena
+    // is unmapped when it drops to zero.
+    alignas(FAA_ARENA_ALIGNMENT) _Atomic(uint64_t) refs;
+} FAAArena_t;
+
+typedef struct {
+    uint32_t chunks;         // Chunks mapped so far.
+    uint32_t hugetlb_chunks; // Of those, chunks backed by MAP_HUGETLB.
+    uint64_t live;           // Objects currently handed out.
+} FAAArenaStats_t;
+
+/**
+ * @brief Creates an arena for objects of 'obj_size' bytes. Objects are aligned
+ * to FAA_ARENA_ALIGNMENT.
+ *
+ * @param obj_size Object size. Must fit in a chunk.
+ * @param hugetlb Try MAP_HUGETLB first for every chunk. Without it, or when no
+ * explicit huge pages are available, chunks use regular pages with
+ * MADV_HUGEPAGE so transparent huge pages can back them.
+ * @return The arena, or nullptr on failure.
+ */
+[[nodiscard("Arena creation failure must be handled")]]
+FAAArena_t *faa_arena_create(size_t obj_size, bool hugetlb);
+
+/**
+ * @brief Takes an object from the arena. Its contents are unspecified.
+ *
+ * @return The object, or nullptr if no memory could be mapped.
+ */
+void       *faa_arena_alloc(FAAArena_t *a);
+
+/**
+ * @brief Returns an object to the arena. Safe to call from any thread.
+ */
+void        faa_arena_free(FAAArena_t *a, void *obj);
+
+/**
+ * @brief Drops the owner's reference. The memory is unmapped once every
+ * outstanding object has been freed as well.
+ */
+void        faa_arena_release(FAAArena_t *a);
+
+/**
+ * @brief Takes a snapshot of the arena's counters.
+ */
+void        faa_arena_stats(FAAArena_t *a, FAAArenaStats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAA_ARENA_H
@@ -0,0 +1,341 @@
+#ifndef FAAQ_ASYNC_HPP
+#define FAAQ_ASYNC_HPP
+
+// Awaitable dequeue for C++20 coroutines.
+//
+// faaq::async_queue<T, SegmentSize, Policy> is a faaq::queue whose pop() can be
+// co_awaited. The await completes without suspending when an item is there.
+// Otherwise the coroutine is put on a list of waiters, and a later push()
+// dequeues an item on its behalf, then resumes it on the pushing thread or
+// schedules it on the executor it awaited with.
+//
+// The waiter list is lock-free: waiters are pushed onto a stack, and a pusher
+// that finds it non-empty takes the whole stack with one exchange, serves a
+// waiter and splices the rest back. Nodes are never popped one at a time, so
+// no node can be read after another thread freed it and there is no ABA. A
+// push() that finds no waiters does one load more than faaq::queue::push().
+//
+// Because pushers dequeue for waiters, the policy's topology must allow several
+// consumers: FAA_TOPOLOGY_MPMC or FAA_TOPOLOGY_SPMC.
+
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include "faaq.hpp"
+
+namespace faaq {
+
+/**
+ * @brief Anything a suspended pop() can be handed to instead of being resumed
+ * on the pushing thread.
+ *
+ * schedule() may be called from any thread and must eventually resume 'h'.
+ */
+template <class E>
+concept executor = requires(E &e, std::coroutine_handle<> h) { e.schedule(h); };
+
+template <class T, std::size_t SegmentSize = FAA_BUFFER_SIZE, class Policy = policy<>>
+class async_queue {
+    using queue_type = queue<T, SegmentSize, Policy>;
+
+    // A push() that serves a waiter dequeues on its behalf, concurrently with
+    // the consumers' own dequeues, so the queue always has several consumers.
+    static_assert(
+        Policy::topology == FAA_TOPOLOGY_MPMC || Policy::topology == FAA_TOPOLOGY_SPMC,
+        "async_queue dequeues from pushing threads too and needs a multi-consumer topology"
+    );
+
+    // Waiter states. A notifier CLAIMS a waiter before dequeuing for it and
+    // sets DELIVERED once the item is in place; the waiting side CANCELS a
+    // waiter nobody claimed, or marks it PARKED when it lets the coroutine
+    // suspend. Whichever of DELIVERED and PARKED comes second resumes.
+    static constexpr unsigned CLAIMED   = 1;
+    static constexpr unsigned CANCELLED = 2;
+    static constexpr unsigned DELIVERED = 4;
+    static constexpr unsigned PARKED    = 8;
+
+    struct waiter {
+        waiter                 *next = nullptr;
+        std::atomic<unsigned>   state{0};
+        // One reference for the list and one for the suspending await.
+        std::atomic<int>        refs{2};
+        std::optional<T>       *slot;
+        std::coroutine_handle<> continuation;
+        void (*schedule)(void *, std::coroutine_handle<>);
+        void *executor;
+    };
+
+  public:
+    using value_type = T;
+
+    class pop_awaiter;
+    class handle;
+
+    /**
+     * @brief Creates a queue for up to 'max_threads' concurrent users.
+     */
+    explicit async_queue(int max_threads) : queue_(max_threads) {}
+
+    /**
+     * @brief Destroys the queue. No coroutine may still be waiting on it.
+     */
+    ~async_queue() {
+        waiter *w = waiters_.exchange(nullptr, std::memory_order_acquire);
+        while (w != nullptr) {
+            waiter *next = w->next;
+            unref(w);
+            w = next;
+        }
+    }
+
+    async_queue(async_queue const &)            = delete;
+    async_queue &operator=(async_queue const &) = delete;
+
+    /**
+     * @brief Reserves a thread ID, as faaq::queue::get_handle().
+     */
+    handle get_handle() { return handle(this, queue_.get_handle()); }
+
+    /**
+     * @brief Enqueues 'value' and, if coroutines are waiting, serves one.
+     *
+     * A waiter without an executor is resumed on this thread before push()
+     * returns.
+     */
+    bool push(T &&value, int tid) {
+        if (!queue_.push(std::move(value), tid)) {
+            return false;
+        }
+        // Orders the item store before the load of the waiter list, pairing
+        // with the fence between registering a waiter and checking the queue
+        // (a store-load, Dekker-style handshake).
+        faa_fence_after_enqueue(Policy::topology);
+        if (waiters_.load(std::memory_order_relaxed) != nullptr) [[unlikely]] {
+            notify(tid);
+        }
+        return true;
+    }
+
+    bool push(T const &value, int tid)
+        requires std::is_copy_constructible_v<T>
+    {
+        T copy(value);
+        return push(std::move(copy), tid);
+    }
+
+    std::optional<T> try_pop(int tid) { return queue_.pop(tid); }
+
+    /**
+     * @brief Returns an awaitable dequeue; a waiting coroutine is resumed by
+     * the thread whose push() serves it.
+     */
+    pop_awaiter pop(int tid) { return pop_awaiter(this, tid, nullptr, nullptr); }
+
+    /**
+     * @brief As pop(tid), but a waiting coroutine is handed to 'exec'.
+     */
+    template <executor E>
+    pop_awaiter pop(int tid, E &exec) {
+        return pop_awaiter(this, tid, &exec, [](void *e, std::coroutine_handle<> h) { static_cast<E *>(e)->schedule(h); });
+    }
+
+    bool        empty(int tid) { return queue_.empty(tid); }
+    std::size_t size_approx(int tid) { return queue_.size_approx(tid); }
+
+    // The underlying queue. Items pushed through it do not wake waiters.
+    queue_type &underlying() noexcept { return queue_; }
+
+  private:
+    static void unref(waiter *w) noexcept {
+        if (w->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete w;
+        }
+    }
+
+    void push_waiters(waiter *first, waiter *last) noexcept {
+        waiter *head = waiters_.load(std::memory_order_relaxed);
+        do {
+            last->next = head;
+        } while (!waiters_.compare_exchange_weak(head, first, std::memory_order_seq_cst, std::memory_order_relaxed));
+    }
+
+    // Called from await_suspend() once the queue was seen empty. Returns
+    // whether the coroutine stays suspended.
+    bool suspend(pop_awaiter &aw, std::coroutine_handle<> h) {
+        while (true) {
+            waiter *w       = new waiter;
+            w->slot         = &aw.result_;
+            w->continuation = h;
+            w->schedule     = aw.schedule_;
+            w->executor     = aw.executor_;
+            push_waiters(w, w);
+
+            // An item enqueued before the push above is seen here; one
+            // enqueued after it sees the waiter (see push()).
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!queue_.empty(aw.tid_)) {
+                unsigned expected = 0;
+                if (w->state.compare_exchange_strong(expected, CANCELLED, std::memory_order_acq_rel)) {
+                    // The next notify() drops the cancelled node.
+                    unref(w);
+                    aw.result_ = queue_.pop(aw.tid_);
+                    if (aw.result_) {
+                        return false;
+                    }
+                    continue;
+                }
+                // A notifier claimed it and is dequeuing for us.
+            }
+
+            unsigned const prev = w->state.fetch_or(PARKED, std::memory_order_acq_rel);
+            unref(w);
+            // Unless the item was already delivered, the coroutine may now be
+            // resumed on another thread: nothing here may touch 'aw' again.
+            return (prev & DELIVERED) == 0;
+        }
+    }
+
+    // Serves waiters while there are both waiters and items. Waiters are
+    // resumed only after the list has been put back.
+    void notify(int tid) {
+        waiter *ready = nullptr;
+        while (true) {
+            waiter *chain = waiters_.exchange(nullptr, std::memory_order_acquire);
+            while (chain != nullptr) {
+                waiter  *w = chain;
+                unsigned s = w->state.load(std::memory_order_relaxed);
+                do {
+                    if (s & CANCELLED) {
+                        break;
+                    }
+                } while (!w->state.compare_exchange_weak(s, s | CLAIMED, std::memory_order_acq_rel));
+                chain = w->next;
+                if (s & CANCELLED) {
+                    unref(w);
+                    continue;
+                }
+
+                std::optional<T> v = queue_.pop(tid);
+                if (!v) {
+                    // Another consumer got there first; w keeps waiting.
+                    w->state.fetch_and(~CLAIMED, std::memory_order_release);
+                    w->next = chain;
+                    chain   = w;
+                    break;
+                }
+                w->slot->emplace(std::move(*v));
+                if (w->state.fetch_or(DELIVERED, std::memory_order_acq_rel) & PARKED) {
+                    w->next = ready;
+                    ready   = w;
+                } else {
+                    unref(w);
+                }
+                break;
+            }
+            if (chain == nullptr) {
+                break;
+            }
+
+            waiter *last = chain;
+            while (last->next != nullptr) {
+                last = last->next;
+            }
+            push_waiters(chain, last);
+            // Pushes that ran while the list was taken saw no waiters, so
+            // their items are served here.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (queue_.empty(tid)) {
+                break;
+            }
+        }
+
+        while (ready != nullptr) {
+            waiter                 *w        = ready;
+            std::coroutine_handle<> h        = w->continuation;
+            auto                    schedule = w->schedule;
+            void                   *exec     = w->executor;
+            ready                            = w->next;
+            unref(w);
+            if (schedule != nullptr) {
+                schedule(exec, h);
+            } else {
+                h.resume();
+            }
+        }
+    }
+
+    queue_type           queue_;
+    std::atomic<waiter *> waiters_{nullptr};
+};
+
+/**
+ * @brief The awaitable returned by pop(). co_await yields the dequeued T.
+ */
+template <class T, std::size_t SegmentSize, class Policy>
+class async_queue<T, SegmentSize, Policy>::pop_awaiter {
+  public:
+    bool await_ready() {
+        result_ = q_->try_pop(tid_);
+        return result_.has_value();
+    }
+
+    bool await_suspend(std::coroutine_handle<> h) { return q_->suspend(*this, h); }
+
+    T    await_resume() { return std::move(*result_); }
+
+  private:
+    friend class async_queue;
+
+    pop_awaiter(async_queue *q, int tid, void *exec, void (*schedule)(void *, std::coroutine_handle<>))
+        : q_(q), tid_(tid), executor_(exec), schedule_(schedule) {}
+
+    async_queue     *q_;
+    int              tid_;
+    void            *executor_;
+    void (*schedule_)(void *, std::coroutine_handle<>);
+    std::optional<T> result_;
+};
+
+/**
+ * @brief A thread ID reserved from an async_queue, released on destruction.
+ *
+ * A coroutine may hold a handle across suspensions, wherever it is resumed,
+ * as long as only one thread uses the handle at a time.
+ */
+template <class T, std::size_t SegmentSize, class Policy>
+class async_queue<T, SegmentSize, Policy>::handle {
+  public:
+    bool push(T &&value) { return q_->push(std::move(value), h_.tid()); }
+
+    bool push(T const &value)
+        requires std::is_copy_constructible_v<T>
+    {
+        return q_->push(value, h_.tid());
+    }
+
+    std::optional<T> try_pop() { return q_->try_pop(h_.tid()); }
+    pop_awaiter      pop() { return q_->pop(h_.tid()); }
+
+    template <executor E>
+    pop_awaiter pop(E &exec) {
+        return q_->pop(h_.tid(), exec);
+    }
+
+    int tid() const noexcept { return h_.tid(); }
+
+  private:
+    friend class async_queue;
+
+    handle(async_queue *q, typename queue_type::handle h) : q_(q), h_(std::move(h)) {}
+
+    async_queue                *q_;
+    typename queue_type::handle h_;
+};
+
+} // namespace faaq
+
+#endif // FAAQ_ASYNC_HPP
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "faaq_async.hpp"
+
+// Coroutine consumers on faaq::async_queue versus threads blocking on a
+// mutex/condition-variable channel. Two workloads: producers pushing as fast as
+// they can (throughput), and one producer pacing items so that consumers are
+// usually waiting (latency from push to the consumer having the item).
+
+static constexpr uint32_t THROUGHPUT_ITEMS = 4000000;
+static constexpr uint32_t LATENCY_ITEMS    = 20000;
+static constexpr uint64_t LATENCY_GAP_NS   = 20000;
+// Pushed once per consumer after the producers finish.
+static constexpr uint32_t STOP             = UINT32_MAX;
+
+static int const          THREAD_COUNTS[]  = {2, 4, 8, 16};
+
+static uint64_t
+now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count()
+    );
+}
+
+// --- Engines ---
+
+// Unbounded channel: a deque under a mutex, consumers block on a condition
+// variable.
+class cv_channel {
+  public:
+    void push(uint32_t v) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            items_.push_back(v);
+        }
+        cv_.notify_one();
+    }
+
+    uint32_t pop() {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [this] { return !items_.empty(); });
+        uint32_t const v = items_.front();
+        items_.pop_front();
+        return v;
+    }
+
+  private:
+    std::mutex              mu_;
+    std::condition_variable cv_;
+    std::deque<uint32_t>    items_;
+};
+
+// Runs one coroutine on the thread that calls run(); schedule() wakes it.
+struct mailbox_executor {
+    std::atomic<void *> next{nullptr};
+    std::atomic<bool>   done{false};
+
+    void                schedule(std::coroutine_handle<> h) {
+        next.store(h.address(), std::memory_order_release);
+        next.notify_one();
+    }
+
+    void run() {
+        while (!done.load(std::memory_order_acquire)) {
+            next.wait(nullptr, std::memory_order_acquire);
+            void *h = next.exchange(nullptr, std::memory_order_acquire);
+            if (h != nullptr) {
+                std::coroutine_handle<>::from_address(h).resume();
+            }
+        }
+    }
+};
+
+struct task {
+    struct promise_type {
+        task               get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void               return_void() {}
+        [[noreturn]] void  unhandled_exception() { abort(); }
+    };
+};
+
+using async_u32 = faaq::async_queue<uint32_t>;
+
+enum engine_t {
+    ENGINE_CO_INLINE = 0, // coroutines resumed by the producer that serves them
+    ENGINE_CO_EXEC,       // coroutines resumed on their consumer thread
+    ENGINE_CONDVAR,
+};
+
+static char const *const ENGINE_NAMES[] = {"co-inline", "co-executor", "condvar"};
+
+// --- Workloads ---
+
+struct run_ctx {
+    uint32_t              items;
+    // Send times by item, only for the latency workload.
+    std::vector<uint64_t> sent;
+    std::atomic<int>      finished{0};
+    std::vector<uint64_t> latencies[64];
+};
+
+static void
+record(run_ctx &ctx, int consumer, uint32_t v) {
+    if (!ctx.sent.empty()) {
+        ctx.latencies[consumer].push_back(now_ns() - ctx.sent[v]);
+    }
+}
+
+template <class E>
+task
+co_consume(run_ctx &ctx, int consumer, async_u32::handle h, E *exec) {
+    while (true) {
+        uint32_t const v = exec != nullptr ? co_await h.pop(*exec) : co_await h.pop();
+        if (v == STOP) {
+            break;
+        }
+        record(ctx, consumer, v);
+    }
+    ctx.finished.fetch_add(1, std::memory_order_release);
+    ctx.finished.notify_all();
+}
+
+// Pushes items [first, first + count), pacing them 'gap_ns' apart if non-zero.
+template <class Push>
+static void
+produce(run_ctx &ctx, uint32_t first, uint32_t count, uint64_t gap_ns, Push push) {
+    uint64_t next = now_ns();
+    for (uint32_t i = first; i < first + count; i++) {
+        if (gap_ns != 0) {
+            while (now_ns() < next) {
+            }
+            next += gap_ns;
+            ctx.sent[i] = now_ns();
+        }
+        push(i);
+    }
+}
+
+// Returns the elapsed time in nanoseconds.
+static uint64_t
+run_once(engine_t engine, run_ctx &ctx, int producers, int consumers, uint64_t gap_ns) {
+    std::vector<std::thread>      threads;
+    uint32_t const                per_producer = ctx.items / static_cast<uint32_t>(producers);
+    std::optional<async_u32>      q;
+    std::optional<cv_channel>     ch;
+    std::vector<mailbox_executor> execs(static_cast<size_t>(consumers));
+
+    if (engine == ENGINE_CONDVAR) {
+        ch.emplace();
+        for (int c = 0; c < consumers; c++) {
+            threads.emplace_back([&ctx, &ch, c] {
+                for (uint32_t v = ch->pop(); v != STOP; v = ch->pop()) {
+                    record(ctx, c, v);
+                }
+            });
+        }
+    } else {
+        q.emplace(producers + consumers + 1);
+        for (int c = 0; c < consumers; c++) {
+            if (engine == ENGINE_CO_EXEC) {
+                threads.emplace_back([&ctx, &execs, c, h = q->get_handle()]() mutable {
+                    co_consume(ctx, c, std::move(h), &execs[c]);
+                    execs[c].run();
+                });
+            } else {
+                co_consume<mailbox_executor>(ctx, c, q->get_handle(), nullptr);
+            }
+        }
+    }
+
+    uint64_t const start = now_ns();
+    std::vector<std::thread> prod;
+    for (int p = 0; p < producers; p++) {
+        uint32_t const first = static_cast<uint32_t>(p) * per_producer;
+        if (engine == ENGINE_CONDVAR) {
+            prod.emplace_back([&, first] { produce(ctx, first, per_producer, gap_ns, [&](uint32_t v) { ch->push(v); }); });
+        } else {
+            prod.emplace_back([&, first, h = q->get_handle()]() mutable {
+                produce(ctx, first, per_producer, gap_ns, [&](uint32_t v) { h.push(v); });
+            });
+        }
+    }
+    for (auto &t : prod) {
+        t.join();
+    }
+
+    if (engine == ENGINE_CONDVAR) {
+        for (int c = 0; c < consumers; c++) {
+            ch->push(STOP);
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    } else {
+        {
+            auto h = q->get_handle();
+            for (int c = 0; c < consumers; c++) {
+                h.push(STOP);
+            }
+        }
+        for (int f = ctx.finished.load(std::memory_order_acquire); f < consumers;
+             f = ctx.finished.load(std::memory_order_acquire)) {
+            ctx.finished.wait(f, std::memory_order_acquire);
+        }
+        for (auto &e : execs) {
+            e.done.store(true, std::memory_order_release);
+            e.schedule(std::noop_coroutine());
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+    return now_ns() - start;
+}
+
+static void
+run_throughput() {
+    printf("--- Throughput (%u items, half producers, half consumers) ---\n", THROUGHPUT_ITEMS);
+    printf("%-8s", "Threads");
+    for (char const *name : ENGINE_NAMES) {
+        printf(" %16s", name);
+    }
+    printf("\n");
+
+    for (int threads_n : THREAD_COUNTS) {
+        printf("%-8d", threads_n);
+        for (int e = 0; e <= ENGINE_CONDVAR; e++) {
+            run_ctx ctx;
+            ctx.items              = THROUGHPUT_ITEMS;
+            uint64_t const elapsed = run_once(static_cast<engine_t>(e), ctx, threads_n / 2, threads_n / 2, 0);
+            printf(" %11.2f Mops", static_cast<double>(THROUGHPUT_ITEMS) * 1e3 / static_cast<double>(elapsed));
+        }
+        printf("\n");
+    }
+}
+
+static void
+run_latency() {
+    printf("\n--- Wake-Up Latency (1 producer, %u items %.0f us apart) ---\n", LATENCY_ITEMS, LATENCY_GAP_NS / 1e3);
+    printf("%-10s %-12s %10s %10s %10s\n", "Consumers", "Engine", "p50 (ns)", "p99 (ns)", "max (ns)");
+
+    for (int consumers : {1, 4}) {
+        for (int e = 0; e <= ENGINE_CONDVAR; e++) {
+            run_ctx ctx;
+            ctx.items = LATENCY_ITEMS;
+            ctx.sent.assign(LATENCY_ITEMS, 0);
+            run_once(static_cast<engine_t>(e), ctx, 1, consumers, LATENCY_GAP_NS);
+
+            std::vector<uint64_t> all;
+            for (auto const &l : ctx.latencies) {
+                all.insert(all.end(), l.begin(), l.end());
+            }
+            std::sort(all.begin(), all.end());
+            printf(
+                "%-10d %-12s %10llu %10llu %10llu\n",
+                consumers,
+                ENGINE_NAMES[e],
+                static_cast<unsigned long long>(all[all.size() / 2]),
+                static_cast<unsigned long long>(all[all.size() * 99 / 100]),
+                static_cast<unsigned long long>(all.back())
+            );
+        }
+    }
+}
+
+int
+main() {
+    printf("--- Coroutine Pop Benchmark ---\n");
+    printf("Online CPUs: %u\n\n", std::thread::hardware_concurrency());
+    run_throughput();
+    run_latency();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,277 @@
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "faaq_async.hpp"
+
+static constexpr int      ASYNC_PRODUCERS    = 4;
+static constexpr int      ASYNC_CONSUMERS    = 4;
+static constexpr uint32_t ITEMS_PER_PRODUCER = 200000;
+
+static constexpr int      ASYNC_TOTAL        = ASYNC_PRODUCERS + ASYNC_CONSUMERS;
+static constexpr uint32_t ASYNC_TOTAL_ITEMS  = ASYNC_PRODUCERS * ITEMS_PER_PRODUCER;
+// Pushed once per consumer after the producers finish.
+static constexpr uint32_t STOP               = UINT32_MAX;
+
+static void
+check(bool ok, char const *what) {
+    if (!ok) {
+        fprintf(stderr, "FAILED! %s\n", what);
+        abort();
+    }
+}
+
+// Fire-and-forget coroutine: runs until its first suspension when called and
+// frees itself when it finishes.
+struct task {
+    struct promise_type {
+        task                get_return_object() { return {}; }
+        std::suspend_never  initial_suspend() noexcept { return {}; }
+        std::suspend_never  final_suspend() noexcept { return {}; }
+        void                return_void() {}
+        [[noreturn]] void   unhandled_exception() { abort(); }
+    };
+};
+
+// Keeps scheduled coroutines until run() is called.
+struct manual_executor {
+    std::vector<std::coroutine_handle<>> ready;
+
+    void                                 schedule(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    void                                 run() {
+        std::vector<std::coroutine_handle<>> batch;
+        batch.swap(ready);
+        for (auto h : batch) {
+            h.resume();
+        }
+    }
+};
+
+// Runs coroutines scheduled on it on its own thread, one at a time.
+struct thread_executor {
+    std::atomic<void *> next{nullptr};
+    std::atomic<bool>   done{false};
+
+    void                schedule(std::coroutine_handle<> h) {
+        next.store(h.address(), std::memory_order_release);
+        next.notify_one();
+    }
+
+    void run() {
+        while (!done.load(std::memory_order_acquire)) {
+            next.wait(nullptr, std::memory_order_acquire);
+            void *h = next.exchange(nullptr, std::memory_order_acquire);
+            if (h != nullptr) {
+                std::coroutine_handle<>::from_address(h).resume();
+            }
+        }
+    }
+};
+
+using async_u32 = faaq::async_queue<uint32_t>;
+
+task
+pop_into(async_u32::handle &h, std::optional<uint32_t> &out) {
+    out = co_await h.pop();
+}
+
+template <class E>
+task
+pop_into_on(async_u32::handle &h, E &exec, std::optional<uint32_t> &out) {
+    out = co_await h.pop(exec);
+}
+
+task
+pop_unique(faaq::async_queue<std::unique_ptr<int>>::handle &h, int &out) {
+    std::unique_ptr<int> p = co_await h.pop();
+    out                    = *p;
+}
+
+void
+run_basic_tests() {
+    printf("--- Starting Basic Coroutine Pop Tests ---\n");
+
+    {
+        async_u32               q(2);
+        auto                    producer = q.get_handle();
+        auto                    consumer = q.get_handle();
+        std::optional<uint32_t> out;
+
+        check(producer.push(7), "push failed");
+        pop_into(consumer, out);
+        check(out == 7u, "ready pop did not complete synchronously");
+    }
+    printf("Test 1 (Synchronous Completion): PASSED\n");
+
+    {
+        async_u32               q(2);
+        auto                    producer = q.get_handle();
+        auto                    consumer = q.get_handle();
+        std::optional<uint32_t> out;
+
+        pop_into(consumer, out);
+        check(!out, "pop on an empty queue completed");
+        check(producer.push(9), "push failed");
+        check(out == 9u, "waiter not resumed by push");
+        check(consumer.try_pop() == std::nullopt, "item delivered twice");
+    }
+    printf("Test 2 (Resumed by Push): PASSED\n");
+
+    {
+        async_u32               q(2);
+        auto                    producer = q.get_handle();
+        auto                    consumer = q.get_handle();
+        manual_executor         exec;
+        std::optional<uint32_t> out;
+
+        pop_into_on(consumer, exec, out);
+        check(producer.push(11), "push failed");
+        check(!out && exec.ready.size() == 1, "waiter not handed to the executor");
+        exec.run();
+        check(out == 11u, "executor resumed with the wrong item");
+    }
+    printf("Test 3 (Executor Scheduling): PASSED\n");
+
+    {
+        async_u32                            q(4);
+        auto                                 producer = q.get_handle();
+        auto                                 a        = q.get_handle();
+        auto                                 b        = q.get_handle();
+        auto                                 c        = q.get_handle();
+        std::optional<uint32_t>              out[3];
+
+        pop_into(a, out[0]);
+        pop_into(b, out[1]);
+        pop_into(c, out[2]);
+        for (uint32_t i = 0; i < 3; i++) {
+            check(producer.push(100 + i), "push failed");
+        }
+        check(out[0] && out[1] && out[2], "not every waiter was served");
+        check(*out[0] + *out[1] + *out[2] == 303, "waiters got the wrong items");
+        check(q.empty(producer.tid()), "queue not empty");
+    }
+    printf("Test 4 (One Item per Waiter): PASSED\n");
+
+    {
+        faaq::async_queue<std::unique_ptr<int>> q(2);
+        auto                                    producer = q.get_handle();
+        auto                                    consumer = q.get_handle();
+        int                                     out      = 0;
+
+        pop_unique(consumer, out);
+        check(producer.push(std::make_unique<int>(42)), "push failed");
+        check(out == 42, "move-only value");
+    }
+    printf("Test 5 (Move-Only Values): PASSED\n");
+
+    printf("Basic tests finished successfully.\n");
+}
+
+struct stress_ctx {
+    async_u32                            q{ASYNC_TOTAL};
+    std::unique_ptr<std::atomic<bool>[]> seen = std::make_unique<std::atomic<bool>[]>(ASYNC_TOTAL_ITEMS);
+    std::atomic<uint32_t>                received{0};
+    std::atomic<int>                     finished{0};
+};
+
+// Pops until STOP, checking per-producer order. With an executor the
+// coroutine is resumed on the executor's thread, otherwise on whichever
+// producer served it.
+template <class E>
+task
+consume(stress_ctx &ctx, async_u32::handle h, E *exec) {
+    uint32_t last_seen[ASYNC_PRODUCERS];
+    for (auto &l : last_seen) {
+        l = UINT32_MAX;
+    }
+    while (true) {
+        uint32_t const v = exec != nullptr ? co_await h.pop(*exec) : co_await h.pop();
+        if (v == STOP) {
+            break;
+        }
+        check(v < ASYNC_TOTAL_ITEMS, "invalid item");
+        uint32_t const producer = v / ITEMS_PER_PRODUCER;
+        check(last_seen[producer] == UINT32_MAX || v > last_seen[producer], "per-producer order");
+        last_seen[producer] = v;
+        check(!ctx.seen[v].exchange(true, std::memory_order_acq_rel), "item dequeued twice");
+        ctx.received.fetch_add(1, std::memory_order_relaxed);
+    }
+    ctx.finished.fetch_add(1, std::memory_order_release);
+    ctx.finished.notify_all();
+}
+
+template <bool UseExecutor>
+void
+run_stress_test(char const *name) {
+    printf("\n--- Starting Coroutine Pop Stress Test (%s) ---\n", name);
+    printf("Producers: %d, Consumers: %d\n", ASYNC_PRODUCERS, ASYNC_CONSUMERS);
+
+    stress_ctx               ctx;
+    thread_executor          execs[ASYNC_CONSUMERS];
+    std::vector<std::thread> threads;
+    for (int c = 0; c < ASYNC_CONSUMERS; c++) {
+        if constexpr (UseExecutor) {
+            threads.emplace_back([&, c, h = ctx.q.get_handle()]() mutable {
+                consume(ctx, std::move(h), &execs[c]);
+                execs[c].run();
+            });
+        } else {
+            consume<thread_executor>(ctx, ctx.q.get_handle(), nullptr);
+        }
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < ASYNC_PRODUCERS; p++) {
+        producers.emplace_back([&, p, h = ctx.q.get_handle()]() mutable {
+            for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; i++) {
+                check(h.push(uint32_t(p) * ITEMS_PER_PRODUCER + i), "push failed");
+                if (i % 4096 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+
+    {
+        auto h = ctx.q.get_handle();
+        for (int c = 0; c < ASYNC_CONSUMERS; c++) {
+            check(h.push(STOP), "push failed");
+        }
+    }
+    for (int f = ctx.finished.load(std::memory_order_acquire); f < ASYNC_CONSUMERS;
+         f = ctx.finished.load(std::memory_order_acquire)) {
+        ctx.finished.wait(f, std::memory_order_acquire);
+    }
+    for (int c = 0; c < ASYNC_CONSUMERS; c++) {
+        execs[c].done.store(true, std::memory_order_release);
+        execs[c].schedule(std::noop_coroutine());
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    check(ctx.received.load() == ASYNC_TOTAL_ITEMS, "items lost");
+    for (uint32_t i = 0; i < ASYNC_TOTAL_ITEMS; i++) {
+        check(ctx.seen[i].load(std::memory_order_relaxed), "item never dequeued");
+    }
+    printf("ASYNC SUCCESS: Exactly-once and per-producer order verified.\n");
+}
+
+int
+main() {
+    run_basic_tests();
+    run_stress_test<false>("resumed by producers");
+    run_stress_test<true>("resumed on executors");
+
+    printf("\nAll coroutine pop tests completed successfully.\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,551 @@
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#include "bench_common.h"
+#include "faaq.h"
+#include "hp.h"
+
+// Runs the same producer/consumer workload against FAAQ and a set of simpler
+// queues, so that FAAQ's numbers can be read against the alternatives. Every
+// queue is an engine (bench_engine_t): a table entry with create, enqueue,
+// dequeue and destroy functions. Adding a queue means writing those four and
+// listing them in ENGINES.
+
+// --- FAA Array Queue ---
+
+static void *
+faaq_create(int producers, int max_threads) {
+    (void) producers;
+    return faa_queue_create(max_threads);
+}
+
+static bool
+faaq_enqueue(void *q, void *item, int tid) {
+    return faa_queue_enqueue(q, item, tid);
+}
+
+static void *
+faaq_dequeue(void *q, int tid) {
+    return faa_queue_dequeue(q, tid);
+}
+
+static void
+faaq_destroy(void *q) {
+    faa_queue_destroy(q);
+}
+
+// --- Mutex Queue ---
+//
+// A growable ring buffer under one mutex, the usual "deque plus lock".
+
+typedef struct {
+    mtx_t  lock;
+    void **items;
+    size_t capacity; // Power of two.
+    size_t head;
+    size_t count;
+} mutex_queue_t;
+
+static void *
+mutex_create(int producers, int max_threads) {
+    (void) producers;
+    (void) max_threads;
+    mutex_queue_t *q = calloc(1, sizeof(mutex_queue_t));
+    if (!q) {
+        return nullptr;
+    }
+    q->capacity = 1024;
+    q->items    = malloc(q->capacity * sizeof(void *));
+    if (!q->items || mtx_init(&q->lock, mtx_plain) != thrd_success) {
+        free(q->items);
+        free(q);
+        return nullptr;
+    }
+    return q;
+}
+
+static bool
+mutex_enqueue(void *queue, void *item, int tid) {
+    (void) tid;
+    mutex_queue_t *q = queue;
+    mtx_lock(&q->lock);
+    if (q->count == q->capacity) {
+        // Unroll the ring into a buffer twice the size.
+        void **grown = malloc(2 * q->capacity * sizeof(void *));
+        if (!grown) {
+            mtx_unlock(&q->lock);
+            return false;
+        }
+        for (size_t i = 0; i < q->count; i++) {
+            grown[i] = q->items[(q->head + i) & (q->capacity - 1)];
+        }
+        free(q->items);
+        q->items     = grown;
+        q->capacity *= 2;
+        q->head      = 0;
+    }
+    q->items[(q->head + q->count) & (q->capacity - 1)] = item;
+    q->count++;
+    mtx_unlock(&q->lock);
+    return true;
+}
+
+static void *
+mutex_dequeue(void *queue, int tid) {
+    (void) tid;
+    mutex_queue_t *q    = queue;
+    void          *item = nullptr;
+    mtx_lock(&q->lock);
+    if (q->count > 0) {
+        item    = q->items[q->head];
+        q->head = (q->head + 1) & (q->capacity - 1);
+        q->count--;
+    }
+    mtx_unlock(&q->lock);
+    return item;
+}
+
+static void
+mutex_destroy(void *queue) {
+    mutex_queue_t *q = queue;
+    mtx_destroy(&q->lock);
+    free(q->items);
+    free(q);
+}
+
+// --- Vyukov Bounded Ring ---
+//
+// Dmitry Vyukov's bounded MPMC queue: each cell carries a sequence number
+// that tells producers and consumers whose turn it is, so an operation is
+// one CAS on a position counter plus a release store on the cell.
+
+static constexpr size_t RING_CAPACITY = (size_t) 1 << 16;
+
+typedef struct {
+    _Atomic(size_t) seq;
+    void           *item;
+} ring_cell_t;
+
+typedef struct {
+    ring_cell_t *cells;
+    size_t       mask;
+    alignas(128) _Atomic(size_t) enq_pos;
+    alignas(128) _Atomic(size_t) deq_pos;
+} ring_queue_t;
+
+static void *
+ring_create(int producers, int max_threads) {
+    (void) producers;
+    (void) max_threads;
+    ring_queue_t *q = aligned_alloc(128, sizeof(ring_queue_t));
+    if (!q) {
+        return nullptr;
+    }
+    q->cells = aligned_alloc(128, RING_CAPACITY * sizeof(ring_cell_t));
+    if (!q->cells) {
+        free(q);
+        return nullptr;
+    }
+    q->mask = RING_CAPACITY - 1;
+    for (size_t i = 0; i < RING_CAPACITY; i++) {
+        atomic_init(&q->cells[i].seq, i);
+    }
+    atomic_init(&q->enq_pos, 0);
+    atomic_init(&q->deq_pos, 0);
+    return q;
+}
+
+static bool
+ring_enqueue(void *queue, void *item, int tid) {
+    (void) tid;
+    ring_queue_t *q   = queue;
+    size_t        pos = atomic_load_explicit(&q->enq_pos, memory_order_relaxed);
+    ring_cell_t  *cell;
+    while (true) {
+        cell                = &q->cells[pos & q->mask];
+        size_t const   seq  = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t const diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &q->enq_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed
+                )) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&q->enq_pos, memory_order_relaxed);
+        }
+    }
+    cell->item = item;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+static void *
+ring_dequeue(void *queue, int tid) {
+    (void) tid;
+    ring_queue_t *q   = queue;
+    size_t        pos = atomic_load_explicit(&q->deq_pos, memory_order_relaxed);
+    ring_cell_t  *cell;
+    while (true) {
+        cell                = &q->cells[pos & q->mask];
+        size_t const   seq  = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t const diff = (intptr_t) seq - (intptr_t) (pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &q->deq_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed
+                )) {
+                break;
+            }
+        } else if (diff < 0) {
+            return nullptr;
+        } else {
+            pos = atomic_load_explicit(&q->deq_pos, memory_order_relaxed);
+        }
+    }
+    void *item = cell->item;
+    atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+    return item;
+}
+
+static void
+ring_destroy(void *queue) {
+    ring_queue_t *q = queue;
+    free(q->cells);
+    free(q);
+}
+
+// --- Michael-Scott Queue ---
+//
+// The classic lock-free linked queue, one node per item, reclaimed with the
+// same hazard pointers FAAQ uses. Dequeue needs two hazards: the head and
+// its successor, whose item is read.
+
+typedef struct ms_node {
+    hazptr_obj_t hp_base; // Must be the first member.
+    _Atomic(struct ms_node *) next;
+    void *item;
+} ms_node_t;
+
+typedef struct {
+    alignas(128) _Atomic(ms_node_t *) head;
+    alignas(128) _Atomic(ms_node_t *) tail;
+    hazptr_holder_t *holders; // Two per thread.
+    int              max_threads;
+} ms_queue_t;
+
+static ms_node_t *
+ms_node_create(void *item) {
+    ms_node_t *node = malloc(sizeof(ms_node_t));
+    if (node) {
+        node->hp_base = (hazptr_obj_t) {};
+        node->item    = item;
+        atomic_init(&node->next, nullptr);
+    }
+    return node;
+}
+
+static void
+ms_node_reclaim(hazptr_obj_t *obj) {
+    free(obj);
+}
+
+static void *
+ms_create(int producers, int max_threads) {
+    (void) producers;
+    ms_queue_t *q = aligned_alloc(128, sizeof(ms_queue_t));
+    if (!q) {
+        return nullptr;
+    }
+    ms_node_t *sentinel = ms_node_create(nullptr);
+    q->holders          = calloc(2 * (size_t) max_threads, sizeof(hazptr_holder_t));
+    if (!sentinel || !q->holders) {
+        free(sentinel);
+        free(q->holders);
+        free(q);
+        return nullptr;
+    }
+    for (int i = 0; i < 2 * max_threads; i++) {
+        hazptr_holder_init(&q->holders[i]);
+    }
+    q->max_threads = max_threads;
+    atomic_init(&q->head, sentinel);
+    atomic_init(&q->tail, sentinel);
+    return q;
+}
+
+static bool
+ms_enqueue(void *queue, void *item, int tid) {
+    ms_queue_t      *q    = queue;
+    hazptr_holder_t *h    = &q->holders[2 * tid];
+    ms_node_t       *node = ms_node_create(item);
+    if (!node) {
+        return false;
+    }
+    while (true) {
+        ms_node_t *tail;
+        HAZPTR_PROTECT(tail, h, &q->tail);
+        ms_node_t *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+        if (next == nullptr) {
+            if (atomic_compare_exchange_strong_explicit(
+                    &tail->next, &next, node, memory_order_release, memory_order_relaxed
+                )) {
+                atomic_compare_exchange_strong_explicit(
+                    &q->tail, &tail, node, memory_order_release, memory_order_relaxed
+                );
+                break;
+            }
+        } else {
+            // Help a producer that linked its node but has not swung the tail.
+            atomic_compare_exchange_strong_explicit(&q->tail, &tail, next, memory_order_release, memory_order_relaxed);
+        }
+    }
+    hazptr_reset(h, nullptr);
+    return true;
+}
+
+static void *
+ms_dequeue(void *queue, int tid) {
+    ms_queue_t      *q      = queue;
+    hazptr_holder_t *h_head = &q->holders[2 * tid];
+    hazptr_holder_t *h_next = &q->holders[2 * tid + 1];
+    void            *item   = nullptr;
+    while (true) {
+        ms_node_t *head, *next;
+        HAZPTR_PROTECT(head, h_head, &q->head);
+        HAZPTR_PROTECT(next, h_next, &head->next);
+        // 'next' is only safe to read while 'head' is still the head.
+        if (head != atomic_load_explicit(&q->head, memory_order_acquire)) {
+            continue;
+        }
+        if (next == nullptr) {
+            break;
+        }
+        ms_node_t *tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head == tail) {
+            atomic_compare_exchange_strong_explicit(&q->tail, &tail, next, memory_order_release, memory_order_relaxed);
+            continue;
+        }
+        item = next->item;
+        if (atomic_compare_exchange_strong_explicit(&q->head, &head, next, memory_order_acq_rel, memory_order_relaxed)) {
+            hazptr_reset(h_head, nullptr);
+            hazptr_retire(&head->hp_base, ms_node_reclaim);
+            break;
+        }
+        item = nullptr;
+    }
+    hazptr_reset(h_head, nullptr);
+    hazptr_reset(h_next, nullptr);
+    return item;
+}
+
+static void
+ms_destroy(void *queue) {
+    ms_queue_t *q    = queue;
+    ms_node_t  *node = atomic_load_explicit(&q->head, memory_order_relaxed);
+    while (node) {
+        ms_node_t *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+        free(node);
+        node = next;
+    }
+    for (int i = 0; i < 2 * q->max_threads; i++) {
+        hazptr_holder_destroy(&q->holders[i]);
+    }
+    free(q->holders);
+    free(q);
+    hazptr_cleanup();
+}
+
+static bench_engine_t const ENGINES[] = {
+    {"faaq",  faaq_create,  faaq_enqueue,  faaq_dequeue,  faaq_destroy },
+    {"mutex", mutex_create, mutex_enqueue, mutex_dequeue, mutex_destroy},
+    {"ring",  ring_create,  ring_enqueue,  ring_dequeue,  ring_destroy },
+    {"ms",    ms_create,    ms_enqueue,    ms_dequeue,    ms_destroy   },
+};
+
+// --- Workload ---
+//
+// 'threads' producers and as many consumers move 'items' items. Every
+// LATENCY_SAMPLE_PERIOD-th operation of each thread is timed into that
+// thread's histogram.
+
+static constexpr int    LATENCY_SAMPLE_PERIOD = 16;
+
+static int              g_cpus[CPU_SETSIZE];
+static int              g_num_cpus = 1;
+static bench_affinity_t g_affinity = BENCH_AFFINITY_COMPACT;
+
+// --- Command Line ---
+
+static void
+usage(FILE *out, char const *prog) {
+    fprintf(
+        out,
+        "Usage: %s [options]\n"
+        "  -t, --threads=N         Largest producer (and consumer) count; swept 1, 2, 4, ... N\n"
+        "                          (default: online CPUs / 2, at least 1)\n"
+        "  -n, --items=N           Items per run (default 4000000)\n"
+        "  -a, --affinity=POLICY   compact, scatter or none (default compact)\n"
+        "  -e, --engines=LIST      Comma-separated engines, or 'all' (default)\n"
+        "  -f, --format=FORMAT     text or csv (default text)\n"
+        "  -h, --help              Show this help\n"
+        "Engines:",
+        prog
+    );
+    for (size_t i = 0; i < sizeof(ENGINES) / sizeof(ENGINES[0]); ++i) {
+        fprintf(out, " %s", ENGINES[i].name);
+    }
+    fprintf(out, "\n");
+}
+
+static bool
+engine_selected(char const *list, char const *name) {
+    if (strcmp(list, "all") == 0) {
+        return true;
+    }
+    size_t const len = strlen(name);
+    for (char const *p = list; *p != '\0';) {
+        size_t const n = strcspn(p, ",");
+        if (n == len && strncmp(p, name, n) == 0) {
+            return true;
+        }
+        p += n + (p[n] == ',');
+    }
+    return false;
+}
+
+int
+main(int argc, char **argv) {
+    static struct option const long_options[] = {
+        {"threads",  required_argument, nullptr, 't'},
+        {"items",    required_argument, nullptr, 'n'},
+        {"affinity", required_argument, nullptr, 'a'},
+        {"engines",  required_argument, nullptr, 'e'},
+        {"format",   required_argument, nullptr, 'f'},
+        {"help",     no_argument,       nullptr, 'h'},
+        {nullptr,    0,                 nullptr, 0  },
+    };
+
+    int         max_threads = bench_online_cpus() > 1 ? bench_online_cpus() / 2 : 1;
+    uint64_t    items       = 4000000;
+    char const *engines     = "all";
+    bool        csv         = false;
+    int         opt;
+    while ((opt = getopt_long(argc, argv, "t:n:a:e:f:h", long_options, nullptr)) != -1) {
+        bool ok = true;
+        switch (opt) {
+        case 't':
+            max_threads = atoi(optarg);
+            ok          = max_threads > 0;
+            break;
+        case 'n':
+            items = strtoull(optarg, nullptr, 10);
+            ok    = items > 0;
+            break;
+        case 'a':
+            ok = bench_parse_affinity(optarg, &g_affinity);
+            break;
+        case 'e':
+            engines = optarg;
+            break;
+        case 'f':
+            csv = strcmp(optarg, "csv") == 0;
+            ok  = csv || strcmp(optarg, "text") == 0;
+            break;
+        case 'h':
+            usage(stdout, argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            usage(stderr, argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (!ok) {
+            fprintf(stderr, "%s: invalid argument '%s' for -%c\n", argv[0], optarg, opt);
+            return EXIT_FAILURE;
+        }
+    }
+    g_num_cpus = bench_cpu_order(g_affinity, g_cpus, CPU_SETSIZE);
+
+    if (csv) {
+        printf("engine,producers,consumers,items,ns,mitems_per_s,enq_p50,enq_p99,enq_p999,deq_p50,deq_p99,deq_p999\n");
+    } else {
+        printf("--- Baseline Comparison (Items: %w64u, Affinity: %s) ---\n", items, bench_affinity_name(g_affinity));
+        printf("Latency in cycles, sampled every %d operations per thread.\n", LATENCY_SAMPLE_PERIOD);
+        printf(
+            "%-8s %8s %10s %10s %10s %10s %10s %10s %10s\n",
+            "Engine",
+            "Threads",
+            "Mitems/s",
+            "Enq p50",
+            "Enq p99",
+            "Enq p99.9",
+            "Deq p50",
+            "Deq p99",
+            "Deq p99.9"
+        );
+    }
+
+    for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        for (size_t e = 0; e < sizeof(ENGINES) / sizeof(ENGINES[0]); ++e) {
+            if (!engine_selected(engines, ENGINES[e].name)) {
+                continue;
+            }
+            bench_workload_t const workload = {
+                .producers      = threads,
+                .consumers      = threads,
+                .items          = items,
+                .cpus           = g_affinity != BENCH_AFFINITY_NONE ? g_cpus : nullptr,
+                .num_cpus       = g_num_cpus,
+                .latency_period = LATENCY_SAMPLE_PERIOD,
+            };
+            bench_workload_result_t *r = bench_alloc(1, sizeof(bench_workload_result_t));
+            bench_run_workload(&ENGINES[e], &workload, r);
+            double const rate = (double) r->total_items * 1e3 / (double) r->ns;
+            if (csv) {
+                printf(
+                    "%s,%d,%d,%w64u,%w64u,%.3f,%w64u,%w64u,%w64u,%w64u,%w64u,%w64u\n",
+                    ENGINES[e].name,
+                    threads,
+                    threads,
+                    r->total_items,
+                    r->ns,
+                    rate,
+                    bench_hist_quantile(&r->enqueue, 0.50),
+                    bench_hist_quantile(&r->enqueue, 0.99),
+                    bench_hist_quantile(&r->enqueue, 0.999),
+                    bench_hist_quantile(&r->dequeue, 0.50),
+                    bench_hist_quantile(&r->dequeue, 0.99),
+                    bench_hist_quantile(&r->dequeue, 0.999)
+                );
+            } else {
+                printf(
+                    "%-8s %4d+%-3d %10.2f %10w64u %10w64u %10w64u %10w64u %10w64u %10w64u\n",
+                    ENGINES[e].name,
+                    threads,
+                    threads,
+                    rate,
+                    bench_hist_quantile(&r->enqueue, 0.50),
+                    bench_hist_quantile(&r->enqueue, 0.99),
+                    bench_hist_quantile(&r->enqueue, 0.999),
+                    bench_hist_quantile(&r->dequeue, 0.50),
+                    bench_hist_quantile(&r->dequeue, 0.99),
+                    bench_hist_quantile(&r->dequeue, 0.999)
+                );
+            }
+            fflush(stdout);
+            free(r);
+        }
+        if (threads == max_threads) {
+            break;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,87 +1,102 @@
 #define _GNU_SOURCE
 #include <assert.h>
+#include <getopt.h>
+#include <math.h>
 #include <sched.h>
 #include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <threads.h>
 #include <unistd.h>
 
+#include "bench_common.h"
 #include "faaq.h"
+#include "faaq_inline.h"
 
-static constexpr int      NUM_PRODUCERS      = 8;
-static constexpr int      NUM_CONSUMERS      = 8;
-static constexpr uint64_t TOTAL_ITEMS        = 20000000;
-
-static constexpr int      TOTAL_THREADS      = NUM_PRODUCERS + NUM_CONSUMERS;
-static constexpr uint64_t ITEMS_PER_PRODUCER = TOTAL_ITEMS / NUM_PRODUCERS;
-
-#define USE_AFFINITY 1
-
-#if defined(__x86_64__) || defined(_M_X64)
-#include <x86intrin.h>
-#endif
-inline static uint64_t
-rdtsc_serialized(void) {
-#if defined(__x86_64__) || defined(_M_X64)
-    unsigned int aux;
-    return __rdtscp(&aux);
-#elif defined(__aarch64__) || defined(_M_ARM64)
-    uint64_t val;
-    __asm__ volatile("dmb ish" : : : "memory");
-    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(val));
-    return val;
-#else
-#warning "Serialized RDTSC benchmarking not supported on this architecture."
-    return 0;
-#endif
-}
+// --- Options ---
+
+typedef enum {
+    FORMAT_TEXT,
+    FORMAT_CSV,
+    FORMAT_JSON,
+} output_format_t;
+
+// A thread-count sweep: lo, then either lo + step, ... or (step == 0)
+// lo * 2, lo * 4, ..., always ending with hi.
+typedef struct {
+    int lo;
+    int hi;
+    int step;
+} sweep_t;
 
-#define RDTSC() rdtsc_serialized()
+typedef struct {
+    sweep_t          producers;
+    sweep_t          consumers;
+    uint64_t         items;
+    bench_affinity_t affinity;
+    uint64_t         warmup_ms;
+    output_format_t  format;
+    char const      *sections;
+    // Repeated throughput trials; see 'trials_mode'.
+    int              trials;
+    int              discard;
+    char const      *baseline;
+    char const      *save_baseline;
+    double           threshold_pct;
+    // Per-thread counter groups around the throughput loops.
+    bool             counters;
+    uint64_t         hitm_event;
+    // Comma-separated payload sizes in bytes.
+    char const      *payload_sizes;
+    // Chance of a sched_yield per enqueue in the injected oversubscription runs.
+    double           yield_prob;
+    // Bursty load for the footprint section.
+    uint64_t         burst_items;
+    uint64_t         burst_on_ms;
+    uint64_t         burst_off_ms;
+    int              bursts;
+    uint64_t         sample_ms;
+} bench_options_t;
 
-static FAAArrayQueue_t *g_queue                           = nullptr;
-alignas(128) static atomic_uint_fast64_t g_dequeued_count = 0;
+static bench_options_t g_options = {
+    .producers     = {8, 8, 0},
+    .consumers     = {8, 8, 0},
+    .items         = 20000000,
+    .affinity      = BENCH_AFFINITY_COMPACT,
+    .warmup_ms     = 200,
+    .format        = FORMAT_TEXT,
+    .sections      = "all",
+    .trials        = 1,
+    .discard       = 1,
+    .threshold_pct = 2.0,
+    .payload_sizes = "0,16,64,256,1024,4096",
+    .yield_prob    = 0.001,
+    .burst_items   = 1000000,
+    .burst_on_ms   = 100,
+    .burst_off_ms  = 300,
+    .bursts        = 3,
+    .sample_ms     = 10,
+};
 
-static uint64_t             g_start_cycles                = 0;
-static atomic_uint_fast64_t g_end_cycles                  = 0;
+// Placement order for the selected affinity policy; thread 'tid' runs on
+// g_cpus[tid % g_num_cpus].
+static int             g_cpus[CPU_SETSIZE];
+static int             g_num_cpus = 1;
 
-static mtx_t                g_barrier_mutex;
-static cnd_t                g_barrier_cond;
-static int                  g_barrier_count  = 0;
-static int                  g_barrier_target = 0;
+static bench_barrier_t g_barrier;
 
 void
 barrier_wait() {
-    mtx_lock(&g_barrier_mutex);
-    g_barrier_count++;
-    if (g_barrier_count == g_barrier_target) {
-        cnd_broadcast(&g_barrier_cond);
-    } else {
-        cnd_wait(&g_barrier_cond, &g_barrier_mutex);
-    }
-    mtx_unlock(&g_barrier_mutex);
+    bench_barrier_wait(&g_barrier);
 }
 
 void
 set_affinity(int tid) {
-#if USE_AFFINITY
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    // sysconf is a non-standard POSIX function
-    int num_cores = sysconf(_SC_NPROCESSORS_ONLN);
-    if (num_cores <= 0) {
-        return;
-    }
-
-    int core_id = tid % num_cores;
-    CPU_SET(core_id, &cpuset);
-
-    // sched_setaffinity is a non-standard POSIX function
-    if (sched_setaffinity(0, sizeof(cpu_set_t), &cpuset) != 0) {
-        // Not fatal, but might affect results stability
+    if (g_options.affinity != BENCH_AFFINITY_NONE) {
+        bench_pin_cpu(g_cpus[tid % g_num_cpus]);
     }
-#endif
 }
 
 __attribute__((noinline)) uint64_t
@@ -90,144 +105,2443 @@ black_box(uint64_t dummy) {
     return ret;
 }
 
-int
-producer_func(void *arg) {
-    int tid = (int) (uintptr_t) arg;
-    set_affinity(tid);
+// --- Counters ---
+//
+// With --counters every throughput thread opens its own counter group before
+// the start barrier and counts only its measured loop.
 
-    barrier_wait();
+static void
+counters_open(bench_counter_group_t *g) {
+    if (g_options.counters) {
+        bench_counter_group_open(g, g_options.hitm_event);
+    }
+}
+
+static void
+counters_start(bench_counter_group_t *g) {
+    if (g_options.counters) {
+        bench_counter_group_start(g);
+    }
+}
+
+static void
+counters_finish(bench_counter_group_t *g, bench_counters_t *out) {
+    if (g_options.counters) {
+        bench_counter_group_stop(g, out);
+        bench_counter_group_close(g);
+    }
+}
+
+// --- Throughput Sweep ---
+//
+// Producers enqueue as fast as they can and consumers drain concurrently.
+// Consumers count into their own cache line and stop once every producer is
+// done and the queue is empty, so the measured loop shares nothing but the
+// queue itself.
+
+typedef struct {
+    alignas(128) uint64_t items;
+    uint64_t end_cycles; // When this consumer found the queue drained.
+} consumer_slot_t;
+
+typedef struct {
+    FAAArrayQueue_t *queue;
+    int              producers;
+    uint64_t         items_per_producer;
+    consumer_slot_t *consumers;
+    alignas(128) atomic_int producers_done;
+} throughput_ctx_t;
+
+typedef struct {
+    throughput_ctx_t *ctx;
+    int               tid;
+    bench_counters_t  counters;
+} throughput_arg_t;
 
-    void *payload = (void *) (uintptr_t) 1;
+typedef struct {
+    int              producers;
+    int              consumers;
+    uint64_t         total_items;
+    uint64_t         cycles;
+    uint64_t         ns;
+    FAAQueueStats_t  stats;
+    uint64_t        *consumer_items;
+    bench_counters_t counters; // Summed over all threads.
+} throughput_result_t;
 
-    if (payload == g_queue->taken_sentinel) {
+int
+throughput_producer(void *arg) {
+    throughput_arg_t     *a        = arg;
+    throughput_ctx_t     *ctx      = a->ctx;
+    void                 *payload  = (void *) (uintptr_t) 1;
+    bench_counter_group_t counters = {};
+    if (payload == ctx->queue->taken_sentinel) {
         payload = (void *) (uintptr_t) 2;
     }
+    set_affinity(a->tid);
+    counters_open(&counters);
 
-    for (uint64_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
-        faa_queue_enqueue(g_queue, payload, tid);
+    barrier_wait();
+    counters_start(&counters);
+    for (uint64_t i = 0; i < ctx->items_per_producer; ++i) {
+        faa_queue_enqueue(ctx->queue, payload, a->tid);
     }
-
+    atomic_fetch_add_explicit(&ctx->producers_done, 1, memory_order_release);
+    counters_finish(&counters, &a->counters);
     return 0;
 }
 
 int
-consumer_func(void *arg) {
-    int tid = (int) (uintptr_t) arg;
-    set_affinity(tid);
+throughput_consumer(void *arg) {
+    throughput_arg_t     *a        = arg;
+    throughput_ctx_t     *ctx      = a->ctx;
+    consumer_slot_t      *slot     = &ctx->consumers[a->tid - ctx->producers];
+    uint64_t              items    = 0;
+    bench_counter_group_t counters = {};
+    set_affinity(a->tid);
+    counters_open(&counters);
 
     barrier_wait();
-
+    counters_start(&counters);
     while (true) {
-        void *item = faa_queue_dequeue(g_queue, tid);
-
-        if (item != nullptr) {
-            uint64_t prev_count = atomic_fetch_add_explicit(&g_dequeued_count, 1, memory_order_seq_cst);
-
-            if (prev_count + 1 == TOTAL_ITEMS) {
-                uint64_t cycles = RDTSC();
-                atomic_store_explicit(&g_end_cycles, cycles, memory_order_seq_cst);
-                break;
-            }
+        // Once every producer has finished, an empty queue stays empty.
+        bool const finished = atomic_load_explicit(&ctx->producers_done, memory_order_acquire) == ctx->producers;
+        if (faa_queue_dequeue(ctx->queue, a->tid) != nullptr) {
+            items++;
+        } else if (finished) {
+            break;
         } else {
-            if (atomic_load_explicit(&g_dequeued_count, memory_order_seq_cst) >= TOTAL_ITEMS) {
-                break;
-            }
             thrd_yield();
         }
     }
-
+    slot->end_cycles = RDTSC();
+    slot->items      = items;
+    counters_finish(&counters, &a->counters);
     return 0;
 }
 
 void
-run_benchmark() {
-    printf("--- FAA Array Queue Throughput Benchmark ---\n");
-    printf("Producers: %d, Consumers: %d\n", NUM_PRODUCERS, NUM_CONSUMERS);
-    printf("Total Items: %w64u\n", TOTAL_ITEMS);
-    printf("FAA Buffer Size: %zu\n", FAA_BUFFER_SIZE);
-    printf("CPU Affinity: %s\n", USE_AFFINITY ? "Enabled" : "Disabled");
-
-    g_barrier_target = TOTAL_THREADS + 1;
-    g_barrier_count  = 0;
-    if (mtx_init(&g_barrier_mutex, mtx_plain) != thrd_success || cnd_init(&g_barrier_cond) != thrd_success) {
-        fprintf(stderr, "Failed to initialize mutex/condvar.\n");
+run_throughput(int producers, int consumers, uint64_t items, throughput_result_t *result) {
+    int const         threads_n = producers + consumers;
+    throughput_arg_t *args      = bench_alloc(threads_n, sizeof(throughput_arg_t));
+    throughput_ctx_t *ctx       = bench_alloc(1, sizeof(throughput_ctx_t));
+    consumer_slot_t  *slots     = bench_alloc(consumers, sizeof(consumer_slot_t));
+
+    ctx->queue = faa_queue_create(threads_n);
+    if (!ctx->queue) {
+        fprintf(stderr, "Failed to create FAA Array Queue.\n");
         exit(EXIT_FAILURE);
     }
+    ctx->producers          = producers;
+    ctx->items_per_producer = items / producers;
+    ctx->consumers          = slots;
+    atomic_init(&ctx->producers_done, 0);
 
-    g_queue = faa_queue_create(TOTAL_THREADS);
-    if (!g_queue) {
-        fprintf(stderr, "Failed to create FAA Array Queue.\n");
+    for (int tid = 0; tid < threads_n; ++tid) {
+        args[tid] = (throughput_arg_t) { .ctx = ctx, .tid = tid };
+    }
+    bench_threads_t threads;
+    bench_threads_start(
+        &threads, &g_barrier, producers, throughput_producer, consumers, throughput_consumer, args, sizeof(args[0])
+    );
+
+    barrier_wait();
+    uint64_t const start_ns     = bench_now_ns();
+    uint64_t const start_cycles = RDTSC();
+    bench_threads_join(&threads);
+    uint64_t const join_ns = bench_now_ns();
+
+    // The run ends when the last consumer sees the queue drained, not when
+    // the slowest thread has exited.
+    uint64_t end_cycles = start_cycles;
+    uint64_t dequeued   = 0;
+    result->consumer_items = bench_alloc(consumers, sizeof(uint64_t));
+    for (int c = 0; c < consumers; ++c) {
+        result->consumer_items[c]  = slots[c].items;
+        dequeued                  += slots[c].items;
+        if (slots[c].end_cycles > end_cycles) {
+            end_cycles = slots[c].end_cycles;
+        }
+    }
+
+    result->producers   = producers;
+    result->consumers   = consumers;
+    result->total_items = ctx->items_per_producer * producers;
+    result->cycles      = end_cycles - start_cycles;
+    result->ns          = join_ns - start_ns;
+    if (dequeued != result->total_items) {
+        fprintf(stderr, "Error: Count mismatch (%w64u of %w64u items).\n", dequeued, result->total_items);
+        exit(EXIT_FAILURE);
+    }
+    faa_queue_stats(ctx->queue, &result->stats);
+    result->counters = (bench_counters_t) {0};
+    for (int tid = 0; tid < threads_n; ++tid) {
+        bench_counters_add(&result->counters, &args[tid].counters);
+    }
+
+    faa_queue_destroy(ctx->queue);
+    free(slots);
+    free(ctx);
+    free(args);
+}
+
+static bool trials_mode(void);
+static void print_trials_header(void);
+
+static void
+print_throughput_header(void) {
+    if (trials_mode()) {
+        print_trials_header();
+        return;
+    }
+    switch (g_options.format) {
+    case FORMAT_TEXT:
+        printf("--- FAA Array Queue Throughput Benchmark ---\n");
+        printf(
+            "Items: %w64u, FAA Buffer Size: %zu, Affinity: %s\n",
+            g_options.items,
+            FAA_BUFFER_SIZE,
+            bench_affinity_name(g_options.affinity)
+        );
+        printf(
+            "%10s %10s %14s %14s %14s %12s %14s\n",
+            "Producers",
+            "Consumers",
+            "Total cycles",
+            "Cycles/op",
+            "Cycles/pair",
+            "Mitems/s",
+            "Consumer skew"
+        );
+        break;
+    case FORMAT_CSV:
+        printf(
+            "producers,consumers,items,affinity,total_cycles,cycles_per_op,cycles_per_pair,ns,mitems_per_s,"
+            "nodes_allocated,burned_slots,min_consumer_items,max_consumer_items%s\n",
+            g_options.counters ? ",instructions_per_op,cache_misses_per_op,branch_misses_per_op,hitm_per_op,"
+                                 "cpu_ms,voluntary_switches,involuntary_switches,minor_faults"
+                               : ""
+        );
+        break;
+    case FORMAT_JSON:
+        printf("[");
+        break;
+    }
+}
+
+// Machine-readable names of the hardware counters, normalized per op.
+static char const *const COUNTER_KEYS[BENCH_HW_COUNTERS] = {
+    "instructions_per_op",
+    "cache_misses_per_op",
+    "branch_misses_per_op",
+    "hitm_per_op",
+};
+
+// Formats hardware counter 'i' per operation, or 'missing' if it was not
+// counted.
+static char const *
+per_op(char *buf, size_t size, bench_counters_t const *c, int i, uint64_t ops, char const *missing) {
+    if (c->hw[i] == BENCH_EVENT_UNAVAILABLE) {
+        return missing;
+    }
+    snprintf(buf, size, "%.3f", (double) c->hw[i] / (double) ops);
+    return buf;
+}
+
+static void
+print_counters(throughput_result_t const *r) {
+    static bool    warned = false;
+    uint64_t const ops    = r->total_items * 2;
+    char           buf[BENCH_HW_COUNTERS][32];
+    if (r->counters.hw[BENCH_HW_INSTRUCTIONS] == BENCH_EVENT_UNAVAILABLE && !warned) {
+        fprintf(stderr, "Hardware counters unavailable; reporting software counters only.\n");
+        warned = true;
+    }
+
+    switch (g_options.format) {
+    case FORMAT_TEXT:
+        printf("%21s", "Per op:");
+        for (int i = 0; i < BENCH_HW_COUNTERS; ++i) {
+            printf(
+                "%s %s %s",
+                i == 0 ? "" : ",",
+                BENCH_HW_COUNTER_NAMES[i],
+                per_op(buf[i], sizeof(buf[i]), &r->counters, i, ops, "n/a")
+            );
+        }
+        printf(
+            "; total: CPU %.1f ms, switches %w64u/%w64u (vol/invol), minor faults %w64u\n",
+            (double) r->counters.cpu_ns / 1e6,
+            r->counters.voluntary_switches,
+            r->counters.involuntary_switches,
+            r->counters.minor_faults
+        );
+        break;
+    case FORMAT_CSV:
+        for (int i = 0; i < BENCH_HW_COUNTERS; ++i) {
+            printf(",%s", per_op(buf[i], sizeof(buf[i]), &r->counters, i, ops, ""));
+        }
+        printf(
+            ",%.3f,%w64u,%w64u,%w64u",
+            (double) r->counters.cpu_ns / 1e6,
+            r->counters.voluntary_switches,
+            r->counters.involuntary_switches,
+            r->counters.minor_faults
+        );
+        break;
+    case FORMAT_JSON:
+        printf(", \"counters\": {");
+        for (int i = 0; i < BENCH_HW_COUNTERS; ++i) {
+            printf("\"%s\": %s, ", COUNTER_KEYS[i], per_op(buf[i], sizeof(buf[i]), &r->counters, i, ops, "null"));
+        }
+        printf(
+            "\"cpu_ms\": %.3f, \"voluntary_switches\": %w64u, \"involuntary_switches\": %w64u, "
+            "\"minor_faults\": %w64u}",
+            (double) r->counters.cpu_ns / 1e6,
+            r->counters.voluntary_switches,
+            r->counters.involuntary_switches,
+            r->counters.minor_faults
+        );
+        break;
+    }
+}
+
+static void
+print_throughput_result(throughput_result_t const *r, bool first) {
+    uint64_t min_items = UINT64_MAX, max_items = 0;
+    for (int c = 0; c < r->consumers; ++c) {
+        min_items = r->consumer_items[c] < min_items ? r->consumer_items[c] : min_items;
+        max_items = r->consumer_items[c] > max_items ? r->consumer_items[c] : max_items;
+    }
+    double const per_op   = (double) r->cycles / (double) (r->total_items * 2);
+    double const per_pair = (double) r->cycles / (double) r->total_items;
+    double const rate     = (double) r->total_items * 1e3 / (double) r->ns;
+
+    switch (g_options.format) {
+    case FORMAT_TEXT:
+        // Skew: how far the busiest consumer is above an even share.
+        printf(
+            "%10d %10d %14w64u %14.2f %14.2f %12.2f %13.1f%%\n",
+            r->producers,
+            r->consumers,
+            r->cycles,
+            per_op,
+            per_pair,
+            rate,
+            100.0 * ((double) max_items * r->consumers / (double) r->total_items - 1.0)
+        );
+        if (g_options.counters) {
+            print_counters(r);
+        }
+        break;
+    case FORMAT_CSV:
+        printf(
+            "%d,%d,%w64u,%s,%w64u,%.3f,%.3f,%w64u,%.3f,%w64u,%w64u,%w64u,%w64u",
+            r->producers,
+            r->consumers,
+            r->total_items,
+            bench_affinity_name(g_options.affinity),
+            r->cycles,
+            per_op,
+            per_pair,
+            r->ns,
+            rate,
+            r->stats.nodes_allocated,
+            r->stats.burned_slots,
+            min_items,
+            max_items
+        );
+        if (g_options.counters) {
+            print_counters(r);
+        }
+        printf("\n");
+        break;
+    case FORMAT_JSON:
+        printf(
+            "%s\n  {\"producers\": %d, \"consumers\": %d, \"items\": %w64u, \"affinity\": \"%s\", "
+            "\"total_cycles\": %w64u, \"cycles_per_op\": %.3f, \"cycles_per_pair\": %.3f, \"ns\": %w64u, "
+            "\"mitems_per_s\": %.3f, \"nodes_allocated\": %w64u, \"burned_slots\": %w64u, \"consumer_items\": [",
+            first ? "" : ",",
+            r->producers,
+            r->consumers,
+            r->total_items,
+            bench_affinity_name(g_options.affinity),
+            r->cycles,
+            per_op,
+            per_pair,
+            r->ns,
+            rate,
+            r->stats.nodes_allocated,
+            r->stats.burned_slots
+        );
+        for (int c = 0; c < r->consumers; ++c) {
+            printf("%s%w64u", c == 0 ? "" : ", ", r->consumer_items[c]);
+        }
+        printf("]");
+        if (g_options.counters) {
+            print_counters(r);
+        }
+        printf("}");
+        break;
+    }
+}
+
+// Next value of a sweep after 'value', or 0 when the sweep is done.
+static int
+sweep_next(sweep_t const *s, int value) {
+    if (value >= s->hi) {
+        return 0;
+    }
+    int const next = s->step > 0 ? value + s->step : value * 2;
+    return next < s->hi ? next : s->hi;
+}
+
+// --- Repeated Trials ---
+//
+// With --trials, --baseline or --save-baseline every configuration runs
+// 'discard' + 'trials' times. The discarded runs absorb page faults, node
+// pool growth and frequency ramp-up; the rest are summarized by their median
+// cycles per pair, the median absolute deviation and a 95% confidence
+// interval of the median.
+//
+// A baseline file keeps the raw samples, one configuration per line:
+//
+//   producers consumers items affinity n sample_1 ... sample_n
+//
+// Against a baseline, a configuration regressed when a Mann-Whitney U test
+// separates the two sample sets at the 5% level and the median moved by at
+// least --threshold percent, so run-to-run noise alone does not flag it.
+
+typedef struct {
+    int      producers;
+    int      consumers;
+    uint64_t items;
+    char     affinity[16];
+    int      n;
+    double  *samples;
+} baseline_entry_t;
+
+static baseline_entry_t *g_baseline;
+static int               g_baseline_len;
+static FILE             *g_save_baseline;
+static int               g_regressions;
+
+static bool
+trials_mode(void) {
+    return g_options.trials > 1 || g_options.baseline || g_options.save_baseline;
+}
+
+static void
+load_baseline(char const *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Failed to open baseline '%s'.\n", path);
         exit(EXIT_FAILURE);
     }
 
-    thrd_t threads[TOTAL_THREADS];
-    printf("Spawning threads...\n");
+    char   line[4096];
+    int    line_no = 0;
+    size_t cap     = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if ((size_t) g_baseline_len == cap) {
+            cap        = cap ? cap * 2 : 16;
+            g_baseline = realloc(g_baseline, cap * sizeof(baseline_entry_t));
+            if (!g_baseline) {
+                fprintf(stderr, "Failed to allocate baseline.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
 
-    for (int i = 0; i < NUM_CONSUMERS; ++i) {
-        int tid = NUM_PRODUCERS + i;
-        if (thrd_create(&threads[tid], consumer_func, (void *) (uintptr_t) tid) != thrd_success) {
-            // FIX: thrd_create does not set errno, so do not use perror.
-            fprintf(stderr, "Failed to create consumer thread %d.\n", tid);
+        baseline_entry_t *e   = &g_baseline[g_baseline_len];
+        int               pos = 0;
+        int const         got = sscanf(
+            line, "%d %d %w64u %15s %d%n", &e->producers, &e->consumers, &e->items, e->affinity, &e->n, &pos
+        );
+        if (got != 5 || e->n <= 0 || !(e->samples = calloc((size_t) e->n, sizeof(double)))) {
+            fprintf(stderr, "%s:%d: malformed baseline entry.\n", path, line_no);
             exit(EXIT_FAILURE);
         }
+        for (int i = 0; i < e->n; ++i) {
+            int consumed = 0;
+            if (sscanf(line + pos, "%lf%n", &e->samples[i], &consumed) != 1) {
+                fprintf(stderr, "%s:%d: expected %d samples.\n", path, line_no, e->n);
+                exit(EXIT_FAILURE);
+            }
+            pos += consumed;
+        }
+        g_baseline_len++;
+    }
+    fclose(f);
+}
+
+static baseline_entry_t const *
+find_baseline(int producers, int consumers) {
+    char const *affinity = bench_affinity_name(g_options.affinity);
+    for (int i = 0; i < g_baseline_len; ++i) {
+        baseline_entry_t const *e = &g_baseline[i];
+        if (e->producers == producers && e->consumers == consumers && e->items == g_options.items
+            && strcmp(e->affinity, affinity) == 0) {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+static void
+print_trials_header(void) {
+    switch (g_options.format) {
+    case FORMAT_TEXT:
+        printf("--- FAA Array Queue Throughput Trials ---\n");
+        printf(
+            "Items: %w64u, Trials: %d (+%d discarded), Affinity: %s",
+            g_options.items,
+            g_options.trials,
+            g_options.discard,
+            bench_affinity_name(g_options.affinity)
+        );
+        if (g_options.baseline) {
+            printf(", Baseline: %s, Threshold: %.1f%%", g_options.baseline, g_options.threshold_pct);
+        }
+        printf("\nCycles per pair:\n");
+        printf("%10s %10s %10s %10s %10s %10s", "Producers", "Consumers", "Median", "MAD", "CI95 low", "CI95 high");
+        if (g_options.baseline) {
+            printf(" %10s %9s %7s  %s", "Baseline", "Change", "z", "Verdict");
+        }
+        printf("\n");
+        break;
+    case FORMAT_CSV:
+        printf(
+            "producers,consumers,items,affinity,trials,median_cycles_per_pair,mad,ci_low,ci_high,"
+            "baseline_median,change_pct,z,verdict\n"
+        );
+        break;
+    case FORMAT_JSON:
+        printf("[");
+        break;
+    }
+}
+
+static void
+run_throughput_trials(int producers, int consumers, bool first) {
+    int const n       = g_options.trials;
+    double   *samples = bench_alloc((size_t) n, sizeof(double));
+    double   *scratch = bench_alloc((size_t) n, sizeof(double));
+    for (int t = -g_options.discard; t < n; ++t) {
+        throughput_result_t r;
+        run_throughput(producers, consumers, g_options.items, &r);
+        free(r.consumer_items);
+        if (t >= 0) {
+            samples[t] = (double) r.cycles / (double) r.total_items;
+        }
+    }
+
+    bench_summary_t s;
+    bench_summarize(samples, n, scratch, &s);
+
+    // Higher cycles per pair is worse, so a positive z is a slowdown.
+    baseline_entry_t const *base    = find_baseline(producers, consumers);
+    bench_summary_t         b       = {0};
+    double                  change  = 0;
+    double                  z       = 0;
+    char const             *verdict = "none";
+    if (base) {
+        double *base_scratch = bench_alloc((size_t) base->n, sizeof(double));
+        bench_summarize(base->samples, base->n, base_scratch, &b);
+        free(base_scratch);
+        change                 = 100.0 * (s.median / b.median - 1.0);
+        z                      = bench_mann_whitney_z(samples, n, base->samples, base->n);
+        bool const significant = fabs(z) > 1.96 && fabs(change) >= g_options.threshold_pct;
+        verdict                = !significant ? "unchanged" : change > 0 ? "REGRESSED" : "improved";
+        g_regressions         += significant && change > 0;
+    }
+
+    switch (g_options.format) {
+    case FORMAT_TEXT:
+        printf("%10d %10d %10.2f %10.2f %10.2f %10.2f", producers, consumers, s.median, s.mad, s.ci_low, s.ci_high);
+        if (base) {
+            printf(" %10.2f %+8.1f%% %+7.2f  %s", b.median, change, z, verdict);
+        } else if (g_options.baseline) {
+            printf(" %10s %9s %7s  %s", "-", "-", "-", "no baseline");
+        }
+        printf("\n");
+        break;
+    case FORMAT_CSV:
+        printf(
+            "%d,%d,%w64u,%s,%d,%.3f,%.3f,%.3f,%.3f,",
+            producers,
+            consumers,
+            g_options.items,
+            bench_affinity_name(g_options.affinity),
+            n,
+            s.median,
+            s.mad,
+            s.ci_low,
+            s.ci_high
+        );
+        if (base) {
+            printf("%.3f,%.2f,%.3f,%s\n", b.median, change, z, verdict);
+        } else {
+            printf(",,,%s\n", verdict);
+        }
+        break;
+    case FORMAT_JSON:
+        printf(
+            "%s\n  {\"producers\": %d, \"consumers\": %d, \"items\": %w64u, \"affinity\": \"%s\", "
+            "\"median_cycles_per_pair\": %.3f, \"mad\": %.3f, \"ci_low\": %.3f, \"ci_high\": %.3f, ",
+            first ? "" : ",",
+            producers,
+            consumers,
+            g_options.items,
+            bench_affinity_name(g_options.affinity),
+            s.median,
+            s.mad,
+            s.ci_low,
+            s.ci_high
+        );
+        if (base) {
+            printf("\"baseline_median\": %.3f, \"change_pct\": %.2f, \"z\": %.3f, ", b.median, change, z);
+        }
+        printf("\"verdict\": \"%s\", \"samples\": [", verdict);
+        for (int i = 0; i < n; ++i) {
+            printf("%s%.3f", i == 0 ? "" : ", ", samples[i]);
+        }
+        printf("]}");
+        break;
+    }
+
+    if (g_save_baseline) {
+        fprintf(
+            g_save_baseline,
+            "%d %d %w64u %s %d",
+            producers,
+            consumers,
+            g_options.items,
+            bench_affinity_name(g_options.affinity),
+            n
+        );
+        for (int i = 0; i < n; ++i) {
+            fprintf(g_save_baseline, " %.4f", samples[i]);
+        }
+        fprintf(g_save_baseline, "\n");
     }
+    free(scratch);
+    free(samples);
+}
 
-    for (int i = 0; i < NUM_PRODUCERS; ++i) {
-        int tid = i;
-        if (thrd_create(&threads[tid], producer_func, (void *) (uintptr_t) tid) != thrd_success) {
-            // FIX: thrd_create does not set errno, so do not use perror.
-            fprintf(stderr, "Failed to create producer thread %d.\n", tid);
+void
+run_throughput_sweep() {
+    if (g_options.baseline) {
+        load_baseline(g_options.baseline);
+    }
+    // Opened after loading so a run may refresh the baseline it compares to.
+    if (g_options.save_baseline) {
+        g_save_baseline = fopen(g_options.save_baseline, "w");
+        if (!g_save_baseline) {
+            fprintf(stderr, "Failed to create baseline '%s'.\n", g_options.save_baseline);
             exit(EXIT_FAILURE);
         }
+        fprintf(g_save_baseline, "# faaq_bench baseline: producers consumers items affinity n cycles/pair...\n");
+    }
+
+    print_throughput_header();
+    bool first = true;
+    for (int p = g_options.producers.lo; p != 0; p = sweep_next(&g_options.producers, p)) {
+        for (int c = g_options.consumers.lo; c != 0; c = sweep_next(&g_options.consumers, c)) {
+            if (trials_mode()) {
+                run_throughput_trials(p, c, first);
+            } else {
+                throughput_result_t r;
+                run_throughput(p, c, g_options.items, &r);
+                print_throughput_result(&r, first);
+                free(r.consumer_items);
+            }
+            first = false;
+            fflush(stdout);
+        }
+    }
+    if (g_options.format == FORMAT_JSON) {
+        printf("\n]\n");
+    }
+
+    if (g_save_baseline) {
+        fclose(g_save_baseline);
+        g_save_baseline = nullptr;
+        fprintf(stderr, "Baseline written to %s.\n", g_options.save_baseline);
+    }
+    if (g_regressions > 0) {
+        fprintf(stderr, "%d configuration(s) regressed against %s.\n", g_regressions, g_options.baseline);
+    }
+}
+
+// --- Preemption Injection ---
+//
+// maybe_yield() calls sched_yield() with probability g_yield_threshold / 2^64.
+// Installed as the queue's preempt hook it runs between an enqueuer's FAA and
+// its slot CAS; libraries built without FAAQ_PREEMPT_INJECTION have no such
+// hook, and producers call it between enqueues instead.
+
+static uint64_t g_yield_threshold;
+
+static void
+maybe_yield(void) {
+    static thread_local uint64_t state;
+    if (state == 0) {
+        state = (uintptr_t) &state ^ RDTSC();
+        state = state ? state : 1;
+    }
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    if (state < g_yield_threshold) {
+        sched_yield();
+    }
+}
+
+// --- Scenario Runner ---
+//
+// Runs one producer/consumer configuration against a freshly created queue and
+// reports cycles per item together with the queue's slow-path counters.
+
+typedef struct {
+    FAAArrayQueue_t *queue;
+    uint64_t         items_per_producer;
+    uint64_t         total_items;
+    bool             pin_threads;
+    int              producers;
+    bool             yield_when_empty;
+    bool             yield_between; // Inject preemption between enqueues.
+    alignas(128) atomic_int producers_done;
+    alignas(128) atomic_uint_fast64_t empty_polls;
+} scenario_ctx_t;
+
+typedef struct {
+    scenario_ctx_t *ctx;
+    int             tid;
+} scenario_arg_t;
+
+typedef struct {
+    double          cycles_per_item;
+    double          empty_polls_per_item;
+    uint64_t        total_items;
+    FAAQueueStats_t stats;
+} scenario_result_t;
+
+int
+scenario_producer(void *arg) {
+    scenario_arg_t const *a       = arg;
+    void                 *payload = (void *) (uintptr_t) 1;
+    if (payload == a->ctx->queue->taken_sentinel) {
+        payload = (void *) (uintptr_t) 2;
+    }
+    if (a->ctx->pin_threads) {
+        set_affinity(a->tid);
     }
 
-    printf("Synchronizing start...\n");
     barrier_wait();
-    g_start_cycles = RDTSC();
-    printf("Running benchmark...\n");
+    for (uint64_t i = 0; i < a->ctx->items_per_producer; ++i) {
+        faa_queue_enqueue(a->ctx->queue, payload, a->tid);
+        if (a->ctx->yield_between) {
+            maybe_yield();
+        }
+    }
+    atomic_fetch_add_explicit(&a->ctx->producers_done, 1, memory_order_release);
+    return 0;
+}
 
-    for (int i = 0; i < TOTAL_THREADS; ++i) {
-        thrd_join(threads[i], nullptr);
+int
+scenario_consumer(void *arg) {
+    scenario_arg_t const *a           = arg;
+    uint64_t              empty_polls = 0;
+    if (a->ctx->pin_threads) {
+        set_affinity(a->tid);
     }
 
-    uint64_t end_cycles_val = atomic_load_explicit(&g_end_cycles, memory_order_seq_cst);
+    barrier_wait();
+    while (true) {
+        bool const finished =
+            atomic_load_explicit(&a->ctx->producers_done, memory_order_acquire) == a->ctx->producers;
+        if (faa_queue_dequeue(a->ctx->queue, a->tid) != nullptr) {
+            continue;
+        }
+        if (finished) {
+            break;
+        }
+        empty_polls++;
+        if (a->ctx->yield_when_empty) {
+            thrd_yield();
+        }
+    }
+    atomic_fetch_add_explicit(&a->ctx->empty_polls, empty_polls, memory_order_relaxed);
+    return 0;
+}
 
-    printf("Benchmark finished.\n");
+void
+run_scenario(
+    FAAQueueConfig_t const *cfg,
+    int                     producers,
+    int                     consumers,
+    uint64_t                items,
+    bool                    pin_threads,
+    bool                    yield_when_empty,
+    scenario_result_t      *result
+) {
+    int const       threads_n = producers + consumers;
+    scenario_arg_t *args      = bench_alloc(threads_n, sizeof(scenario_arg_t));
+    scenario_ctx_t *ctx       = bench_alloc(1, sizeof(scenario_ctx_t));
 
-    if (end_cycles_val == 0 || g_start_cycles == 0) {
-        fprintf(stderr, "Error: Timing data was not captured correctly.\n");
+    ctx->queue = faa_queue_create_ex(threads_n, cfg);
+    if (!ctx->queue) {
+        fprintf(stderr, "Failed to create FAA Array Queue.\n");
         exit(EXIT_FAILURE);
     }
-    if (atomic_load(&g_dequeued_count) != TOTAL_ITEMS) {
-        fprintf(stderr, "Error: Count mismatch.\n");
-        exit(EXIT_FAILURE);
+    ctx->items_per_producer = items / producers;
+    ctx->total_items        = ctx->items_per_producer * producers;
+    ctx->pin_threads        = pin_threads;
+    ctx->producers          = producers;
+    ctx->yield_when_empty   = yield_when_empty;
+    ctx->yield_between      = false;
+    if (g_yield_threshold != 0 && !faa_queue_set_preempt_hook(maybe_yield)) {
+        ctx->yield_between = true;
+    }
+    atomic_init(&ctx->producers_done, 0);
+    atomic_init(&ctx->empty_polls, 0);
+
+    for (int tid = 0; tid < threads_n; ++tid) {
+        args[tid] = (scenario_arg_t) { .ctx = ctx, .tid = tid };
     }
+    bench_threads_t threads;
+    bench_threads_start(
+        &threads, &g_barrier, producers, scenario_producer, consumers, scenario_consumer, args, sizeof(args[0])
+    );
 
-    uint64_t total_cycles    = end_cycles_val - g_start_cycles;
-    double   cycles_per_op   = (double) total_cycles / (TOTAL_ITEMS * 2);
-    double   cycles_per_pair = (double) total_cycles / TOTAL_ITEMS;
+    barrier_wait();
+    uint64_t start = RDTSC();
+    bench_threads_join(&threads);
+    uint64_t end = RDTSC();
+    faa_queue_set_preempt_hook(nullptr);
 
-    printf("\n--- Results ---\n");
-    printf("Total Cycles: %w64u\n", total_cycles);
-    printf("Cycles per operation (E or D): %.2f\n", cycles_per_op);
-    printf("Cycles per pair (E+D):         %.2f\n", cycles_per_pair);
+    result->total_items          = ctx->total_items;
+    result->cycles_per_item      = (double) (end - start) / (double) ctx->total_items;
+    result->empty_polls_per_item = (double) atomic_load(&ctx->empty_polls) / (double) ctx->total_items;
+    faa_queue_stats(ctx->queue, &result->stats);
 
-    faa_queue_destroy(g_queue);
-    mtx_destroy(&g_barrier_mutex);
-    cnd_destroy(&g_barrier_cond);
+    faa_queue_destroy(ctx->queue);
+    free(ctx);
+    free(args);
 }
 
-int
-main(void) {
-    printf("Warming up...\n");
-    uint64_t warmup_start = RDTSC();
-    uint64_t dummy        = 0;
-    for (int i = 0; i < 100000000; i++) {
-        dummy = black_box(dummy + i);
-    }
-    uint64_t warmup_end = RDTSC();
-    printf("Warmup finished in %w64u cycles.\n\n", (warmup_end - warmup_start));
-
-    run_benchmark();
-    return EXIT_SUCCESS;
+// --- Oversubscribed Producer Benchmark ---
+//
+// Runs more threads than CPUs so that producers are routinely preempted
+// between their FAA on enqidx and the CAS on the slot. Consumers that
+// overtake them must either wait or burn the slot; burned slots show up as
+// extra node allocations. The first table compares wait policies without
+// affinity. The second sweeps the oversubscription factor with and without
+// pinning, and with preemption injected at random (--yield-prob).
+
+static constexpr int      OVERSUB_FACTOR    = 4;
+static constexpr uint64_t OVERSUB_ITEMS     = 4000000;
+
+static int const          OVERSUB_FACTORS[] = {2, 4, 8};
+
+void
+run_oversubscribed_benchmark() {
+    int const num_cores = bench_online_cpus();
+    int const producers = num_cores * OVERSUB_FACTOR;
+    int const consumers = num_cores;
+
+    printf("\n--- Oversubscribed Producers (Wait Policy Comparison) ---\n");
+    printf("Online CPUs: %d, Producers: %d, Consumers: %d\n", num_cores, producers, consumers);
+    printf("Total Items: %w64u (ideal nodes per 1M items: %.1f)\n", OVERSUB_ITEMS, 1e6 / FAA_BUFFER_SIZE);
+    printf("%-12s %14s %14s %14s %14s\n", "Policy", "Cycles/item", "Nodes/1M", "Burned/1M", "Waited/1M");
+
+    static struct {
+        char const     *name;
+        FAAWaitPolicy_t policy;
+    } const policies[] = {
+        {"none",       FAA_WAIT_NONE      },
+        {"spin",       FAA_WAIT_SPIN      },
+        {"spin+yield", FAA_WAIT_SPIN_YIELD},
+    };
+
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); ++p) {
+        FAAQueueConfig_t cfg = faa_queue_config_default();
+        cfg.wait_policy      = policies[p].policy;
+
+        scenario_result_t r;
+        run_scenario(&cfg, producers, consumers, OVERSUB_ITEMS, false, true, &r);
+
+        double const per_million = 1e6 / (double) r.total_items;
+        printf(
+            "%-12s %14.2f %14.1f %14.1f %14.1f\n",
+            policies[p].name,
+            r.cycles_per_item,
+            (double) r.stats.nodes_allocated * per_million,
+            (double) r.stats.burned_slots * per_million,
+            (double) r.stats.waited_slots * per_million
+        );
+    }
+
+    bool const hooked = faa_queue_set_preempt_hook(nullptr);
+    printf(
+        "\nOversubscription sweep, default wait policy, yield probability %g %s\n",
+        g_options.yield_prob,
+        hooked ? "between FAA and CAS" : "between enqueues (library built without FAAQ_PREEMPT_INJECTION)"
+    );
+    printf(
+        "%6s %10s %8s %8s %12s %12s %12s %12s\n",
+        "Factor",
+        "Prod/Cons",
+        "Pinned",
+        "Yields",
+        "Mitems/s",
+        "Nodes/1M",
+        "Extra/1M",
+        "Burned/1M"
+    );
+    double const cycles_per_ns = bench_cycles_per_ns();
+    for (size_t f = 0; f < sizeof(OVERSUB_FACTORS) / sizeof(OVERSUB_FACTORS[0]); ++f) {
+        int const side = num_cores * OVERSUB_FACTORS[f] / 2 > 0 ? num_cores * OVERSUB_FACTORS[f] / 2 : 1;
+        for (int pinned = 0; pinned < 2; ++pinned) {
+            for (int inject = 0; inject < 2; ++inject) {
+                FAAQueueConfig_t const cfg = faa_queue_config_default();
+                g_yield_threshold          = inject ? (uint64_t) (g_options.yield_prob * 0x1p64) : 0;
+
+                scenario_result_t r;
+                run_scenario(&cfg, side, side, OVERSUB_ITEMS, pinned, true, &r);
+                g_yield_threshold = 0;
+
+                double const per_million = 1e6 / (double) r.total_items;
+                double const nodes       = (double) r.stats.nodes_allocated * per_million;
+                char         threads[24];
+                snprintf(threads, sizeof(threads), "%d/%d", side, side);
+                printf(
+                    "%5dx %10s %8s %8s %12.2f %12.1f %12.1f %12.1f\n",
+                    OVERSUB_FACTORS[f],
+                    threads,
+                    pinned ? "yes" : "no",
+                    inject ? "yes" : "no",
+                    1e3 * cycles_per_ns / r.cycles_per_item,
+                    nodes,
+                    nodes - 1e6 / FAA_BUFFER_SIZE,
+                    (double) r.stats.burned_slots * per_million
+                );
+                fflush(stdout);
+            }
+        }
+    }
+}
+
+// --- Near-Empty Elimination Benchmark ---
+//
+// Equal numbers of pinned producers and busy-polling consumers keep the queue
+// hovering around empty, which is where the elimination layer applies.
+
+static constexpr uint64_t ELIM_ITEMS = 4000000;
+
+static uint32_t const     ELIM_SPIN_SETTINGS[] = {0, 64, 512};
+
+void
+run_elimination_benchmark() {
+    int const pairs = bench_online_cpus() > 1 ? bench_online_cpus() / 2 : 1;
+
+    printf("\n--- Near-Empty Ping-Pong (Elimination Comparison) ---\n");
+    printf("Producers: %d, Consumers: %d, Total Items: %w64u\n", pairs, pairs, ELIM_ITEMS);
+    printf("%-12s %14s %14s %14s %14s\n", "Elim spin", "Cycles/item", "Eliminated %", "Empty/item", "Burned/1M");
+
+    for (size_t i = 0; i < sizeof(ELIM_SPIN_SETTINGS) / sizeof(ELIM_SPIN_SETTINGS[0]); ++i) {
+        FAAQueueConfig_t cfg = faa_queue_config_default();
+        cfg.elimination_spin = ELIM_SPIN_SETTINGS[i];
+
+        scenario_result_t r;
+        run_scenario(&cfg, pairs, pairs, ELIM_ITEMS, true, false, &r);
+
+        printf(
+            "%-12u %14.2f %14.2f %14.2f %14.1f\n",
+            ELIM_SPIN_SETTINGS[i],
+            r.cycles_per_item,
+            100.0 * (double) r.stats.eliminated / (double) r.total_items,
+            r.empty_polls_per_item,
+            (double) r.stats.burned_slots * 1e6 / (double) r.total_items
+        );
+    }
+}
+
+// --- Topology Comparison ---
+//
+// Each restricted topology is measured against the general MPMC queue with the
+// same thread counts, so the difference is the cost the MPMC protocol pays
+// for producer or consumer concurrency the workload does not have.
+
+static constexpr uint64_t TOPOLOGY_ITEMS = 8000000;
+
+void
+run_topology_benchmark() {
+    int const n = bench_online_cpus() > 2 ? bench_online_cpus() / 2 : 2;
+
+    static struct {
+        char const   *name;
+        FAATopology_t topology;
+        int           producers;
+        int           consumers;
+    } const shapes[] = {
+        {"SPSC", FAA_TOPOLOGY_SPSC, 1, 1},
+        {"MPSC", FAA_TOPOLOGY_MPSC, 0, 1},
+        {"SPMC", FAA_TOPOLOGY_SPMC, 1, 0},
+        {"MPMC", FAA_TOPOLOGY_MPMC, 0, 0},
+    };
+
+    printf("\n--- Topology Comparison (Total Items: %w64u) ---\n", TOPOLOGY_ITEMS);
+    printf(
+        "%-6s %10s %10s %16s %16s %10s\n", "Shape", "Producers", "Consumers", "Cycles/item", "MPMC cycles", "Speedup"
+    );
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i) {
+        // A zero count in the table stands for "n threads".
+        int const        producers = shapes[i].producers ? shapes[i].producers : n;
+        int const        consumers = shapes[i].consumers ? shapes[i].consumers : n;
+
+        FAAQueueConfig_t cfg       = faa_queue_config_default();
+        cfg.topology               = shapes[i].topology;
+        scenario_result_t restricted;
+        run_scenario(&cfg, producers, consumers, TOPOLOGY_ITEMS, true, true, &restricted);
+
+        scenario_result_t general = restricted;
+        if (shapes[i].topology != FAA_TOPOLOGY_MPMC) {
+            cfg.topology = FAA_TOPOLOGY_MPMC;
+            run_scenario(&cfg, producers, consumers, TOPOLOGY_ITEMS, true, true, &general);
+        }
+
+        printf(
+            "%-6s %10d %10d %16.2f %16.2f %9.2fx\n",
+            shapes[i].name,
+            producers,
+            consumers,
+            restricted.cycles_per_item,
+            general.cycles_per_item,
+            general.cycles_per_item / restricted.cycles_per_item
+        );
+    }
+}
+
+// --- Node Source Comparison ---
+//
+// Fills a deep queue from one thread and drains it again, twice per node
+// source. The fill phase takes the page faults for fresh nodes; the drain
+// phase walks the whole chain, which is where dTLB misses show up. The second
+// round runs on recycled nodes.
+
+static struct {
+    char const     *name;
+    FAANodeSource_t source;
+} const NODE_SOURCES[] = {
+    {"malloc",        FAA_NODES_MALLOC       },
+    {"arena",         FAA_NODES_ARENA        },
+    {"arena+hugetlb", FAA_NODES_ARENA_HUGETLB},
+};
+
+static constexpr uint64_t DEEP_QUEUE_ITEMS = 4000000;
+static constexpr int      NODE_ROUNDS      = 2;
+
+// Formats an event count per 1K items, or "n/a" when the counter is missing.
+static char const *
+per_kilo_item(char *buf, size_t size, uint64_t count, uint64_t items) {
+    if (count == BENCH_EVENT_UNAVAILABLE) {
+        snprintf(buf, size, "n/a");
+    } else {
+        snprintf(buf, size, "%.2f", (double) count * 1e3 / (double) items);
+    }
+    return buf;
+}
+
+void
+run_node_source_benchmark() {
+
+    printf("\n--- Node Source Comparison (Deep Queue: %w64u items) ---\n", DEEP_QUEUE_ITEMS);
+    printf(
+        "%-14s %6s %12s %12s %12s %14s %14s\n",
+        "Source",
+        "Round",
+        "Fill cyc",
+        "Drain cyc",
+        "Faults",
+        "dTLB miss/1K",
+        "Chunks (huge)"
+    );
+
+    bench_event_t dtlb;
+    bench_event_open_dtlb_misses(&dtlb);
+
+    for (size_t s = 0; s < sizeof(NODE_SOURCES) / sizeof(NODE_SOURCES[0]); ++s) {
+        FAAQueueConfig_t cfg = faa_queue_config_default();
+        cfg.node_source      = NODE_SOURCES[s].source;
+        FAAArrayQueue_t *q   = faa_queue_create_ex(1, &cfg);
+        if (!q) {
+            fprintf(stderr, "Failed to create FAA Array Queue.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for (int round = 1; round <= NODE_ROUNDS; ++round) {
+            uint64_t const faults_start = bench_page_faults();
+            uint64_t const fill_start   = RDTSC();
+            for (uint64_t i = 1; i <= DEEP_QUEUE_ITEMS; ++i) {
+                faa_queue_enqueue(q, (void *) (uintptr_t) i, 0);
+            }
+            uint64_t const fill_end    = RDTSC();
+            uint64_t const faults      = bench_page_faults() - faults_start;
+
+            uint64_t const dtlb_start  = bench_event_read(&dtlb);
+            uint64_t const drain_start = RDTSC();
+            while (faa_queue_dequeue(q, 0) != nullptr) {
+            }
+            uint64_t const drain_end = RDTSC();
+            uint64_t const dtlb_end  = bench_event_read(&dtlb);
+            uint64_t const misses =
+                dtlb_start == BENCH_EVENT_UNAVAILABLE ? BENCH_EVENT_UNAVAILABLE : dtlb_end - dtlb_start;
+
+            // Hand the drained nodes back to their source before the next round.
+            hazptr_cleanup();
+
+            FAAQueueStats_t stats;
+            faa_queue_stats(q, &stats);
+            char misses_buf[32], chunks_buf[32];
+            snprintf(chunks_buf, sizeof(chunks_buf), "%u (%u)", stats.arena_chunks, stats.arena_hugetlb_chunks);
+            printf(
+                "%-14s %6d %12.2f %12.2f %12w64u %14s %14s\n",
+                NODE_SOURCES[s].name,
+                round,
+                (double) (fill_end - fill_start) / DEEP_QUEUE_ITEMS,
+                (double) (drain_end - drain_start) / DEEP_QUEUE_ITEMS,
+                faults,
+                per_kilo_item(misses_buf, sizeof(misses_buf), misses, DEEP_QUEUE_ITEMS),
+                NODE_SOURCES[s].source == FAA_NODES_MALLOC ? "-" : chunks_buf
+            );
+        }
+        faa_queue_destroy(q);
+    }
+
+    bench_event_close(&dtlb);
+}
+
+// --- Segment Boundary Latency ---
+//
+// Times every enqueue from one thread and separates the ones that cross into
+// a new node, which pay for allocating and preparing it, from the rest. The
+// first round runs on fresh memory and is discarded; later rounds reuse the
+// nodes reclaimed after each drain, which is the steady state of a long-lived
+// queue.
+
+static constexpr int      BOUNDARY_ROUNDS = 64;
+static constexpr uint64_t BOUNDARY_ITEMS  = 32 * FAA_BUFFER_SIZE;
+
+void
+run_boundary_latency_benchmark() {
+    size_t const num_sources = sizeof(NODE_SOURCES) / sizeof(NODE_SOURCES[0]);
+    bench_hist_t boundary[sizeof(NODE_SOURCES) / sizeof(NODE_SOURCES[0])];
+    bench_hist_t inner[sizeof(NODE_SOURCES) / sizeof(NODE_SOURCES[0])];
+
+    printf("\n--- Segment Boundary Enqueue Latency (%d rounds of %w64u items) ---\n", BOUNDARY_ROUNDS, BOUNDARY_ITEMS);
+    printf("%-14s %12s %12s %12s %12s %12s\n", "Source", "Crossings", "p50 cyc", "p99 cyc", "Max cyc", "In-node p50");
+
+    for (size_t s = 0; s < num_sources; ++s) {
+        FAAQueueConfig_t cfg = faa_queue_config_default();
+        cfg.node_source      = NODE_SOURCES[s].source;
+        FAAArrayQueue_t *q   = faa_queue_create_ex(1, &cfg);
+        if (!q) {
+            fprintf(stderr, "Failed to create FAA Array Queue.\n");
+            exit(EXIT_FAILURE);
+        }
+        bench_hist_reset(&boundary[s]);
+        bench_hist_reset(&inner[s]);
+
+        // The sentinel starts empty, so item k lands in a new node exactly
+        // when k is a non-zero multiple of FAA_BUFFER_SIZE.
+        uint64_t k = 0;
+        for (int round = 0; round <= BOUNDARY_ROUNDS; ++round) {
+            for (uint64_t i = 0; i < BOUNDARY_ITEMS; ++i, ++k) {
+                uint64_t const start = RDTSC();
+                faa_queue_enqueue(q, (void *) (uintptr_t) (i + 1), 0);
+                uint64_t const cycles = RDTSC() - start;
+                if (round > 0) {
+                    bench_hist_record(k > 0 && k % FAA_BUFFER_SIZE == 0 ? &boundary[s] : &inner[s], cycles);
+                }
+            }
+            while (faa_queue_dequeue(q, 0) != nullptr) {
+            }
+            hazptr_cleanup();
+        }
+        faa_queue_destroy(q);
+
+        printf(
+            "%-14s %12w64u %12w64u %12w64u %12w64u %12w64u\n",
+            NODE_SOURCES[s].name,
+            boundary[s].total,
+            bench_hist_quantile(&boundary[s], 0.50),
+            bench_hist_quantile(&boundary[s], 0.99),
+            boundary[s].max,
+            bench_hist_quantile(&inner[s], 0.50)
+        );
+    }
+
+    printf("\nBoundary crossings by latency (cycles):\n");
+    printf("%-18s", "Bucket");
+    for (size_t s = 0; s < num_sources; ++s) {
+        printf(" %14s", NODE_SOURCES[s].name);
+    }
+    printf("\n");
+    // One row per power of two.
+    for (int exp = 0; exp < 63; ++exp) {
+        uint64_t const low  = exp == 0 ? 0 : (uint64_t) 1 << (exp - 1);
+        uint64_t const high = (uint64_t) 1 << exp;
+        uint64_t       row[sizeof(NODE_SOURCES) / sizeof(NODE_SOURCES[0])];
+        uint64_t       any = 0;
+        for (size_t s = 0; s < num_sources; ++s) {
+            row[s]  = bench_hist_count_below(&boundary[s], high) - bench_hist_count_below(&boundary[s], low);
+            any    += row[s];
+        }
+        if (any == 0) {
+            continue;
+        }
+        char range[32];
+        snprintf(range, sizeof(range), "[%w64u, %w64u)", low, high);
+        printf("%-18s", range);
+        for (size_t s = 0; s < num_sources; ++s) {
+            printf(" %14w64u", row[s]);
+        }
+        printf("\n");
+    }
+}
+
+// --- Sojourn Latency ---
+//
+// Measures how long items wait between enqueue and dequeue. Producers run an
+// open-loop schedule: item i of a producer is due at start + i * interval,
+// whether or not earlier enqueues were slow. Each item points at its stamps;
+// consumers record the time since the item was due ("corrected") and since it
+// was actually enqueued ("raw") into per-thread histograms. A closed-loop
+// measurement that only counts the raw time hides the backlog a stalled
+// producer builds up (coordinated omission); the gap between the two columns
+// shows how much.
+
+static constexpr uint64_t LATENCY_RUN_NS  = 500000000;
+
+// Offered load in million items per second, summed over all producers.
+static double const       LATENCY_RATES[] = {0.25, 1.0, 4.0};
+
+typedef struct {
+    uint64_t due;
+    uint64_t sent;
+} latency_item_t;
+
+typedef struct {
+    FAAArrayQueue_t *queue;
+    latency_item_t  *items; // items_per_producer per producer.
+    uint64_t         items_per_producer;
+    uint64_t         total_items;
+    uint64_t         interval; // Cycles between two items of one producer.
+    uint64_t         start;
+    int              producers;
+    alignas(128) atomic_int producers_done;
+} latency_ctx_t;
+
+typedef struct {
+    latency_ctx_t *ctx;
+    int            tid;
+    bench_hist_t   corrected;
+    bench_hist_t   raw;
+} latency_arg_t;
+
+int
+latency_producer(void *arg) {
+    latency_arg_t  *a     = arg;
+    latency_ctx_t  *ctx   = a->ctx;
+    latency_item_t *items = ctx->items + (size_t) a->tid * ctx->items_per_producer;
+    set_affinity(a->tid);
+
+    barrier_wait();
+    for (uint64_t i = 0; i < ctx->items_per_producer; ++i) {
+        uint64_t const due = ctx->start + i * ctx->interval;
+        uint64_t       now;
+        while ((now = RDTSC()) < due) {
+        }
+        items[i].due  = due;
+        items[i].sent = now;
+        faa_queue_enqueue(ctx->queue, &items[i], a->tid);
+    }
+    atomic_fetch_add_explicit(&ctx->producers_done, 1, memory_order_release);
+    return 0;
+}
+
+int
+latency_consumer(void *arg) {
+    latency_arg_t *a   = arg;
+    latency_ctx_t *ctx = a->ctx;
+    set_affinity(a->tid);
+
+    barrier_wait();
+    while (true) {
+        bool const finished = atomic_load_explicit(&ctx->producers_done, memory_order_acquire) == ctx->producers;
+
+        latency_item_t const *item = faa_queue_dequeue(ctx->queue, a->tid);
+        if (item == nullptr) {
+            if (finished) {
+                break;
+            }
+            continue;
+        }
+        uint64_t const now = RDTSC();
+        bench_hist_record(&a->corrected, now - item->due);
+        bench_hist_record(&a->raw, now - item->sent);
+    }
+    return 0;
+}
+
+void
+run_latency_benchmark() {
+    int const    pairs         = bench_online_cpus() > 1 ? bench_online_cpus() / 2 : 1;
+    int const    threads_n     = 2 * pairs;
+    double const cycles_per_ns = bench_cycles_per_ns();
+
+    printf("\n--- Sojourn Latency (Open-Loop Producers, %.1f ms per rate) ---\n", LATENCY_RUN_NS / 1e6);
+    printf("Producers: %d, Consumers: %d, Cycles per ns: %.2f\n", pairs, pairs, cycles_per_ns);
+    printf(
+        "%-10s %10s %10s %10s %10s %10s %12s %12s %12s\n",
+        "Mitems/s",
+        "Achieved",
+        "p50 ns",
+        "p99 ns",
+        "p99.9 ns",
+        "Max ns",
+        "Raw p99 ns",
+        "Raw p99.9",
+        "Raw max ns"
+    );
+
+    latency_arg_t *args = bench_alloc(threads_n, sizeof(latency_arg_t));
+    latency_ctx_t *ctx  = bench_alloc(1, sizeof(latency_ctx_t));
+
+    for (size_t r = 0; r < sizeof(LATENCY_RATES) / sizeof(LATENCY_RATES[0]); ++r) {
+        double const per_producer_ns = 1e3 / LATENCY_RATES[r] * pairs;
+        ctx->items_per_producer      = (uint64_t) ((double) LATENCY_RUN_NS / per_producer_ns);
+        ctx->total_items             = ctx->items_per_producer * pairs;
+        ctx->interval                = (uint64_t) (per_producer_ns * cycles_per_ns);
+        ctx->items                   = calloc(ctx->total_items, sizeof(latency_item_t));
+        ctx->queue                   = faa_queue_create(threads_n);
+        if (!ctx->items || !ctx->queue) {
+            fprintf(stderr, "Failed to create FAA Array Queue.\n");
+            exit(EXIT_FAILURE);
+        }
+        ctx->producers = pairs;
+        atomic_init(&ctx->producers_done, 0);
+
+        for (int tid = 0; tid < threads_n; ++tid) {
+            // Consumers take the thread IDs after the producers, so producer
+            // 'tid' also indexes its slice of the stamp array.
+            args[tid].ctx = ctx;
+            args[tid].tid = tid;
+            bench_hist_reset(&args[tid].corrected);
+            bench_hist_reset(&args[tid].raw);
+        }
+        bench_threads_t threads;
+        bench_threads_start(
+            &threads, &g_barrier, pairs, latency_producer, pairs, latency_consumer, args, sizeof(args[0])
+        );
+
+        // Leave the threads a moment to get from the barrier to their loops.
+        ctx->start = RDTSC() + (uint64_t) (1e6 * cycles_per_ns);
+        barrier_wait();
+        bench_threads_join(&threads);
+        uint64_t const end = RDTSC();
+
+        bench_hist_t corrected, raw;
+        bench_hist_reset(&corrected);
+        bench_hist_reset(&raw);
+        for (int tid = pairs; tid < threads_n; ++tid) {
+            bench_hist_merge(&corrected, &args[tid].corrected);
+            bench_hist_merge(&raw, &args[tid].raw);
+        }
+
+        double const elapsed_ns = (double) (end - ctx->start) / cycles_per_ns;
+        printf(
+            "%-10.2f %10.2f %10.0f %10.0f %10.0f %10.0f %12.0f %12.0f %12.0f\n",
+            LATENCY_RATES[r],
+            (double) ctx->total_items * 1e3 / elapsed_ns,
+            bench_hist_quantile(&corrected, 0.50) / cycles_per_ns,
+            bench_hist_quantile(&corrected, 0.99) / cycles_per_ns,
+            bench_hist_quantile(&corrected, 0.999) / cycles_per_ns,
+            corrected.max / cycles_per_ns,
+            bench_hist_quantile(&raw, 0.99) / cycles_per_ns,
+            bench_hist_quantile(&raw, 0.999) / cycles_per_ns,
+            raw.max / cycles_per_ns
+        );
+
+        faa_queue_destroy(ctx->queue);
+        free(ctx->items);
+    }
+
+    free(ctx);
+    free(args);
+}
+
+// --- Ping-Pong Round Trip ---
+//
+// The request/response pattern: thread A writes a message, enqueues it on one
+// queue and waits for the reply on another, which thread B dequeues, answers
+// and enqueues. Each round trip moves enqidx, the slot and the message line
+// from one core to the other and back, so the placement of the two threads
+// decides most of the cost. Both sides poll, yielding after PINGPONG_SPIN
+// empty dequeues so that a shared CPU still makes progress, or right away on
+// a single-CPU machine where spinning only burns the partner's time slice.
+
+static constexpr int PINGPONG_ROUNDS = 200000;
+static constexpr int PINGPONG_WARMUP = 10000;
+static constexpr int PINGPONG_SPIN   = 1024;
+
+typedef struct {
+    alignas(128) uint64_t seq;
+} pingpong_msg_t;
+
+typedef struct {
+    FAAArrayQueue_t *requests;
+    FAAArrayQueue_t *replies;
+    int              cpu; // -1: leave placement to the scheduler.
+    int              spin;
+    pingpong_msg_t   request;
+    pingpong_msg_t   reply;
+    bench_hist_t     round_trip;
+} pingpong_ctx_t;
+
+// Polls 'q' until it yields an item.
+static void *
+pingpong_wait(FAAArrayQueue_t *q, int tid, int spin) {
+    for (int spins = 0;; ++spins) {
+        void *item = faa_queue_dequeue(q, tid);
+        if (item) {
+            return item;
+        }
+        if (spins >= spin) {
+            thrd_yield();
+            spins = 0;
+        }
+    }
+}
+
+int
+pingpong_echo(void *arg) {
+    pingpong_ctx_t *ctx = arg;
+    if (ctx->cpu >= 0) {
+        bench_pin_cpu(ctx->cpu);
+    }
+
+    barrier_wait();
+    for (int i = 0; i < PINGPONG_WARMUP + PINGPONG_ROUNDS; ++i) {
+        pingpong_msg_t const *request = pingpong_wait(ctx->requests, 1, ctx->spin);
+        ctx->reply.seq                = request->seq;
+        faa_queue_enqueue(ctx->replies, &ctx->reply, 1);
+    }
+    return 0;
+}
+
+// Runs one placement on the calling thread (side A) and 'echo_cpu' (side B).
+static void
+run_pingpong(pingpong_ctx_t *ctx, int cpu, int echo_cpu) {
+    ctx->requests = faa_queue_create(2);
+    ctx->replies  = faa_queue_create(2);
+    if (!ctx->requests || !ctx->replies) {
+        fprintf(stderr, "Failed to create FAA Array Queue.\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->cpu  = echo_cpu;
+    ctx->spin = bench_online_cpus() > 1 ? PINGPONG_SPIN : 0;
+    bench_hist_reset(&ctx->round_trip);
+
+    bench_threads_t echo;
+    bench_threads_start(&echo, &g_barrier, 1, pingpong_echo, 0, nullptr, ctx, 0);
+    cpu_set_t saved;
+    sched_getaffinity(0, sizeof(saved), &saved);
+    if (cpu >= 0) {
+        bench_pin_cpu(cpu);
+    }
+
+    barrier_wait();
+    for (int i = 0; i < PINGPONG_WARMUP + PINGPONG_ROUNDS; ++i) {
+        uint64_t const start = RDTSC();
+        ctx->request.seq     = (uint64_t) i;
+        faa_queue_enqueue(ctx->requests, &ctx->request, 0);
+        pingpong_msg_t const *reply = pingpong_wait(ctx->replies, 0, ctx->spin);
+        uint64_t const        end   = RDTSC();
+        if (reply->seq != (uint64_t) i) {
+            fprintf(stderr, "Error: reply %w64u to request %d.\n", reply->seq, i);
+            exit(EXIT_FAILURE);
+        }
+        if (i >= PINGPONG_WARMUP) {
+            bench_hist_record(&ctx->round_trip, end - start);
+        }
+    }
+    bench_threads_join(&echo);
+
+    sched_setaffinity(0, sizeof(saved), &saved);
+    faa_queue_destroy(ctx->requests);
+    faa_queue_destroy(ctx->replies);
+}
+
+void
+run_pingpong_benchmark() {
+    bench_cpu_t *info = bench_alloc(CPU_SETSIZE, sizeof(bench_cpu_t));
+    int const    n    = bench_cpu_info(info, CPU_SETSIZE);
+
+    // The first pair of CPUs at each distance; -1 where the machine has none.
+    enum {
+        SAME_CORE,
+        SAME_L3,
+        SAME_PACKAGE,
+        CROSS_PACKAGE,
+        PLACEMENTS,
+    };
+    static char const *const names[PLACEMENTS] = {"SMT sibling", "Same L3", "Other L3", "Other socket"};
+    int                      pairs[PLACEMENTS][2];
+    for (int p = 0; p < PLACEMENTS; ++p) {
+        pairs[p][0] = pairs[p][1] = -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            bench_cpu_t const *a = &info[i], *b = &info[j];
+            int const          p = a->package != b->package ? CROSS_PACKAGE
+                                 : a->core == b->core       ? SAME_CORE
+                                 : a->l3 == b->l3           ? SAME_L3
+                                                            : SAME_PACKAGE;
+            if (pairs[p][0] < 0) {
+                pairs[p][0] = a->cpu;
+                pairs[p][1] = b->cpu;
+            }
+        }
+    }
+    free(info);
+
+    double const    cycles_per_ns = bench_cycles_per_ns();
+    pingpong_ctx_t *ctx           = bench_alloc(1, sizeof(pingpong_ctx_t));
+
+    printf("\n--- Ping-Pong Round Trip (%d round trips per placement) ---\n", PINGPONG_ROUNDS);
+    printf(
+        "%-14s %8s %10s %10s %10s %10s %10s\n", "Placement", "CPUs", "p50 ns", "p99 ns", "p99.9 ns", "Max ns", "One-way"
+    );
+    for (int p = -1; p < PLACEMENTS; ++p) {
+        char cpus[24];
+        if (p >= 0 && pairs[p][0] < 0) {
+            printf("%-14s %8s %10s\n", names[p], "-", "not present");
+            continue;
+        }
+        if (p < 0) {
+            snprintf(cpus, sizeof(cpus), "any");
+            run_pingpong(ctx, -1, -1);
+        } else {
+            snprintf(cpus, sizeof(cpus), "%d,%d", pairs[p][0], pairs[p][1]);
+            run_pingpong(ctx, pairs[p][0], pairs[p][1]);
+        }
+        double const p50 = bench_hist_quantile(&ctx->round_trip, 0.50) / cycles_per_ns;
+        printf(
+            "%-14s %8s %10.0f %10.0f %10.0f %10.0f %10.0f\n",
+            p < 0 ? "Unpinned" : names[p],
+            cpus,
+            p50,
+            bench_hist_quantile(&ctx->round_trip, 0.99) / cycles_per_ns,
+            bench_hist_quantile(&ctx->round_trip, 0.999) / cycles_per_ns,
+            ctx->round_trip.max / cycles_per_ns,
+            p50 / 2
+        );
+    }
+    free(ctx);
+}
+
+// --- Payload Sweep ---
+//
+// The throughput sweep passes a constant pointer that nobody dereferences.
+// Here each producer fills a buffer from its own pool and enqueues it, and
+// consumers checksum every byte and hand the buffer back by clearing its busy
+// flag, which shares the first line with the payload. Consumers therefore
+// pull the payload lines from the producer's cache, and producers pull the
+// flag back before reusing a buffer. Size 0 is the constant-pointer baseline.
+
+static constexpr uint64_t PAYLOAD_ITEMS = 2000000;
+static constexpr uint32_t PAYLOAD_POOL  = 1024; // Buffers per producer.
+
+typedef struct {
+    FAAArrayQueue_t *queue;
+    int              producers;
+    uint64_t         items_per_producer;
+    size_t           size;
+    size_t           stride; // Buffer size: flag plus payload, in whole lines.
+    char            *pool;   // PAYLOAD_POOL buffers per producer.
+    consumer_slot_t *consumers;
+    alignas(128) atomic_int producers_done;
+} payload_ctx_t;
+
+typedef struct {
+    payload_ctx_t *ctx;
+    int            tid;
+    uint64_t       checksum;
+} payload_arg_t;
+
+// Sums the payload after the busy flag in 8-byte words.
+static inline uint64_t
+payload_checksum(char const *buf, size_t size) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, buf + sizeof(uint64_t) + i, sizeof(word));
+        sum += word;
+    }
+    return sum;
+}
+
+int
+payload_producer(void *arg) {
+    payload_arg_t *a    = arg;
+    payload_ctx_t *ctx  = a->ctx;
+    char          *pool = ctx->pool + (size_t) a->tid * PAYLOAD_POOL * ctx->stride;
+    uint64_t       sum  = 0;
+    set_affinity(a->tid);
+
+    barrier_wait();
+    for (uint64_t n = 0; n < ctx->items_per_producer; ++n) {
+        if (ctx->size == 0) {
+            faa_queue_enqueue(ctx->queue, (void *) (uintptr_t) 1, a->tid);
+            continue;
+        }
+        char        *buf  = pool + (n % PAYLOAD_POOL) * ctx->stride;
+        atomic_bool *busy = (atomic_bool *) buf;
+        while (atomic_load_explicit(busy, memory_order_acquire)) {
+            thrd_yield();
+        }
+        for (size_t i = 0; i < ctx->size; i += sizeof(uint64_t)) {
+            uint64_t const word = n + i;
+            memcpy(buf + sizeof(uint64_t) + i, &word, sizeof(word));
+            sum += word;
+        }
+        atomic_store_explicit(busy, true, memory_order_relaxed);
+        faa_queue_enqueue(ctx->queue, buf, a->tid);
+    }
+    atomic_fetch_add_explicit(&ctx->producers_done, 1, memory_order_release);
+    a->checksum = sum;
+    return 0;
+}
+
+int
+payload_consumer(void *arg) {
+    payload_arg_t   *a     = arg;
+    payload_ctx_t   *ctx   = a->ctx;
+    consumer_slot_t *slot  = &ctx->consumers[a->tid - ctx->producers];
+    uint64_t         items = 0, sum = 0;
+    set_affinity(a->tid);
+
+    barrier_wait();
+    while (true) {
+        bool const finished = atomic_load_explicit(&ctx->producers_done, memory_order_acquire) == ctx->producers;
+        char      *buf      = faa_queue_dequeue(ctx->queue, a->tid);
+        if (buf != nullptr) {
+            if (ctx->size != 0) {
+                sum += payload_checksum(buf, ctx->size);
+                atomic_store_explicit((atomic_bool *) buf, false, memory_order_release);
+            }
+            items++;
+        } else if (finished) {
+            break;
+        } else {
+            thrd_yield();
+        }
+    }
+    slot->end_cycles = RDTSC();
+    slot->items      = items;
+    a->checksum      = sum;
+    return 0;
+}
+
+static void
+run_payload(int producers, int consumers, size_t size) {
+    int const        threads_n = producers + consumers;
+    payload_arg_t   *args      = bench_alloc(threads_n, sizeof(payload_arg_t));
+    payload_ctx_t   *ctx       = bench_alloc(1, sizeof(payload_ctx_t));
+    consumer_slot_t *slots     = bench_alloc(consumers, sizeof(consumer_slot_t));
+    size_t const     stride    = (sizeof(uint64_t) + size + 63) / 64 * 64;
+    char            *pool      = size ? bench_alloc((size_t) producers * PAYLOAD_POOL, stride) : nullptr;
+
+    ctx->queue = faa_queue_create(threads_n);
+    if (!ctx->queue) {
+        fprintf(stderr, "Failed to create FAA Array Queue.\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->producers          = producers;
+    ctx->items_per_producer = PAYLOAD_ITEMS / producers;
+    ctx->size               = size;
+    ctx->stride             = stride;
+    ctx->pool               = pool;
+    ctx->consumers          = slots;
+    atomic_init(&ctx->producers_done, 0);
+
+    for (int tid = 0; tid < threads_n; ++tid) {
+        args[tid] = (payload_arg_t) {.ctx = ctx, .tid = tid};
+    }
+    bench_threads_t threads;
+    bench_threads_start(
+        &threads, &g_barrier, producers, payload_producer, consumers, payload_consumer, args, sizeof(args[0])
+    );
+    barrier_wait();
+    uint64_t const start_ns     = bench_now_ns();
+    uint64_t const start_cycles = RDTSC();
+    bench_threads_join(&threads);
+    uint64_t const join_ns = bench_now_ns();
+
+    uint64_t end_cycles = start_cycles, dequeued = 0, written = 0, read = 0;
+    for (int c = 0; c < consumers; ++c) {
+        dequeued   += slots[c].items;
+        end_cycles  = slots[c].end_cycles > end_cycles ? slots[c].end_cycles : end_cycles;
+    }
+    for (int tid = 0; tid < threads_n; ++tid) {
+        *(tid < producers ? &written : &read) += args[tid].checksum;
+    }
+    uint64_t const total = ctx->items_per_producer * producers;
+    if (dequeued != total || written != read) {
+        fprintf(stderr, "Error: payload mismatch (%w64u of %w64u items).\n", dequeued, total);
+        exit(EXIT_FAILURE);
+    }
+
+    double const ns = (double) (join_ns - start_ns);
+    printf(
+        "%10zu %12.2f %12.2f %12.2f\n",
+        size,
+        (double) (end_cycles - start_cycles) / (double) (total * 2),
+        (double) total * 1e3 / ns,
+        (double) (total * size) / ns
+    );
+
+    faa_queue_destroy(ctx->queue);
+    free(pool);
+    free(slots);
+    free(ctx);
+    free(args);
+}
+
+void
+run_payload_benchmark() {
+    int const producers = g_options.producers.lo;
+    int const consumers = g_options.consumers.lo;
+    printf("\n--- Payload Size Sweep (%w64u items, %d pool buffers per producer) ---\n", PAYLOAD_ITEMS, PAYLOAD_POOL);
+    printf(
+        "Producers: %d, Consumers: %d, Affinity: %s\n", producers, consumers, bench_affinity_name(g_options.affinity)
+    );
+    printf("%10s %12s %12s %12s\n", "Bytes", "Cycles/op", "Mitems/s", "GB/s");
+    for (char const *p = g_options.payload_sizes; *p != '\0';) {
+        size_t const size = strtoul(p, nullptr, 10);
+        run_payload(producers, consumers, size);
+        fflush(stdout);
+        p += strcspn(p, ",");
+        p += *p == ',';
+    }
+}
+
+// --- Memory Footprint Over Time ---
+//
+// Producers alternate between bursts, in which they enqueue up to a fixed
+// number of items as fast as they can, and idle phases. Consumers only
+// dequeue between bursts, so every burst leaves a backlog of nodes that is
+// drained while the producers are idle. A sampler thread records RSS, the
+// queue's live and retired nodes and the HP domain's retired backlog at a
+// fixed interval. The series shows how much of a burst's memory comes back,
+// and how soon, once hazptr_retire() has handed the drained nodes to
+// reclamation.
+
+static constexpr int FOOTPRINT_MAX_SAMPLES = 8192;
+
+typedef struct {
+    uint64_t       ns;
+    uint64_t       rss_bytes;
+    uint64_t       live_nodes;
+    uint64_t       retired_nodes;
+    hazptr_count_t hp_backlog;
+    int            burst; // Burst in progress (1-based), 0 while idle.
+} footprint_sample_t;
+
+typedef struct {
+    FAAArrayQueue_t    *queue;
+    int                 producers;
+    uint64_t            items_per_producer; // Per burst.
+    uint64_t            start_ns;
+    footprint_sample_t *samples;
+    int                 num_samples;
+    // Number of the current burst while producers are allowed to enqueue,
+    // 0 between bursts.
+    alignas(128) atomic_int burst;
+    alignas(128) atomic_bool done;
+} footprint_ctx_t;
+
+typedef struct {
+    footprint_ctx_t *ctx;
+    int              tid;
+} footprint_arg_t;
+
+static void
+footprint_sleep_ns(uint64_t ns) {
+    thrd_sleep(&(struct timespec) {.tv_sec = (time_t) (ns / 1000000000), .tv_nsec = (long) (ns % 1000000000)}, nullptr);
+}
+
+int
+footprint_producer(void *arg) {
+    footprint_arg_t *a    = arg;
+    footprint_ctx_t *ctx  = a->ctx;
+    int              seen = 0;
+    set_affinity(a->tid);
+
+    barrier_wait();
+    while (!atomic_load_explicit(&ctx->done, memory_order_acquire)) {
+        int const burst = atomic_load_explicit(&ctx->burst, memory_order_acquire);
+        if (burst == 0 || burst == seen) {
+            footprint_sleep_ns(100000);
+            continue;
+        }
+        seen = burst;
+        for (uint64_t i = 0; i < ctx->items_per_producer; ++i) {
+            // Stop early if the burst window closes before the quota is met.
+            if ((i & 1023) == 0 && atomic_load_explicit(&ctx->burst, memory_order_relaxed) != burst) {
+                break;
+            }
+            faa_queue_enqueue(ctx->queue, (void *) (uintptr_t) 1, a->tid);
+        }
+    }
+    return 0;
+}
+
+int
+footprint_consumer(void *arg) {
+    footprint_arg_t *a   = arg;
+    footprint_ctx_t *ctx = a->ctx;
+    set_affinity(a->tid);
+
+    barrier_wait();
+    while (!atomic_load_explicit(&ctx->done, memory_order_acquire)) {
+        if (atomic_load_explicit(&ctx->burst, memory_order_relaxed) != 0
+            || faa_queue_dequeue(ctx->queue, a->tid) == nullptr) {
+            footprint_sleep_ns(100000);
+        }
+    }
+    return 0;
+}
+
+int
+footprint_sampler(void *arg) {
+    footprint_ctx_t *ctx      = arg;
+    uint64_t const   interval = g_options.sample_ms * 1000000;
+    uint64_t         due      = ctx->start_ns;
+
+    while (!atomic_load_explicit(&ctx->done, memory_order_acquire) && ctx->num_samples < FOOTPRINT_MAX_SAMPLES) {
+        FAAQueueMemory_t usage;
+        faa_queue_memory_usage(ctx->queue, &usage);
+        ctx->samples[ctx->num_samples++] = (footprint_sample_t) {
+            .ns            = bench_now_ns() - ctx->start_ns,
+            .rss_bytes     = bench_rss_bytes(),
+            .live_nodes    = usage.live_nodes,
+            .retired_nodes = usage.retired_nodes,
+            .hp_backlog    = hazptr_retired_count(),
+            .burst         = atomic_load_explicit(&ctx->burst, memory_order_relaxed),
+        };
+        due              += interval;
+        uint64_t const now = bench_now_ns();
+        if (due > now) {
+            footprint_sleep_ns(due - now);
+        }
+    }
+    return 0;
+}
+
+static void
+run_footprint(FAAQueueConfig_t const *cfg, char const *source, int producers, int consumers) {
+    int const           threads_n = producers + consumers;
+    footprint_arg_t    *args      = bench_alloc(threads_n, sizeof(footprint_arg_t));
+    footprint_ctx_t    *ctx       = bench_alloc(1, sizeof(footprint_ctx_t));
+    footprint_sample_t *samples   = bench_alloc(FOOTPRINT_MAX_SAMPLES, sizeof(footprint_sample_t));
+
+    ctx->queue = faa_queue_create_ex(threads_n, cfg);
+    if (!ctx->queue) {
+        fprintf(stderr, "Failed to create FAA Array Queue.\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->producers          = producers;
+    ctx->items_per_producer = g_options.burst_items / producers;
+    ctx->samples            = samples;
+    ctx->num_samples        = 0;
+    atomic_init(&ctx->burst, 0);
+    atomic_init(&ctx->done, false);
+
+    for (int tid = 0; tid < threads_n; ++tid) {
+        args[tid] = (footprint_arg_t) {.ctx = ctx, .tid = tid};
+    }
+    bench_threads_t threads;
+    bench_threads_start(
+        &threads, &g_barrier, producers, footprint_producer, consumers, footprint_consumer, args, sizeof(args[0])
+    );
+    barrier_wait();
+
+    // One idle period before the first burst gives the baseline.
+    thrd_t sampler;
+    ctx->start_ns = bench_now_ns();
+    if (thrd_create(&sampler, footprint_sampler, ctx) != thrd_success) {
+        fprintf(stderr, "Failed to create sampler thread.\n");
+        exit(EXIT_FAILURE);
+    }
+    footprint_sleep_ns(g_options.burst_off_ms * 1000000);
+    for (int b = 1; b <= g_options.bursts; ++b) {
+        atomic_store_explicit(&ctx->burst, b, memory_order_release);
+        footprint_sleep_ns(g_options.burst_on_ms * 1000000);
+        atomic_store_explicit(&ctx->burst, 0, memory_order_release);
+        footprint_sleep_ns(g_options.burst_off_ms * 1000000);
+    }
+    atomic_store_explicit(&ctx->done, true, memory_order_release);
+    thrd_join(sampler, nullptr);
+    bench_threads_join(&threads);
+
+    printf("\nNode source: %s\n", source);
+    printf("%8s %6s %10s %10s %10s %10s\n", "Time ms", "Burst", "RSS MiB", "Live", "Retired", "HP backlog");
+    for (int i = 0; i < ctx->num_samples; ++i) {
+        footprint_sample_t const *smp = &samples[i];
+        char                      burst[12];
+        snprintf(burst, sizeof(burst), smp->burst ? "%d" : "-", smp->burst);
+        printf(
+            "%8.1f %6s %10.1f %10w64u %10w64u %10w64d\n",
+            (double) smp->ns / 1e6,
+            burst,
+            (double) smp->rss_bytes / (1 << 20),
+            smp->live_nodes,
+            smp->retired_nodes,
+            smp->hp_backlog
+        );
+    }
+
+    // Per burst: the peak, what is left at the end of the following idle
+    // phase, and how long after the burst the retired nodes took to drain.
+    printf(
+        "%6s %12s %12s %12s %12s %14s\n",
+        "Burst",
+        "Peak live",
+        "Peak RSS MiB",
+        "End live",
+        "End RSS MiB",
+        "Reclaimed ms"
+    );
+    for (int b = 1; b <= g_options.bursts; ++b) {
+        uint64_t peak_live = 0, peak_rss = 0, end_ns = 0;
+        int      last = -1;
+        for (int i = 0; i < ctx->num_samples; ++i) {
+            footprint_sample_t const *smp = &samples[i];
+            if (smp->burst == b) {
+                peak_live = smp->live_nodes > peak_live ? smp->live_nodes : peak_live;
+                peak_rss  = smp->rss_bytes > peak_rss ? smp->rss_bytes : peak_rss;
+                end_ns    = smp->ns;
+                last      = i;
+            }
+        }
+        if (last < 0) {
+            continue;
+        }
+        // Samples up to the next burst belong to this burst's idle phase.
+        int end     = last;
+        int drained = -1;
+        for (int i = last + 1; i < ctx->num_samples && samples[i].burst == 0; ++i) {
+            footprint_sample_t const *smp = &samples[i];
+            peak_live                     = smp->live_nodes > peak_live ? smp->live_nodes : peak_live;
+            peak_rss                      = smp->rss_bytes > peak_rss ? smp->rss_bytes : peak_rss;
+            end                           = i;
+            if (drained < 0 && smp->retired_nodes == 0 && smp->live_nodes <= 1) {
+                drained = i;
+            }
+        }
+        char reclaimed[24];
+        if (drained < 0) {
+            snprintf(reclaimed, sizeof(reclaimed), "never");
+        } else {
+            snprintf(reclaimed, sizeof(reclaimed), "%.1f", (double) (samples[drained].ns - end_ns) / 1e6);
+        }
+        printf(
+            "%6d %12w64u %12.1f %12w64u %12.1f %14s\n",
+            b,
+            peak_live,
+            (double) peak_rss / (1 << 20),
+            samples[end].live_nodes,
+            (double) samples[end].rss_bytes / (1 << 20),
+            reclaimed
+        );
+    }
+    fflush(stdout);
+
+    faa_queue_destroy(ctx->queue);
+    free(samples);
+    free(ctx);
+    free(args);
+}
+
+void
+run_footprint_benchmark() {
+    int const producers = g_options.producers.lo;
+    int const consumers = g_options.consumers.lo;
+    printf("\n--- Memory Footprint Over Time ---\n");
+    printf(
+        "Producers: %d, Consumers: %d, %d bursts of up to %w64u items in %w64u ms, %w64u ms idle, "
+        "sampled every %w64u ms\n",
+        producers,
+        consumers,
+        g_options.bursts,
+        g_options.burst_items / producers * producers,
+        g_options.burst_on_ms,
+        g_options.burst_off_ms,
+        g_options.sample_ms
+    );
+    for (size_t s = 0; s < 2; ++s) {
+        FAAQueueConfig_t cfg = faa_queue_config_default();
+        cfg.node_source      = NODE_SOURCES[s].source;
+        run_footprint(&cfg, NODE_SOURCES[s].name, producers, consumers);
+    }
+}
+
+// --- Inline Fast Path ---
+//
+// One thread enqueues and immediately dequeues, so every operation hits the
+// fast path except the one node boundary per FAA_BUFFER_SIZE pairs. Compares
+// the exported functions with the faaq_inline.h versions compiled into the
+// loop; the difference is the call, the argument checks and the exchange the
+// inline dequeue avoids.
+
+static constexpr uint64_t INLINE_PAIRS  = 4000000;
+static constexpr int      INLINE_ROUNDS = 5;
+
+static void
+run_inline_pairs(bool use_inline, bench_counter_group_t *g, double *cycles, bench_counters_t *counters) {
+    FAAArrayQueue_t *q = faa_queue_create(1);
+    if (!q) {
+        fprintf(stderr, "Failed to create FAA Array Queue.\n");
+        exit(EXIT_FAILURE);
+    }
+    void *const item = (void *) (uintptr_t) 1;
+    void       *sink = nullptr;
+
+    bench_counter_group_start(g);
+    uint64_t const start = RDTSC();
+    if (use_inline) {
+        for (uint64_t i = 0; i < INLINE_PAIRS; ++i) {
+            faa_queue_enqueue_inline(q, item, 0);
+            sink = faa_queue_dequeue_inline(q, 0);
+        }
+    } else {
+        for (uint64_t i = 0; i < INLINE_PAIRS; ++i) {
+            faa_queue_enqueue(q, item, 0);
+            sink = faa_queue_dequeue(q, 0);
+        }
+    }
+    uint64_t const end = RDTSC();
+    bench_counter_group_stop(g, counters);
+
+    if (sink != item) {
+        fprintf(stderr, "Error: inline pair loop lost an item.\n");
+        exit(EXIT_FAILURE);
+    }
+    *cycles = (double) (end - start) / (double) INLINE_PAIRS;
+    faa_queue_destroy(q);
+}
+
+void
+run_inline_benchmark() {
+    printf("\n--- Inline Fast Path (%w64u enqueue/dequeue pairs, best of %d) ---\n", INLINE_PAIRS, INLINE_ROUNDS);
+    printf("%-10s %14s %14s\n", "Path", "Cycles/pair", "Instr/pair");
+
+    bench_counter_group_t g;
+    bench_counter_group_open(&g, 0);
+    for (int use_inline = 0; use_inline < 2; ++use_inline) {
+        double           best          = INFINITY;
+        bench_counters_t best_counters = {};
+        for (int r = 0; r < INLINE_ROUNDS; ++r) {
+            double           cycles;
+            bench_counters_t counters;
+            run_inline_pairs(use_inline, &g, &cycles, &counters);
+            if (cycles < best) {
+                best          = cycles;
+                best_counters = counters;
+            }
+        }
+        uint64_t const instructions = best_counters.hw[BENCH_HW_INSTRUCTIONS];
+        char           instr[24];
+        if (instructions == BENCH_EVENT_UNAVAILABLE) {
+            snprintf(instr, sizeof(instr), "n/a");
+        } else {
+            snprintf(instr, sizeof(instr), "%.1f", (double) instructions / (double) INLINE_PAIRS);
+        }
+        printf("%-10s %14.2f %14s\n", use_inline ? "inline" : "exported", best, instr);
+    }
+    bench_counter_group_close(&g);
+}
+
+// --- Command Line ---
+
+static struct {
+    char const *name;
+    void (*run)(void);
+} const SECTIONS[] = {
+    {"throughput",     run_throughput_sweep          },
+    {"oversubscribed", run_oversubscribed_benchmark  },
+    {"elimination",    run_elimination_benchmark     },
+    {"topology",       run_topology_benchmark        },
+    {"node-source",    run_node_source_benchmark     },
+    {"boundary",       run_boundary_latency_benchmark},
+    {"latency",        run_latency_benchmark         },
+    {"pingpong",       run_pingpong_benchmark        },
+    {"payload",        run_payload_benchmark         },
+    {"footprint",      run_footprint_benchmark       },
+    {"inline",         run_inline_benchmark          },
+};
+
+static void
+usage(FILE *out, char const *prog) {
+    fprintf(
+        out,
+        "Usage: %s [options]\n"
+        "  -p, --producers=RANGE   Producer counts to sweep (default 8)\n"
+        "  -c, --consumers=RANGE   Consumer counts to sweep (default 8)\n"
+        "  -n, --items=N           Items per throughput run; k/m/g suffixes allowed (default 20m)\n"
+        "  -a, --affinity=POLICY   compact, scatter or none (default compact)\n"
+        "  -w, --warmup-ms=MS      CPU warmup before the first run (default 200)\n"
+        "  -f, --format=FORMAT     text, csv or json (default text)\n"
+        "  -s, --sections=LIST     Comma-separated sections to run, or 'all' (default)\n"
+        "  -r, --trials=N          Throughput runs per configuration, summarized (default 1)\n"
+        "      --discard=N         Leading runs dropped before the trials (default 1)\n"
+        "      --baseline=FILE     Compare the throughput trials against FILE\n"
+        "      --save-baseline=FILE  Write the throughput trials to FILE\n"
+        "      --threshold=PCT     Smallest median change reported as significant (default 2)\n"
+        "      --counters          Count instructions, cache and branch misses per throughput op\n"
+        "      --hitm-event=CONFIG Raw PMU event counted as HITM, e.g. 0x04d2; implies --counters\n"
+        "      --payload-sizes=LIST  Payload bytes for the payload section, multiples of 8\n"
+        "                          (default 0,16,64,256,1024,4096; 0 passes a constant pointer)\n"
+        "      --yield-prob=P      sched_yield chance per enqueue in injected oversubscribed runs (default 0.001)\n"
+        "      --burst=ITEMS,ON,OFF  Footprint bursts: up to ITEMS in ON ms, then OFF ms idle (default 1m,100,300)\n"
+        "      --bursts=N          Number of footprint bursts (default 3)\n"
+        "      --sample-ms=MS      Footprint sampling interval (default 10)\n"
+        "  -h, --help              Show this help\n"
+        "\n"
+        "RANGE is N, LO-HI (LO, 2*LO, 4*LO, ... HI) or LO-HI+STEP (LO, LO+STEP, ... HI).\n"
+        "Throughput runs every producer/consumer combination of the two ranges.\n"
+        "csv and json apply to the throughput section, which is then the default.\n"
+        "The exit status is 1 when a configuration regressed against the baseline.\n"
+        "Sections:",
+        prog
+    );
+    for (size_t i = 0; i < sizeof(SECTIONS) / sizeof(SECTIONS[0]); ++i) {
+        fprintf(out, " %s", SECTIONS[i].name);
+    }
+    fprintf(out, "\n");
+}
+
+static bool
+parse_count(char const *text, uint64_t *value) {
+    char              *end;
+    unsigned long long n = strtoull(text, &end, 10);
+    switch (*end) {
+    case 'k':
+    case 'K':
+        n *= 1000;
+        end++;
+        break;
+    case 'm':
+    case 'M':
+        n *= 1000000;
+        end++;
+        break;
+    case 'g':
+    case 'G':
+        n *= 1000000000;
+        end++;
+        break;
+    default:
+        break;
+    }
+    if (end == text || *end != '\0' || n == 0) {
+        return false;
+    }
+    *value = n;
+    return true;
+}
+
+static bool
+parse_sweep(char const *text, sweep_t *sweep) {
+    int lo, hi, step;
+    int consumed = 0;
+    if (sscanf(text, "%d-%d+%d%n", &lo, &hi, &step, &consumed) == 3 && text[consumed] == '\0') {
+        *sweep = (sweep_t) {lo, hi, step};
+    } else if (sscanf(text, "%d-%d%n", &lo, &hi, &consumed) == 2 && text[consumed] == '\0') {
+        *sweep = (sweep_t) {lo, hi, 0};
+    } else if (sscanf(text, "%d%n", &lo, &consumed) == 1 && text[consumed] == '\0') {
+        *sweep = (sweep_t) {lo, lo, 0};
+    } else {
+        return false;
+    }
+    return sweep->lo > 0 && sweep->hi >= sweep->lo && sweep->step >= 0;
+}
+
+static bool
+section_selected(char const *name) {
+    if (strcmp(g_options.sections, "all") == 0) {
+        return true;
+    }
+    size_t const len = strlen(name);
+    for (char const *p = g_options.sections; *p != '\0';) {
+        size_t const n = strcspn(p, ",");
+        if (n == len && strncmp(p, name, n) == 0) {
+            return true;
+        }
+        p += n + (p[n] == ',');
+    }
+    return false;
+}
+
+// Long-only options.
+enum {
+    OPT_DISCARD = 256,
+    OPT_BASELINE,
+    OPT_SAVE_BASELINE,
+    OPT_THRESHOLD,
+    OPT_COUNTERS,
+    OPT_HITM_EVENT,
+    OPT_PAYLOAD_SIZES,
+    OPT_YIELD_PROB,
+    OPT_BURST,
+    OPT_BURSTS,
+    OPT_SAMPLE_MS,
+};
+
+static bool
+parse_int(char const *text, int min, int *value) {
+    char     *end;
+    long const n = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || n < min || n > INT32_MAX) {
+        return false;
+    }
+    *value = (int) n;
+    return true;
+}
+
+// Payload sizes are checksummed in 8-byte words.
+static bool
+parse_payload_sizes(char const *text) {
+    while (true) {
+        char               *end;
+        unsigned long const size = strtoul(text, &end, 10);
+        if (end == text || size % sizeof(uint64_t) != 0 || size > (1 << 20)) {
+            return false;
+        }
+        if (*end == '\0') {
+            return true;
+        }
+        if (*end != ',') {
+            return false;
+        }
+        text = end + 1;
+    }
+}
+
+// ITEMS,ON_MS,OFF_MS, e.g. 1m,100,300.
+static bool
+parse_burst(char const *text) {
+    char               items[32];
+    unsigned long long on, off;
+    int                consumed = 0;
+    if (sscanf(text, "%31[^,],%llu,%llu%n", items, &on, &off, &consumed) != 3 || text[consumed] != '\0') {
+        return false;
+    }
+    g_options.burst_on_ms  = on;
+    g_options.burst_off_ms = off;
+    return parse_count(items, &g_options.burst_items) && on > 0;
+}
+
+static void
+parse_options(int argc, char **argv) {
+    static struct option const long_options[] = {
+        {"producers",     required_argument, nullptr, 'p'              },
+        {"consumers",     required_argument, nullptr, 'c'              },
+        {"items",         required_argument, nullptr, 'n'              },
+        {"affinity",      required_argument, nullptr, 'a'              },
+        {"warmup-ms",     required_argument, nullptr, 'w'              },
+        {"format",        required_argument, nullptr, 'f'              },
+        {"sections",      required_argument, nullptr, 's'              },
+        {"trials",        required_argument, nullptr, 'r'              },
+        {"discard",       required_argument, nullptr, OPT_DISCARD      },
+        {"baseline",      required_argument, nullptr, OPT_BASELINE     },
+        {"save-baseline", required_argument, nullptr, OPT_SAVE_BASELINE},
+        {"threshold",     required_argument, nullptr, OPT_THRESHOLD    },
+        {"counters",      no_argument,       nullptr, OPT_COUNTERS     },
+        {"hitm-event",    required_argument, nullptr, OPT_HITM_EVENT   },
+        {"payload-sizes", required_argument, nullptr, OPT_PAYLOAD_SIZES},
+        {"yield-prob",    required_argument, nullptr, OPT_YIELD_PROB   },
+        {"burst",         required_argument, nullptr, OPT_BURST        },
+        {"bursts",        required_argument, nullptr, OPT_BURSTS       },
+        {"sample-ms",     required_argument, nullptr, OPT_SAMPLE_MS    },
+        {"help",          no_argument,       nullptr, 'h'              },
+        {nullptr,         0,                 nullptr, 0                },
+    };
+
+    bool sections_given = false;
+    int  opt, index = -1;
+    while ((opt = getopt_long(argc, argv, "p:c:n:a:w:f:s:r:h", long_options, &index)) != -1) {
+        bool ok = true;
+        switch (opt) {
+        case 'p':
+            ok = parse_sweep(optarg, &g_options.producers);
+            break;
+        case 'c':
+            ok = parse_sweep(optarg, &g_options.consumers);
+            break;
+        case 'n':
+            ok = parse_count(optarg, &g_options.items);
+            break;
+        case 'a':
+            ok = bench_parse_affinity(optarg, &g_options.affinity);
+            break;
+        case 'w': {
+            char *end;
+            g_options.warmup_ms = strtoull(optarg, &end, 10);
+            ok                  = end != optarg && *end == '\0';
+            break;
+        }
+        case 'f':
+            if (strcmp(optarg, "text") == 0) {
+                g_options.format = FORMAT_TEXT;
+            } else if (strcmp(optarg, "csv") == 0) {
+                g_options.format = FORMAT_CSV;
+            } else if (strcmp(optarg, "json") == 0) {
+                g_options.format = FORMAT_JSON;
+            } else {
+                ok = false;
+            }
+            break;
+        case 's':
+            g_options.sections = optarg;
+            sections_given     = true;
+            break;
+        case 'r':
+            ok = parse_int(optarg, 1, &g_options.trials);
+            break;
+        case OPT_DISCARD:
+            ok = parse_int(optarg, 0, &g_options.discard);
+            break;
+        case OPT_BASELINE:
+            g_options.baseline = optarg;
+            break;
+        case OPT_SAVE_BASELINE:
+            g_options.save_baseline = optarg;
+            break;
+        case OPT_THRESHOLD: {
+            char *end;
+            g_options.threshold_pct = strtod(optarg, &end);
+            ok                      = end != optarg && *end == '\0' && g_options.threshold_pct >= 0;
+            break;
+        }
+        case OPT_COUNTERS:
+            g_options.counters = true;
+            break;
+        case OPT_YIELD_PROB: {
+            char *end;
+            g_options.yield_prob = strtod(optarg, &end);
+            ok = end != optarg && *end == '\0' && g_options.yield_prob > 0 && g_options.yield_prob < 1;
+            break;
+        }
+        case OPT_BURST:
+            ok = parse_burst(optarg);
+            break;
+        case OPT_BURSTS:
+            ok = parse_int(optarg, 1, &g_options.bursts);
+            break;
+        case OPT_SAMPLE_MS: {
+            char *end;
+            g_options.sample_ms = strtoull(optarg, &end, 10);
+            ok                  = end != optarg && *end == '\0' && g_options.sample_ms > 0;
+            break;
+        }
+        case OPT_PAYLOAD_SIZES:
+            g_options.payload_sizes = optarg;
+            ok                      = parse_payload_sizes(optarg);
+            break;
+        case OPT_HITM_EVENT: {
+            char *end;
+            g_options.hitm_event = strtoull(optarg, &end, 0);
+            g_options.counters   = true;
+            ok                   = end != optarg && *end == '\0';
+            break;
+        }
+        case 'h':
+            usage(stdout, argv[0]);
+            exit(EXIT_SUCCESS);
+        default:
+            usage(stderr, argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        if (!ok) {
+            if (index >= 0) {
+                fprintf(stderr, "%s: invalid argument '%s' for --%s\n", argv[0], optarg, long_options[index].name);
+            } else {
+                fprintf(stderr, "%s: invalid argument '%s' for -%c\n", argv[0], optarg, opt);
+            }
+            exit(EXIT_FAILURE);
+        }
+        index = -1;
+    }
+    if (optind < argc) {
+        usage(stderr, argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // Trials and counters, like csv and json, only exist for the throughput sweep.
+    if (g_options.format != FORMAT_TEXT || trials_mode() || g_options.counters) {
+        if (!sections_given) {
+            g_options.sections = "throughput";
+        } else if (strcmp(g_options.sections, "throughput") != 0) {
+            fprintf(
+                stderr, "%s: csv, json, trial and counter options only apply to the throughput section\n", argv[0]
+            );
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (g_options.counters && trials_mode()) {
+        fprintf(stderr, "%s: --counters cannot be combined with trial options\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    bool any = false;
+    for (size_t i = 0; i < sizeof(SECTIONS) / sizeof(SECTIONS[0]); ++i) {
+        any = any || section_selected(SECTIONS[i].name);
+    }
+    if (!any) {
+        fprintf(stderr, "%s: no known section in '%s'\n", argv[0], g_options.sections);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int
+main(int argc, char **argv) {
+    parse_options(argc, argv);
+    g_num_cpus = bench_cpu_order(g_options.affinity, g_cpus, CPU_SETSIZE);
+
+    // Spin so that frequency scaling has ramped up before the first run.
+    // Progress goes to stderr to keep csv and json output clean.
+    uint64_t const warmup_start = bench_now_ns();
+    uint64_t       dummy        = 0;
+    while (bench_now_ns() - warmup_start < g_options.warmup_ms * 1000000) {
+        for (int i = 0; i < 100000; i++) {
+            dummy = black_box(dummy + i);
+        }
+    }
+    fprintf(stderr, "Warmup finished after %w64u ms.\n", (bench_now_ns() - warmup_start) / 1000000);
+
+    for (size_t i = 0; i < sizeof(SECTIONS) / sizeof(SECTIONS[0]); ++i) {
+        if (section_selected(SECTIONS[i].name)) {
+            SECTIONS[i].run();
+        }
+    }
+    return g_regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -0,0 +1,599 @@
+#define _GNU_SOURCE
+#include "faaq_executor.h"
+
+#include "faaq_inline.h"
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Task records freed by a thread are kept for its next allocations, up to
+// this many.
+constexpr static uint32_t TASK_CACHE_MAX = 1024;
+
+// Flag in FAATaskGroup_t.pending, next to the count: a thread outside the pool
+// is sleeping on the group. Keeping it in the same word lets a finishing task
+// decide whether to wake anyone without touching the group again, since the
+// group may be gone as soon as the count reaches zero.
+constexpr static uint32_t GROUP_WAITING = 1u << 31;
+
+struct FAATask {
+    FAATaskFn_t     fn;
+    void           *arg;
+    FAATaskGroup_t *group;
+    FAATask_t      *next_free;
+};
+
+struct FAADequeBuf {
+    // HP reclamation data; first member so the buffer can be cast back.
+    hazptr_obj_t hp_base;
+    int64_t      mask;
+    _Atomic(FAATask_t *) slots[];
+};
+
+static thread_local FAAWorker_t *tls_worker     = nullptr;
+static thread_local FAATask_t   *tls_free_tasks = nullptr;
+static thread_local uint32_t     tls_free_count = 0;
+
+// Per-thread xorshift state for victim selection. Lazily seeded.
+static thread_local uint64_t     tls_rng        = 0;
+
+static inline uint64_t
+rng_next(int index) {
+    uint64_t x = tls_rng;
+    if (x == 0) {
+        // splitmix64 of the index and the state's address: distinct per thread.
+        x = ((uint64_t) (uintptr_t) &tls_rng ^ (uint64_t) index) + 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        if (x == 0) {
+            x = 1;
+        }
+    }
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    tls_rng = x;
+    return x;
+}
+
+// Counters are written only by their worker, so a load and a store do.
+static inline void
+counter_inc(_Atomic(uint64_t) *c) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+static inline void
+futex_wait(_Atomic(uint32_t) *addr, uint32_t expected) {
+    syscall(SYS_futex, (uint32_t *) addr, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+// Returns the number of threads woken.
+static inline long
+futex_wake(_Atomic(uint32_t) *addr, int count) {
+    return syscall(SYS_futex, (uint32_t *) addr, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// --- Task Records ---
+
+static FAATask_t *
+task_alloc(FAATaskFn_t fn, void *arg, FAATaskGroup_t *group) {
+    FAATask_t *task = tls_free_tasks;
+    if (task) {
+        tls_free_tasks = task->next_free;
+        tls_free_count--;
+    } else {
+        task = malloc(sizeof(FAATask_t));
+        if (!task) {
+            return nullptr;
+        }
+    }
+    task->fn    = fn;
+    task->arg   = arg;
+    task->group = group;
+    return task;
+}
+
+static void
+task_free(FAATask_t *task) {
+    if (tls_free_count >= TASK_CACHE_MAX) {
+        free(task);
+        return;
+    }
+    task->next_free = tls_free_tasks;
+    tls_free_tasks  = task;
+    tls_free_count++;
+}
+
+static void
+task_cache_clear(void) {
+    while (tls_free_tasks) {
+        FAATask_t *next = tls_free_tasks->next_free;
+        free(tls_free_tasks);
+        tls_free_tasks = next;
+    }
+    tls_free_count = 0;
+}
+
+// --- Chase-Lev Deque ---
+//
+// Follows Lê, Pop, Cohen and Zappa Nardelli, "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (PPoPP 2013), with hazard pointers
+// keeping a replaced buffer alive for thieves still reading from it.
+
+static FAADequeBuf_t *
+deque_buf_create(int64_t capacity) {
+    FAADequeBuf_t *buf = malloc(sizeof(FAADequeBuf_t) + (size_t) capacity * sizeof(_Atomic(FAATask_t *)));
+    if (!buf) {
+        return nullptr;
+    }
+    buf->mask = capacity - 1;
+    return buf;
+}
+
+static void
+deque_buf_reclaim(hazptr_obj_t *obj) {
+    // The hp_base object is the first member, so casting is safe.
+    free((FAADequeBuf_t *) obj);
+}
+
+static bool
+deque_init(FAADeque_t *dq) {
+    FAADequeBuf_t *buf = deque_buf_create(FAA_DEQUE_INITIAL_CAPACITY);
+    if (!buf) {
+        return false;
+    }
+    atomic_init(&dq->top, 0);
+    atomic_init(&dq->bottom, 0);
+    atomic_init(&dq->buf, buf);
+    return true;
+}
+
+// Owner only.
+static bool
+deque_push(FAADeque_t *dq, FAATask_t *task) {
+    int64_t const  b   = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+    int64_t const  t   = atomic_load_explicit(&dq->top, memory_order_acquire);
+    FAADequeBuf_t *buf = atomic_load_explicit(&dq->buf, memory_order_relaxed);
+
+    if (b - t > buf->mask) {
+        FAADequeBuf_t *bigger = deque_buf_create(2 * (buf->mask + 1));
+        if (!bigger) {
+            return false;
+        }
+        for (int64_t i = t; i < b; i++) {
+            FAATask_t *moved = atomic_load_explicit(&buf->slots[i & buf->mask], memory_order_relaxed);
+            atomic_store_explicit(&bigger->slots[i & bigger->mask], moved, memory_order_relaxed);
+        }
+        atomic_store_explicit(&dq->buf, bigger, memory_order_release);
+        // Thieves that loaded the old buffer may still be reading it.
+        hazptr_retire(&buf->hp_base, deque_buf_reclaim);
+        buf = bigger;
+    }
+
+    atomic_store_explicit(&buf->slots[b & buf->mask], task, memory_order_relaxed);
+    // Publishes the slot and the task record to thieves. The paper's release
+    // fence plus relaxed store, as a release store.
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_release);
+    return true;
+}
+
+// Owner only. Takes the most recently pushed task.
+static FAATask_t *
+deque_pop(FAADeque_t *dq) {
+    int64_t const  b   = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+    FAADequeBuf_t *buf = atomic_load_explicit(&dq->buf, memory_order_relaxed);
+    atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&dq->top, memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+        return nullptr;
+    }
+    FAATask_t *task = atomic_load_explicit(&buf->slots[b & buf->mask], memory_order_relaxed);
+    if (t == b) {
+        // Last task: thieves may be after it too.
+        if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            task = nullptr;
+        }
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+// Any thread. Takes the oldest task, or returns nullptr if the deque looked
+// empty or another thread took that task first.
+static FAATask_t *
+deque_steal(FAADeque_t *dq, hazptr_holder_t *h) {
+    int64_t t = atomic_load_explicit(&dq->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t const b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+
+    FAADequeBuf_t *buf;
+    HAZPTR_PROTECT(buf, h, &dq->buf);
+    FAATask_t *task = atomic_load_explicit(&buf->slots[t & buf->mask], memory_order_relaxed);
+    hazptr_reset(h, nullptr);
+
+    if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return nullptr;
+    }
+    return task;
+}
+
+static inline bool
+deque_looks_empty(FAADeque_t *dq) {
+    return atomic_load_explicit(&dq->top, memory_order_acquire)
+        >= atomic_load_explicit(&dq->bottom, memory_order_acquire);
+}
+
+// --- Parking ---
+
+static bool
+has_work(FAAExecutor_t *ex, FAAWorker_t *w) {
+    if (!faa_queue_is_empty(ex->inject, w->index)) {
+        return true;
+    }
+    for (int i = 0; i < ex->num_workers; i++) {
+        if (!deque_looks_empty(&ex->workers[i].deque)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void
+park(FAAWorker_t *w) {
+    FAAExecutor_t *ex    = w->ex;
+    uint32_t const epoch = atomic_load_explicit(&ex->epoch, memory_order_acquire);
+    atomic_fetch_add_explicit(&ex->sleepers, 1, memory_order_seq_cst);
+    // Work submitted before the increment is seen here; a submitter that
+    // comes later sees the sleeper and bumps the epoch.
+    if (!has_work(ex, w) && !atomic_load_explicit(&ex->shutdown, memory_order_seq_cst)) {
+        counter_inc(&w->parked);
+        futex_wait(&ex->epoch, epoch);
+    }
+    atomic_fetch_sub_explicit(&ex->sleepers, 1, memory_order_relaxed);
+    // Whether or not this worker is the one woken, it is about to look for
+    // work, so the next submission may wake another. Work enqueued before a
+    // submitter found 'waking' set is seen by that search.
+    atomic_store_explicit(&ex->waking, false, memory_order_seq_cst);
+}
+
+static inline void
+wake_one(FAAExecutor_t *ex) {
+    if (atomic_load_explicit(&ex->waking, memory_order_relaxed)
+        || atomic_exchange_explicit(&ex->waking, true, memory_order_seq_cst)) {
+        return;
+    }
+    atomic_fetch_add_explicit(&ex->epoch, 1, memory_order_release);
+    if (futex_wake(&ex->epoch, 1) <= 0) {
+        // The sleepers seen by the caller left park before the wake-up, and
+        // only a woken worker clears 'waking'; left set, it would suppress
+        // every later wake-up. A worker still on its way into futex_wait
+        // sees the epoch change, returns, and clears it too.
+        atomic_store_explicit(&ex->waking, false, memory_order_seq_cst);
+    }
+}
+
+// After an injection. A missed wake-up could leave the task with every worker
+// asleep, so the enqueue must be ordered before the sleeper check.
+static inline void
+wake_after_inject(FAAExecutor_t *ex) {
+    faa_fence_after_enqueue(FAA_TOPOLOGY_MPMC);
+    if (atomic_load_explicit(&ex->sleepers, memory_order_relaxed) != 0) {
+        wake_one(ex);
+    }
+}
+
+// After a spawn. No fence: the spawning worker runs its own deque anyway, so
+// a wake-up missed in the race with a parking worker costs parallelism, not
+// progress, and spawns are too frequent to pay for a full fence each.
+static inline void
+wake_after_spawn(FAAExecutor_t *ex) {
+    if (atomic_load_explicit(&ex->sleepers, memory_order_relaxed) != 0) {
+        wake_one(ex);
+    }
+}
+
+// After taking a task from the injection queue or another worker's deque. Only
+// one wake-up is in flight at a time, so a burst submitted before the woken
+// worker got here may have skipped its wake-ups; waking the next sleeper while
+// work is left chains them until the burst is spread over the pool.
+static inline void
+wake_if_more_work(FAAWorker_t *w) {
+    FAAExecutor_t *ex = w->ex;
+    if (atomic_load_explicit(&ex->sleepers, memory_order_relaxed) != 0 && has_work(ex, w)) {
+        wake_one(ex);
+    }
+}
+
+// --- Workers ---
+
+static FAATask_t *
+steal_task(FAAWorker_t *w) {
+    FAAExecutor_t *ex = w->ex;
+    int const      n  = ex->num_workers;
+    if (n == 1) {
+        return nullptr;
+    }
+    for (int round = 0; round < FAA_EXECUTOR_STEAL_ROUNDS; round++) {
+        int const start = (int) (rng_next(w->index) % (uint64_t) n);
+        for (int i = 0; i < n; i++) {
+            int const victim = (start + i) % n;
+            if (victim == w->index) {
+                continue;
+            }
+            FAATask_t *task = deque_steal(&ex->workers[victim].deque, &w->steal_hp);
+            if (task) {
+                counter_inc(&w->stolen);
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+// Own deque first, then the injection queue, then other workers' deques.
+static FAATask_t *
+find_task(FAAWorker_t *w) {
+    FAATask_t *task = deque_pop(&w->deque);
+    if (task) {
+        return task;
+    }
+    task = faa_queue_dequeue_inline(w->ex->inject, w->index);
+    if (task) {
+        counter_inc(&w->injected);
+        wake_if_more_work(w);
+        return task;
+    }
+    task = steal_task(w);
+    if (task) {
+        wake_if_more_work(w);
+    }
+    return task;
+}
+
+static void
+group_done(FAATaskGroup_t *group) {
+    uint32_t const prev = atomic_fetch_sub_explicit(&group->pending, 1, memory_order_seq_cst);
+    if (prev == (GROUP_WAITING | 1)) {
+        // May wake a waiter that already left; futex_wake on a stale address
+        // is harmless.
+        futex_wake(&group->pending, INT_MAX);
+    }
+}
+
+static void
+run_task(FAAWorker_t *w, FAATask_t *task) {
+    FAATaskFn_t const     fn    = task->fn;
+    void *const           arg   = task->arg;
+    FAATaskGroup_t *const group = task->group;
+    task_free(task);
+    fn(arg);
+    counter_inc(&w->executed);
+    if (group) {
+        group_done(group);
+    }
+}
+
+static int
+worker_main(void *arg) {
+    FAAWorker_t   *w  = arg;
+    FAAExecutor_t *ex = w->ex;
+    tls_worker        = w;
+    hazptr_holder_init(&w->steal_hp);
+
+    while (true) {
+        FAATask_t *task = find_task(w);
+        if (task) {
+            run_task(w, task);
+            continue;
+        }
+        if (atomic_load_explicit(&ex->shutdown, memory_order_acquire)) {
+            if (!has_work(ex, w)) {
+                break;
+            }
+            continue;
+        }
+        park(w);
+    }
+
+    hazptr_holder_destroy(&w->steal_hp);
+    task_cache_clear();
+    tls_worker = nullptr;
+    return 0;
+}
+
+// --- Public API ---
+
+// Stops and joins the first 'started' workers and frees the executor.
+static void
+executor_teardown(FAAExecutor_t *ex, int started) {
+    atomic_store_explicit(&ex->shutdown, true, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&ex->epoch, 1, memory_order_release);
+    futex_wake(&ex->epoch, INT_MAX);
+    for (int i = 0; i < started; i++) {
+        thrd_join(ex->workers[i].thread, nullptr);
+    }
+    for (int i = 0; i < ex->num_workers; i++) {
+        free(atomic_load_explicit(&ex->workers[i].deque.buf, memory_order_relaxed));
+    }
+    faa_queue_destroy(ex->inject);
+    free(ex->workers);
+    free(ex);
+}
+
+FAAExecutor_t *
+faa_executor_create(int num_workers, int max_submitters) {
+    if (num_workers <= 0 || max_submitters <= 0) {
+        fprintf(stderr, "C23 FAAQueue Error: num_workers and max_submitters must be > 0.\n");
+        return nullptr;
+    }
+
+    FAAExecutor_t *ex = aligned_alloc(FAA_ALIGNMENT, sizeof(FAAExecutor_t));
+    if (!ex) {
+        return nullptr;
+    }
+    ex->num_workers    = num_workers;
+    ex->max_submitters = max_submitters;
+    atomic_init(&ex->epoch, 0);
+    atomic_init(&ex->sleepers, 0);
+    atomic_init(&ex->waking, false);
+    atomic_init(&ex->shutdown, false);
+
+    // Workers use tids [0, num_workers), submitters the ones after.
+    ex->inject  = faa_queue_create(num_workers + max_submitters);
+    ex->workers = aligned_alloc(FAA_ALIGNMENT, (size_t) num_workers * sizeof(FAAWorker_t));
+    if (!ex->inject || !ex->workers) {
+        faa_queue_destroy(ex->inject);
+        free(ex->workers);
+        free(ex);
+        return nullptr;
+    }
+
+    for (int i = 0; i < num_workers; i++) {
+        FAAWorker_t *w = &ex->workers[i];
+        w->ex          = ex;
+        w->index       = i;
+        atomic_init(&w->executed, 0);
+        atomic_init(&w->spawned, 0);
+        atomic_init(&w->injected, 0);
+        atomic_init(&w->stolen, 0);
+        atomic_init(&w->parked, 0);
+        atomic_init(&w->deque.buf, nullptr);
+    }
+    for (int i = 0; i < num_workers; i++) {
+        if (!deque_init(&ex->workers[i].deque)) {
+            executor_teardown(ex, 0);
+            return nullptr;
+        }
+    }
+    for (int i = 0; i < num_workers; i++) {
+        if (thrd_create(&ex->workers[i].thread, worker_main, &ex->workers[i]) != thrd_success) {
+            fprintf(stderr, "C23 FAAQueue Error: Failed to start worker %d.\n", i);
+            executor_teardown(ex, i);
+            return nullptr;
+        }
+    }
+    return ex;
+}
+
+void
+faa_executor_destroy(FAAExecutor_t *ex) {
+    if (!ex) {
+        return;
+    }
+    executor_teardown(ex, ex->num_workers);
+}
+
+bool
+faa_executor_submit_in(FAAExecutor_t *ex, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg, int sid) {
+    if (sid < 0 || sid >= ex->max_submitters) {
+        fprintf(stderr, "C23 FAAQueue Error: Invalid submitter ID %d.\n", sid);
+        return false;
+    }
+    FAATask_t *task = task_alloc(fn, arg, group);
+    if (!task) {
+        return false;
+    }
+    // Counted before the task can run and finish.
+    if (group) {
+        atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    }
+    if (!faa_queue_enqueue_inline(ex->inject, task, ex->num_workers + sid)) {
+        if (group) {
+            atomic_fetch_sub_explicit(&group->pending, 1, memory_order_relaxed);
+        }
+        task_free(task);
+        return false;
+    }
+    wake_after_inject(ex);
+    return true;
+}
+
+bool
+faa_executor_submit(FAAExecutor_t *ex, FAATaskFn_t fn, void *arg, int sid) {
+    return faa_executor_submit_in(ex, nullptr, fn, arg, sid);
+}
+
+bool
+faa_executor_spawn_in(FAAExecutor_t *ex, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg) {
+    FAAWorker_t *w = tls_worker;
+    if (!w || w->ex != ex) {
+        fprintf(stderr, "C23 FAAQueue Error: faa_executor_spawn called outside the executor.\n");
+        return false;
+    }
+    FAATask_t *task = task_alloc(fn, arg, group);
+    if (!task) {
+        return false;
+    }
+    if (group) {
+        atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    }
+    if (!deque_push(&w->deque, task)) {
+        if (group) {
+            atomic_fetch_sub_explicit(&group->pending, 1, memory_order_relaxed);
+        }
+        task_free(task);
+        return false;
+    }
+    counter_inc(&w->spawned);
+    wake_after_spawn(ex);
+    return true;
+}
+
+bool
+faa_executor_spawn(FAAExecutor_t *ex, FAATaskFn_t fn, void *arg) {
+    return faa_executor_spawn_in(ex, nullptr, fn, arg);
+}
+
+void
+faa_executor_stats(FAAExecutor_t const *ex, FAAExecutorStats_t *stats) {
+    *stats = (FAAExecutorStats_t) {};
+    for (int i = 0; i < ex->num_workers; i++) {
+        FAAWorker_t const *w  = &ex->workers[i];
+        stats->executed      += atomic_load_explicit(&w->executed, memory_order_relaxed);
+        stats->spawned       += atomic_load_explicit(&w->spawned, memory_order_relaxed);
+        stats->injected      += atomic_load_explicit(&w->injected, memory_order_relaxed);
+        stats->stolen        += atomic_load_explicit(&w->stolen, memory_order_relaxed);
+        stats->parked        += atomic_load_explicit(&w->parked, memory_order_relaxed);
+    }
+}
+
+void
+faa_task_group_init(FAATaskGroup_t *group) {
+    atomic_init(&group->pending, 0);
+}
+
+void
+faa_task_group_wait(FAAExecutor_t *ex, FAATaskGroup_t *group) {
+    FAAWorker_t *w = tls_worker;
+    if (w && w->ex == ex) {
+        // Keep the worker busy: the group's tasks are most likely on our own
+        // deque or being run by thieves.
+        while ((atomic_load_explicit(&group->pending, memory_order_acquire) & ~GROUP_WAITING) != 0) {
+            FAATask_t *task = find_task(w);
+            if (task) {
+                run_task(w, task);
+            } else {
+                faa_cpu_relax();
+            }
+        }
+        return;
+    }
+
+    uint32_t v = atomic_fetch_or_explicit(&group->pending, GROUP_WAITING, memory_order_seq_cst) | GROUP_WAITING;
+    while (v != GROUP_WAITING) {
+        futex_wait(&group->pending, v);
+        v = atomic_load_explicit(&group->pending, memory_order_acquire);
+    }
+    atomic_fetch_and_explicit(&group->pending, ~GROUP_WAITING, memory_order_relaxed);
+}
@@ -0,0 +1,171 @@
+#ifndef FAA_EXECUTOR_H
+#define FAA_EXECUTOR_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+#include "faaq.h"
+#include "hp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Work-stealing thread pool.
+//
+// Tasks submitted from outside the pool go through a shared FAAArrayQueue_t
+// (the injection queue). Tasks spawned by a running task go on the worker's
+// own Chase-Lev deque, where the worker pops them LIFO and idle workers steal
+// them FIFO. A deque grows by copying into a buffer twice the size; the old
+// buffer is retired through hp.c because thieves may still be reading it.
+// Workers that find no work park on a futex and are woken by the next
+// submission.
+
+// Initial capacity of a worker's deque (a power of two).
+constexpr static int64_t  FAA_DEQUE_INITIAL_CAPACITY = 256;
+
+// Steal attempts on random victims before an idle worker parks.
+constexpr static int      FAA_EXECUTOR_STEAL_ROUNDS  = 4;
+
+typedef void (*FAATaskFn_t)(void *arg);
+
+typedef struct FAATask      FAATask_t;
+typedef struct FAADequeBuf  FAADequeBuf_t;
+typedef struct FAAExecutor  FAAExecutor_t;
+
+/**
+ * @brief Chase-Lev deque of tasks. The owner pushes and pops at the bottom,
+ * thieves take from the top.
+ */
+typedef struct {
+    alignas(FAA_ALIGNMENT) _Atomic(int64_t) top;
+    alignas(FAA_ALIGNMENT) _Atomic(int64_t) bottom;
+    _Atomic(FAADequeBuf_t *) buf;
+} FAADeque_t;
+
+/**
+ * @brief Per-worker counters, readable at any time with faa_executor_stats().
+ */
+typedef struct {
+    uint64_t executed; // tasks run by workers
+    uint64_t spawned;  // tasks pushed on a worker's own deque
+    uint64_t injected; // tasks taken from the injection queue
+    uint64_t stolen;   // tasks taken from another worker's deque
+    uint64_t parked;   // times a worker went to sleep
+} FAAExecutorStats_t;
+
+typedef struct {
+    FAADeque_t        deque;
+    FAAExecutor_t    *ex;
+    int               index;
+    thrd_t            thread;
+    // Protects the victim's buffer while stealing.
+    hazptr_holder_t   steal_hp;
+    alignas(FAA_ALIGNMENT) _Atomic(uint64_t) executed;
+    _Atomic(uint64_t) spawned;
+    _Atomic(uint64_t) injected;
+    _Atomic(uint64_t) stolen;
+    _Atomic(uint64_t) parked;
+} FAAWorker_t;
+
+struct FAAExecutor {
+    int              num_workers;
+    int              max_submitters;
+    FAAArrayQueue_t *inject;
+    FAAWorker_t     *workers;
+    // Eventcount for parking: a parking worker registers in 'sleepers', checks
+    // for work once more and waits on 'epoch'; a submitter that sees sleepers
+    // bumps 'epoch' and wakes one. 'waking' is set from a wake-up until a
+    // worker returns from its wait, so a burst of submissions wakes one worker
+    // instead of issuing a futex call each.
+    alignas(FAA_ALIGNMENT) _Atomic(uint32_t) epoch;
+    _Atomic(uint32_t) sleepers;
+    _Atomic(bool)     waking;
+    _Atomic(bool)     shutdown;
+};
+
+/**
+ * @brief Completion counter for a set of tasks (fork/join).
+ *
+ * Initialize with faa_task_group_init(), add tasks with
+ * faa_executor_spawn_in() or faa_executor_submit_in(), and wait with
+ * faa_task_group_wait().
+ */
+typedef struct {
+    // Unfinished tasks. The top bit is set while a thread outside the pool
+    // sleeps on this word.
+    _Atomic(uint32_t) pending;
+} FAATaskGroup_t;
+
+/**
+ * @brief Creates an executor and starts its workers.
+ *
+ * @param num_workers Number of worker threads. Must be > 0.
+ * @param max_submitters Number of threads outside the pool that may call
+ * faa_executor_submit() at the same time. Each uses its own submitter ID in
+ * [0, max_submitters). Must be > 0.
+ * @return A pointer to the new executor, or nullptr on failure.
+ */
+[[nodiscard("Executor creation failure must be handled")]]
+FAAExecutor_t *faa_executor_create(int num_workers, int max_submitters);
+
+/**
+ * @brief Runs every task already submitted, stops the workers and frees the
+ * executor. No thread may submit concurrently.
+ */
+void           faa_executor_destroy(FAAExecutor_t *ex);
+
+/**
+ * @brief Submits a task from a thread outside the pool, through the injection
+ * queue.
+ *
+ * @param sid The caller's submitter ID (0 <= sid < max_submitters).
+ * @return false if the injection queue could not allocate a node or the task
+ * record could not be allocated.
+ */
+bool           faa_executor_submit(FAAExecutor_t *ex, FAATaskFn_t fn, void *arg, int sid);
+
+/**
+ * @brief Spawns a task from a task running on 'ex', onto the calling worker's
+ * own deque.
+ *
+ * @return false if called outside a worker of 'ex' or out of memory.
+ */
+bool           faa_executor_spawn(FAAExecutor_t *ex, FAATaskFn_t fn, void *arg);
+
+/**
+ * @brief faa_executor_submit() for a task that belongs to 'group'.
+ */
+bool           faa_executor_submit_in(FAAExecutor_t *ex, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg, int sid);
+
+/**
+ * @brief faa_executor_spawn() for a task that belongs to 'group'.
+ */
+bool           faa_executor_spawn_in(FAAExecutor_t *ex, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg);
+
+/**
+ * @brief Sums the per-worker counters into 'stats'.
+ */
+void           faa_executor_stats(FAAExecutor_t const *ex, FAAExecutorStats_t *stats);
+
+/**
+ * @brief Initializes an empty task group.
+ */
+void           faa_task_group_init(FAATaskGroup_t *group);
+
+/**
+ * @brief Waits until every task of 'group' has finished.
+ *
+ * A worker of 'ex' runs other tasks while it waits. Any other thread sleeps
+ * on the group's futex.
+ */
+void           faa_task_group_wait(FAAExecutor_t *ex, FAATaskGroup_t *group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAA_EXECUTOR_H
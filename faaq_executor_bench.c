@@ -0,0 +1,409 @@
+#define _GNU_SOURCE
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "bench_common.h"
+#include "faaq_executor.h"
+
+// Task throughput: the work-stealing executor versus a thread pool sharing one
+// mutex-protected task list. Three workloads:
+//  - fib: recursive fork/join, every task spawned from inside the pool;
+//  - map: an array transformed in chunks, every chunk submitted from main;
+//  - inject: several outside threads submitting tiny tasks at once.
+
+static constexpr int      FIB_N             = 30;
+static constexpr int      FIB_CUTOFF        = 12;
+
+static constexpr size_t   MAP_ELEMENTS      = 1u << 24;
+static constexpr size_t   MAP_CHUNK         = 1024;
+static constexpr size_t   MAP_TASKS         = MAP_ELEMENTS / MAP_CHUNK;
+
+static constexpr int      INJECT_THREADS    = 4;
+static constexpr uint32_t INJECT_PER_THREAD = 500000;
+
+static int const          WORKER_COUNTS[]   = {1, 2, 4, 8};
+
+typedef struct {
+    char const *name;
+    void *(*create)(int workers, int submitters);
+    void (*destroy)(void *pool);
+    bool (*submit_in)(void *pool, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg, int sid);
+    bool (*spawn_in)(void *pool, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg);
+    void (*wait)(void *pool, FAATaskGroup_t *group);
+} engine_t;
+
+// --- Executor ---
+
+static void *
+exec_create(int workers, int submitters) {
+    return faa_executor_create(workers, submitters);
+}
+
+static void
+exec_destroy(void *pool) {
+    faa_executor_destroy(pool);
+}
+
+static bool
+exec_submit_in(void *pool, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg, int sid) {
+    return faa_executor_submit_in(pool, group, fn, arg, sid);
+}
+
+static bool
+exec_spawn_in(void *pool, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg) {
+    return faa_executor_spawn_in(pool, group, fn, arg);
+}
+
+static void
+exec_wait(void *pool, FAATaskGroup_t *group) {
+    faa_task_group_wait(pool, group);
+}
+
+// --- Mutex Pool ---
+//
+// One FIFO list under a mutex; idle workers block on a condition variable.
+// Workers waiting on a group run queued tasks meanwhile, like the executor's.
+// Groups reuse FAATaskGroup_t's counter.
+
+typedef struct mutex_task {
+    FAATaskFn_t        fn;
+    void              *arg;
+    FAATaskGroup_t    *group;
+    struct mutex_task *next;
+} mutex_task_t;
+
+typedef struct {
+    mtx_t         lock;
+    cnd_t         work;
+    cnd_t         done;
+    mutex_task_t *head;
+    mutex_task_t *tail;
+    bool          shutdown;
+    int           num_workers;
+    thrd_t       *workers;
+} mutex_pool_t;
+
+static thread_local mutex_pool_t *tls_mutex_pool = nullptr;
+
+static mutex_task_t *
+mutex_take_locked(mutex_pool_t *p) {
+    mutex_task_t *task = p->head;
+    if (task) {
+        p->head = task->next;
+        if (!p->head) {
+            p->tail = nullptr;
+        }
+    }
+    return task;
+}
+
+static void
+mutex_run(mutex_pool_t *p, mutex_task_t *task) {
+    FAATaskGroup_t *const group = task->group;
+    task->fn(task->arg);
+    free(task);
+    if (group && atomic_fetch_sub_explicit(&group->pending, 1, memory_order_acq_rel) == 1) {
+        mtx_lock(&p->lock);
+        cnd_broadcast(&p->done);
+        mtx_unlock(&p->lock);
+    }
+}
+
+static int
+mutex_worker(void *arg) {
+    mutex_pool_t *p = arg;
+    tls_mutex_pool  = p;
+    mtx_lock(&p->lock);
+    while (true) {
+        mutex_task_t *task = mutex_take_locked(p);
+        if (task) {
+            mtx_unlock(&p->lock);
+            mutex_run(p, task);
+            mtx_lock(&p->lock);
+        } else if (p->shutdown) {
+            break;
+        } else {
+            cnd_wait(&p->work, &p->lock);
+        }
+    }
+    mtx_unlock(&p->lock);
+    return 0;
+}
+
+static void *
+mutex_create(int workers, int submitters) {
+    (void) submitters;
+    mutex_pool_t *p = calloc(1, sizeof(mutex_pool_t));
+    p->num_workers  = workers;
+    p->workers      = calloc((size_t) workers, sizeof(thrd_t));
+    mtx_init(&p->lock, mtx_plain);
+    cnd_init(&p->work);
+    cnd_init(&p->done);
+    for (int i = 0; i < workers; i++) {
+        thrd_create(&p->workers[i], mutex_worker, p);
+    }
+    return p;
+}
+
+static void
+mutex_destroy(void *pool) {
+    mutex_pool_t *p = pool;
+    mtx_lock(&p->lock);
+    p->shutdown = true;
+    cnd_broadcast(&p->work);
+    mtx_unlock(&p->lock);
+    for (int i = 0; i < p->num_workers; i++) {
+        thrd_join(p->workers[i], nullptr);
+    }
+    cnd_destroy(&p->done);
+    cnd_destroy(&p->work);
+    mtx_destroy(&p->lock);
+    free(p->workers);
+    free(p);
+}
+
+static bool
+mutex_submit_in(void *pool, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg, int sid) {
+    (void) sid;
+    mutex_pool_t *p    = pool;
+    mutex_task_t *task = malloc(sizeof(mutex_task_t));
+    if (!task) {
+        return false;
+    }
+    *task = (mutex_task_t) {.fn = fn, .arg = arg, .group = group};
+    if (group) {
+        atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    }
+    mtx_lock(&p->lock);
+    if (p->tail) {
+        p->tail->next = task;
+    } else {
+        p->head = task;
+    }
+    p->tail = task;
+    cnd_signal(&p->work);
+    mtx_unlock(&p->lock);
+    return true;
+}
+
+static bool
+mutex_spawn_in(void *pool, FAATaskGroup_t *group, FAATaskFn_t fn, void *arg) {
+    return mutex_submit_in(pool, group, fn, arg, 0);
+}
+
+static void
+mutex_wait(void *pool, FAATaskGroup_t *group) {
+    mutex_pool_t *p = pool;
+    mtx_lock(&p->lock);
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) != 0) {
+        mutex_task_t *task = tls_mutex_pool == p ? mutex_take_locked(p) : nullptr;
+        if (task) {
+            mtx_unlock(&p->lock);
+            mutex_run(p, task);
+            mtx_lock(&p->lock);
+        } else {
+            cnd_wait(&p->done, &p->lock);
+        }
+    }
+    mtx_unlock(&p->lock);
+}
+
+static engine_t const ENGINES[] = {
+    {"mutex-pool", mutex_create, mutex_destroy, mutex_submit_in, mutex_spawn_in, mutex_wait},
+    {"executor",   exec_create,  exec_destroy,  exec_submit_in,  exec_spawn_in,  exec_wait },
+};
+
+// --- Workloads ---
+
+static engine_t const *g_engine = nullptr;
+static void           *g_pool   = nullptr;
+
+typedef struct {
+    int      n;
+    uint64_t result;
+} fib_args_t;
+
+static uint64_t
+fib_serial(int n) {
+    return n < 2 ? (uint64_t) n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static void
+fib_task(void *arg) {
+    fib_args_t *f = arg;
+    if (f->n < FIB_CUTOFF) {
+        f->result = fib_serial(f->n);
+        return;
+    }
+    fib_args_t     left  = {.n = f->n - 1};
+    fib_args_t     right = {.n = f->n - 2};
+    FAATaskGroup_t group;
+    faa_task_group_init(&group);
+    g_engine->spawn_in(g_pool, &group, fib_task, &left);
+    fib_task(&right);
+    g_engine->wait(g_pool, &group);
+    f->result = left.result + right.result;
+}
+
+// Number of tasks a fib(n) task creates, itself included: it spawns fib(n - 1)
+// and computes fib(n - 2) in place, spawning all but that call's own task.
+static uint64_t
+fib_task_count(int n) {
+    return n < FIB_CUTOFF ? 1 : fib_task_count(n - 1) + fib_task_count(n - 2);
+}
+
+static float *g_map_data = nullptr;
+
+static void
+map_task(void *arg) {
+    float *chunk = &g_map_data[(uintptr_t) arg * MAP_CHUNK];
+    for (size_t i = 0; i < MAP_CHUNK; i++) {
+        chunk[i] = chunk[i] * 1.0001f + 0.5f;
+    }
+}
+
+static void
+noop_task(void *arg) {
+    (void) arg;
+}
+
+typedef struct {
+    int              sid;
+    bench_barrier_t *barrier;
+    FAATaskGroup_t  *group;
+} inject_arg_t;
+
+static int
+inject_thread(void *arg) {
+    inject_arg_t *a = arg;
+    bench_barrier_wait(a->barrier);
+    for (uint32_t i = 0; i < INJECT_PER_THREAD; i++) {
+        g_engine->submit_in(g_pool, a->group, noop_task, nullptr, a->sid);
+    }
+    return 0;
+}
+
+// Each returns the number of tasks it ran.
+
+static uint64_t
+run_fib(void) {
+    fib_args_t     root = {.n = FIB_N};
+    FAATaskGroup_t group;
+    faa_task_group_init(&group);
+    g_engine->submit_in(g_pool, &group, fib_task, &root, 0);
+    g_engine->wait(g_pool, &group);
+    if (root.result != fib_serial(FIB_N)) {
+        fprintf(stderr, "%s: wrong fib result.\n", g_engine->name);
+        exit(EXIT_FAILURE);
+    }
+    return fib_task_count(FIB_N);
+}
+
+static uint64_t
+run_map(void) {
+    FAATaskGroup_t group;
+    faa_task_group_init(&group);
+    for (uintptr_t i = 0; i < MAP_TASKS; i++) {
+        g_engine->submit_in(g_pool, &group, map_task, (void *) i, 0);
+    }
+    g_engine->wait(g_pool, &group);
+    return MAP_TASKS;
+}
+
+static uint64_t
+run_inject(void) {
+    FAATaskGroup_t  group;
+    bench_barrier_t barrier;
+    thrd_t          threads[INJECT_THREADS];
+    inject_arg_t    args[INJECT_THREADS];
+    faa_task_group_init(&group);
+    if (!bench_barrier_init(&barrier, INJECT_THREADS)) {
+        fprintf(stderr, "Failed to create barrier.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < INJECT_THREADS; i++) {
+        args[i] = (inject_arg_t) {.sid = i, .barrier = &barrier, .group = &group};
+        if (thrd_create(&threads[i], inject_thread, &args[i]) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < INJECT_THREADS; i++) {
+        thrd_join(threads[i], nullptr);
+    }
+    g_engine->wait(g_pool, &group);
+    bench_barrier_destroy(&barrier);
+    return (uint64_t) INJECT_THREADS * INJECT_PER_THREAD;
+}
+
+typedef struct {
+    char const *name;
+    uint64_t (*run)(void);
+} workload_t;
+
+static workload_t const WORKLOADS[] = {
+    {"fib",    run_fib   },
+    {"map",    run_map   },
+    {"inject", run_inject},
+};
+
+// Returns throughput in million tasks per second.
+static double
+run_once(engine_t const *engine, workload_t const *workload, int workers) {
+    g_engine = engine;
+    g_pool   = engine->create(workers, INJECT_THREADS);
+    if (!g_pool) {
+        fprintf(stderr, "Failed to create %s.\n", engine->name);
+        exit(EXIT_FAILURE);
+    }
+    uint64_t const start   = bench_now_ns();
+    uint64_t const tasks   = workload->run();
+    uint64_t const elapsed = bench_now_ns() - start;
+    engine->destroy(g_pool);
+    g_pool = nullptr;
+    return (double) tasks * 1e3 / (double) elapsed;
+}
+
+int
+main(void) {
+    size_t const n_counts  = sizeof(WORKER_COUNTS) / sizeof(WORKER_COUNTS[0]);
+    size_t const n_engines = sizeof(ENGINES) / sizeof(ENGINES[0]);
+
+    g_map_data             = malloc(MAP_ELEMENTS * sizeof(float));
+    if (!g_map_data) {
+        fprintf(stderr, "Failed to allocate the map array.\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < MAP_ELEMENTS; i++) {
+        g_map_data[i] = (float) i;
+    }
+
+    printf("--- Executor Task Throughput Benchmark ---\n");
+    printf("Online CPUs: %d\n", bench_online_cpus());
+    for (size_t w = 0; w < sizeof(WORKLOADS) / sizeof(WORKLOADS[0]); ++w) {
+        printf("\n--- %s ---\n", WORKLOADS[w].name);
+        printf("%-8s", "Workers");
+        for (size_t e = 0; e < n_engines; ++e) {
+            printf(" %14s", ENGINES[e].name);
+        }
+        printf(" %10s\n", "Speedup");
+
+        for (size_t c = 0; c < n_counts; ++c) {
+            double mtps[n_engines];
+            for (size_t e = 0; e < n_engines; ++e) {
+                mtps[e] = run_once(&ENGINES[e], &WORKLOADS[w], WORKER_COUNTS[c]);
+            }
+            printf("%-8d", WORKER_COUNTS[c]);
+            for (size_t e = 0; e < n_engines; ++e) {
+                printf(" %9.2f Mt/s", mtps[e]);
+            }
+            printf(" %9.2fx\n", mtps[n_engines - 1] / mtps[0]);
+        }
+    }
+
+    free(g_map_data);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "faaq_executor.h"
+
+static constexpr int      EXEC_WORKERS        = 4;
+static constexpr int      EXEC_SUBMITTERS     = 4;
+static constexpr uint32_t TASKS_PER_SUBMITTER = 200000;
+static constexpr uint32_t EXEC_TOTAL_TASKS    = EXEC_SUBMITTERS * TASKS_PER_SUBMITTER;
+
+// Well past FAA_DEQUE_INITIAL_CAPACITY, so a worker's deque grows a few times.
+static constexpr uint32_t SPAWN_FANOUT        = 5000;
+
+// Each burst task blocks for BURST_TASK_SLEEP_NS, long enough for parked
+// workers to be woken and take the rest.
+static constexpr uint32_t BURST_TASKS         = 64;
+static constexpr long     BURST_TASK_SLEEP_NS = 1000000;
+
+static constexpr int      FIB_N               = 25;
+static constexpr int      FIB_CUTOFF          = 10;
+
+static FAAExecutor_t     *g_ex                = nullptr;
+static FAATaskGroup_t     g_group;
+
+static _Atomic(uint8_t)   g_runs[EXEC_TOTAL_TASKS];
+
+static _Atomic(int)       g_burst_workers;
+static thread_local bool  tls_ran_burst       = false;
+
+static void
+check(bool ok, char const *what) {
+    if (!ok) {
+        fprintf(stderr, "FAILED! %s\n", what);
+        abort();
+    }
+}
+
+static void
+mark_task(void *arg) {
+    atomic_fetch_add_explicit(&g_runs[(uintptr_t) arg], 1, memory_order_relaxed);
+}
+
+static void
+check_ran_once(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (atomic_load_explicit(&g_runs[i], memory_order_relaxed) != 1) {
+            fprintf(stderr, "FAILED! Task %u ran %u times\n", i, atomic_load(&g_runs[i]));
+            abort();
+        }
+        atomic_store_explicit(&g_runs[i], 0, memory_order_relaxed);
+    }
+}
+
+// --- Fork/Join ---
+
+typedef struct {
+    int      n;
+    uint64_t result;
+} fib_args_t;
+
+static uint64_t
+fib_serial(int n) {
+    return n < 2 ? (uint64_t) n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static void
+fib_task(void *arg) {
+    fib_args_t *f = arg;
+    if (f->n < FIB_CUTOFF) {
+        f->result = fib_serial(f->n);
+        return;
+    }
+    fib_args_t     left  = {.n = f->n - 1};
+    fib_args_t     right = {.n = f->n - 2};
+    FAATaskGroup_t group;
+    faa_task_group_init(&group);
+    check(faa_executor_spawn_in(g_ex, &group, fib_task, &left), "spawn failed");
+    fib_task(&right);
+    faa_task_group_wait(g_ex, &group);
+    f->result = left.result + right.result;
+}
+
+// Spawns SPAWN_FANOUT children before waiting on any of them.
+static void
+fanout_task(void *arg) {
+    (void) arg;
+    FAATaskGroup_t group;
+    faa_task_group_init(&group);
+    for (uintptr_t i = 0; i < SPAWN_FANOUT; i++) {
+        check(faa_executor_spawn_in(g_ex, &group, mark_task, (void *) i), "spawn failed");
+    }
+    faa_task_group_wait(g_ex, &group);
+}
+
+void
+run_basic_tests(void) {
+    printf("--- Starting Basic Executor Tests ---\n");
+
+    check(faa_executor_create(0, 1) == nullptr, "zero workers accepted");
+    check(faa_executor_create(1, 0) == nullptr, "zero submitters accepted");
+    printf("Test 1 (Invalid Arguments): PASSED\n");
+
+    g_ex = faa_executor_create(EXEC_WORKERS, 1);
+    check(g_ex != nullptr, "create failed");
+
+    faa_task_group_init(&g_group);
+    for (uintptr_t i = 0; i < 1000; i++) {
+        check(faa_executor_submit_in(g_ex, &g_group, mark_task, (void *) i, 0), "submit failed");
+    }
+    faa_task_group_wait(g_ex, &g_group);
+    check_ran_once(1000);
+    printf("Test 2 (Submit and Wait): PASSED\n");
+
+    check(!faa_executor_spawn(g_ex, mark_task, nullptr), "spawn outside the pool accepted");
+    check(!faa_executor_submit(g_ex, mark_task, nullptr, 1), "out-of-range submitter ID accepted");
+    printf("Test 3 (Spawn Outside the Pool Rejected): PASSED\n");
+
+    fib_args_t fib = {.n = FIB_N};
+    faa_task_group_init(&g_group);
+    check(faa_executor_submit_in(g_ex, &g_group, fib_task, &fib, 0), "submit failed");
+    faa_task_group_wait(g_ex, &g_group);
+    check(fib.result == fib_serial(FIB_N), "wrong fib result");
+    printf("Test 4 (Fork/Join Fib): PASSED\n");
+
+    faa_task_group_init(&g_group);
+    check(faa_executor_submit_in(g_ex, &g_group, fanout_task, nullptr, 0), "submit failed");
+    faa_task_group_wait(g_ex, &g_group);
+    check_ran_once(SPAWN_FANOUT);
+    printf("Test 5 (Deque Growth): PASSED\n");
+
+    // Every worker is idle by now and should go to sleep, then wake up for
+    // new work.
+    FAAExecutorStats_t stats;
+    for (int i = 0; i < 1000; i++) {
+        faa_executor_stats(g_ex, &stats);
+        if (stats.parked >= EXEC_WORKERS) {
+            break;
+        }
+        thrd_sleep(&(struct timespec) {.tv_nsec = 1000000}, nullptr);
+    }
+    check(stats.parked >= EXEC_WORKERS, "idle workers did not park");
+    faa_task_group_init(&g_group);
+    check(faa_executor_submit_in(g_ex, &g_group, mark_task, (void *) 0, 0), "submit failed");
+    faa_task_group_wait(g_ex, &g_group);
+    check_ran_once(1);
+    printf("Test 6 (Park and Wake): PASSED\n");
+
+    // Tasks submitted without a group still run before destroy returns.
+    for (uintptr_t i = 0; i < 1000; i++) {
+        check(faa_executor_submit(g_ex, mark_task, (void *) i, 0), "submit failed");
+    }
+    faa_executor_stats(g_ex, &stats);
+    check(stats.executed >= 1000 + 1 + SPAWN_FANOUT, "executed count too low");
+    faa_executor_destroy(g_ex);
+    g_ex = nullptr;
+    check_ran_once(1000);
+    printf("Test 7 (Destroy Drains Pending Tasks): PASSED\n");
+
+    // Replaced deque buffers were retired, not leaked.
+    hazptr_cleanup();
+    check(hazptr_retired_count() == 0, "deque buffers left retired");
+    printf("Test 8 (Deque Buffers Reclaimed): PASSED\n");
+
+    printf("Basic tests finished successfully.\n");
+}
+
+// --- Wake-ups ---
+
+static void
+burst_task(void *arg) {
+    if (!tls_ran_burst) {
+        tls_ran_burst = true;
+        atomic_fetch_add_explicit(&g_burst_workers, 1, memory_order_relaxed);
+    }
+    thrd_sleep(&(struct timespec) {.tv_nsec = BURST_TASK_SLEEP_NS}, nullptr);
+    mark_task(arg);
+}
+
+// A burst submitted while every worker is parked must not be left to the one
+// worker its first submission woke.
+void
+run_burst_test(void) {
+    printf("\n--- Starting Executor Burst Wake-up Test ---\n");
+
+    g_ex = faa_executor_create(EXEC_WORKERS, 1);
+    check(g_ex != nullptr, "create failed");
+    // Let every worker park.
+    thrd_sleep(&(struct timespec) {.tv_nsec = 50000000}, nullptr);
+
+    atomic_store_explicit(&g_burst_workers, 0, memory_order_relaxed);
+    faa_task_group_init(&g_group);
+    for (uintptr_t i = 0; i < BURST_TASKS; i++) {
+        check(faa_executor_submit_in(g_ex, &g_group, burst_task, (void *) i, 0), "submit failed");
+    }
+    faa_task_group_wait(g_ex, &g_group);
+    check_ran_once(BURST_TASKS);
+
+    int const workers = atomic_load_explicit(&g_burst_workers, memory_order_relaxed);
+    printf("Workers that ran the burst: %d of %d\n", workers, EXEC_WORKERS);
+    check(workers > 1, "one worker ran the whole burst");
+    faa_executor_destroy(g_ex);
+    g_ex = nullptr;
+
+    printf("BURST SUCCESS: Parked workers woke to share the burst.\n");
+}
+
+// --- Stress ---
+
+int
+submitter_thread(void *arg) {
+    int const sid = (int) (uintptr_t) arg;
+    for (uint32_t i = 0; i < TASKS_PER_SUBMITTER; i++) {
+        uintptr_t const id = (uintptr_t) sid * TASKS_PER_SUBMITTER + i;
+        check(faa_executor_submit_in(g_ex, &g_group, mark_task, (void *) id, sid), "submit failed");
+        if (i % 50000 == 0) {
+            thrd_yield();
+        }
+    }
+    return 0;
+}
+
+void
+run_stress_test(void) {
+    printf("\n--- Starting Executor Stress Test ---\n");
+    printf("Workers: %d, Submitters: %d\n", EXEC_WORKERS, EXEC_SUBMITTERS);
+
+    g_ex = faa_executor_create(EXEC_WORKERS, EXEC_SUBMITTERS);
+    check(g_ex != nullptr, "create failed");
+    faa_task_group_init(&g_group);
+
+    thrd_t threads[EXEC_SUBMITTERS];
+    for (int sid = 0; sid < EXEC_SUBMITTERS; sid++) {
+        if (thrd_create(&threads[sid], submitter_thread, (void *) (uintptr_t) sid) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", sid);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int sid = 0; sid < EXEC_SUBMITTERS; sid++) {
+        thrd_join(threads[sid], nullptr);
+    }
+    faa_task_group_wait(g_ex, &g_group);
+    check_ran_once(EXEC_TOTAL_TASKS);
+
+    // Fork/join again with the pool warm, several roots at once.
+    fib_args_t fibs[EXEC_WORKERS * 2];
+    faa_task_group_init(&g_group);
+    for (int i = 0; i < EXEC_WORKERS * 2; i++) {
+        fibs[i] = (fib_args_t) {.n = FIB_N};
+        check(faa_executor_submit_in(g_ex, &g_group, fib_task, &fibs[i], 0), "submit failed");
+    }
+    faa_task_group_wait(g_ex, &g_group);
+    for (int i = 0; i < EXEC_WORKERS * 2; i++) {
+        check(fibs[i].result == fib_serial(FIB_N), "wrong fib result");
+    }
+
+    FAAExecutorStats_t stats;
+    faa_executor_stats(g_ex, &stats);
+    printf(
+        "Executed: %w64u, injected: %w64u, spawned: %w64u, stolen: %w64u, parked: %w64u\n",
+        stats.executed,
+        stats.injected,
+        stats.spawned,
+        stats.stolen,
+        stats.parked
+    );
+    check(stats.injected == EXEC_TOTAL_TASKS + EXEC_WORKERS * 2, "injected count");
+    check(stats.executed == stats.injected + stats.spawned, "executed count");
+    faa_executor_destroy(g_ex);
+    g_ex = nullptr;
+
+    printf("EXECUTOR SUCCESS: Every task ran exactly once.\n");
+}
+
+int
+main(void) {
+    run_basic_tests();
+    run_burst_test();
+    run_stress_test();
+
+    printf("\nAll executor tests completed successfully.\n");
+    return EXIT_SUCCESS;
+}
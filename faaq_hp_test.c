@@ -94,7 +94,96 @@ run_basic_tests(void) {
     assert(item == nullptr);
     printf("PASSED\n");
 
+    // Test 4: Approximate size and emptiness across node boundaries.
+    printf("Test 4 (Size/Empty Queries): ");
+    assert(faa_queue_is_empty(q, 0));
+    assert(faa_queue_size_approx(q, 0) == 0);
+
+    for (uint64_t i = 1; i <= boundary_count; i++) {
+        faa_queue_enqueue(q, (void *) (uintptr_t) i, 0);
+        if (faa_queue_size_approx(q, 0) != i) {
+            fprintf(stderr, "FAILED! Expected size %w64u, got %zu\n", i, faa_queue_size_approx(q, 0));
+            assert(false);
+        }
+    }
+    assert(!faa_queue_is_empty(q, 0));
+
+    for (uint64_t i = boundary_count; i > 0; i--) {
+        assert(faa_queue_size_approx(q, 0) == i);
+        item = faa_queue_dequeue(q, 0);
+        assert(item != nullptr);
+    }
+    assert(faa_queue_size_approx(q, 0) == 0);
+    assert(faa_queue_is_empty(q, 0));
+    printf("PASSED\n");
+
+    // Test 5: Peek returns the head without consuming it, across boundaries.
+    printf("Test 5 (Peek): ");
+    assert(faa_queue_peek(q, 0) == nullptr);
+    for (uint64_t i = 1; i <= boundary_count; i++) {
+        faa_queue_enqueue(q, (void *) (uintptr_t) i, 0);
+    }
+    for (uint64_t i = 1; i <= boundary_count; i++) {
+        assert(faa_queue_peek(q, 0) == (void *) (uintptr_t) i);
+        assert(faa_queue_peek(q, 0) == (void *) (uintptr_t) i);
+        item = faa_queue_dequeue(q, 0);
+        assert(item == (void *) (uintptr_t) i);
+    }
+    assert(faa_queue_peek(q, 0) == nullptr);
+    printf("PASSED\n");
+
+    faa_queue_destroy(q);
+
+    // Test 6: Arena-backed nodes are recycled through the arena freelist.
+    printf("Test 6 (Arena Nodes): ");
+    FAAQueueConfig_t arena_config = faa_queue_config_default();
+    arena_config.node_source      = FAA_NODES_ARENA_HUGETLB;
+    q                             = faa_queue_create_ex(1, &arena_config);
+    assert(q != nullptr);
+    for (int round = 0; round < 4; round++) {
+        for (uint64_t i = 1; i <= FAA_BUFFER_SIZE * 8; i++) {
+            faa_queue_enqueue(q, (void *) (uintptr_t) i, 0);
+        }
+        for (uint64_t i = 1; i <= FAA_BUFFER_SIZE * 8; i++) {
+            assert(faa_queue_dequeue(q, 0) == (void *) (uintptr_t) i);
+        }
+    }
+    FAAQueueStats_t stats;
+    faa_queue_stats(q, &stats);
+    assert(stats.arena_chunks >= 1 && stats.arena_hugetlb_chunks <= stats.arena_chunks);
     faa_queue_destroy(q);
+    printf("PASSED\n");
+
+    // Test 7: A memory budget makes enqueue fail once it would need one node
+    // too many, and memory usage tracks live and retired nodes.
+    printf("Test 7 (Memory Budget): ");
+    FAAQueueConfig_t budget_config = faa_queue_config_default();
+    budget_config.memory_budget    = 3 * sizeof(Node_t);
+    q                              = faa_queue_create_ex(1, &budget_config);
+    assert(q != nullptr);
+    uint64_t accepted = 0;
+    while (faa_queue_enqueue(q, (void *) (uintptr_t) (accepted + 1), 0)) {
+        accepted++;
+    }
+    assert(accepted == 3 * FAA_BUFFER_SIZE);
+    FAAQueueMemory_t usage;
+    faa_queue_memory_usage(q, &usage);
+    assert(usage.live_nodes == 3 && usage.retired_nodes == 0);
+    assert(usage.node_bytes == 3 * sizeof(Node_t) && usage.total_bytes > usage.node_bytes);
+    assert(usage.budget_bytes == 3 * sizeof(Node_t) && usage.failed_enqueues == 1);
+    for (uint64_t i = 1; i <= accepted; i++) {
+        assert(faa_queue_dequeue(q, 0) == (void *) (uintptr_t) i);
+    }
+    // The drained nodes are retired but not reclaimed yet; the enqueue that
+    // needs a new node forces the scan that frees them.
+    faa_queue_memory_usage(q, &usage);
+    assert(usage.live_nodes == 3 && usage.retired_nodes == 2);
+    assert(faa_queue_enqueue(q, (void *) (uintptr_t) 1, 0));
+    faa_queue_memory_usage(q, &usage);
+    assert(usage.live_nodes == 2 && usage.retired_nodes == 0 && usage.failed_enqueues == 1);
+    faa_queue_destroy(q);
+    printf("PASSED\n");
+
     printf("Basic tests finished successfully.\n");
 }
 
@@ -197,22 +286,26 @@ consumer_thread(void *arg) {
 }
 
 void
-run_mpmc_test(void) {
+run_mpmc_test(char const *label, FAAQueueConfig_t const *config) {
     printf(
         "\n--- Starting MPMC Concurrent Stress Test (Exactly-Once "
-        "Verification) ---\n"
+        "Verification, %s) ---\n",
+        label
     );
     printf("Producers: %d, Consumers: %d\n", MPMC_PRODUCERS, MPMC_CONSUMERS);
     printf("Items per producer: %w64u, Total items: %w64u\n", ITEMS_PER_PRODUCER, MPMC_TOTAL_ITEMS);
 
     // 1. Initialize the queue.
-    g_mpmc_queue = faa_queue_create(MPMC_TOTAL_THREADS);
+    g_mpmc_queue = faa_queue_create_ex(MPMC_TOTAL_THREADS, config);
     if (!g_mpmc_queue) {
         fprintf(stderr, "Failed to create FAA Array Queue for MPMC test.\n");
         exit(EXIT_FAILURE);
     }
 
     atomic_init(&g_dequeued_count, 0);
+    for (uint64_t i = 0; i < MPMC_TOTAL_ITEMS; ++i) {
+        atomic_store_explicit(&g_verification[i], false, memory_order_relaxed);
+    }
 
     thrd_t producers[MPMC_PRODUCERS];
     thrd_t consumers[MPMC_CONSUMERS];
@@ -273,6 +366,19 @@ run_mpmc_test(void) {
         printf("Total Missing Items: %w64u\n", missing_count);
     }
 
+    FAAQueueStats_t stats;
+    faa_queue_stats(g_mpmc_queue, &stats);
+    printf(
+        "Nodes allocated: %w64u, burned slots: %w64u, waited slots: %w64u\n",
+        stats.nodes_allocated,
+        stats.burned_slots,
+        stats.waited_slots
+    );
+    if (config && config->wait_policy == FAA_WAIT_NONE && stats.waited_slots != 0) {
+        fprintf(stderr, "ERROR: %w64u slots waited on with FAA_WAIT_NONE.\n", stats.waited_slots);
+        success = false;
+    }
+
     printf("Destroying queue...\n");
     if (faa_queue_dequeue(g_mpmc_queue, 0) != nullptr) {
         printf("ERROR: Queue not empty after test completion!\n");
@@ -292,12 +398,383 @@ run_mpmc_test(void) {
     }
 }
 
+// --- Wait Policies ---
+
+// Runs a single-threaded pass through the slow-path counters, then the MPMC
+// stress test, for each wait policy.
+void
+run_wait_policy_tests(void) {
+    static struct {
+        FAAWaitPolicy_t policy;
+        char const     *label;
+    } const policies[] = {
+        {FAA_WAIT_NONE,       "FAA_WAIT_NONE"      },
+        {FAA_WAIT_SPIN,       "FAA_WAIT_SPIN"      },
+        {FAA_WAIT_SPIN_YIELD, "FAA_WAIT_SPIN_YIELD"},
+    };
+    // Not a whole number of nodes, so the last node is partly filled.
+    uint64_t const items = FAA_BUFFER_SIZE * 5 + 17;
+
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+        printf("\n--- Wait Policy %s: Single-Threaded Counters ---\n", policies[p].label);
+        FAAQueueConfig_t config = faa_queue_config_default();
+        config.wait_policy      = policies[p].policy;
+        FAAArrayQueue_t *q      = faa_queue_create_ex(1, &config);
+        assert(q != nullptr);
+        for (uint64_t i = 1; i <= items; i++) {
+            assert(faa_queue_enqueue(q, (void *) (uintptr_t) i, 0));
+        }
+        for (uint64_t i = 1; i <= items; i++) {
+            assert(faa_queue_dequeue(q, 0) == (void *) (uintptr_t) i);
+        }
+        assert(faa_queue_dequeue(q, 0) == nullptr);
+
+        // The initial node takes the first FAA_BUFFER_SIZE items; each node
+        // after it is allocated by the enqueue that finds the tail full.
+        FAAQueueStats_t stats;
+        faa_queue_stats(q, &stats);
+        uint64_t const expected_nodes = 1 + (items - 1) / FAA_BUFFER_SIZE;
+        if (stats.nodes_allocated != expected_nodes || stats.burned_slots != 0 || stats.waited_slots != 0) {
+            fprintf(
+                stderr,
+                "FAILED! nodes_allocated %w64u (expected %w64u), burned_slots %w64u, waited_slots %w64u\n",
+                stats.nodes_allocated,
+                expected_nodes,
+                stats.burned_slots,
+                stats.waited_slots
+            );
+            abort();
+        }
+        faa_queue_destroy(q);
+        printf("Counters: PASSED\n");
+
+        run_mpmc_test(policies[p].label, &config);
+    }
+}
+
+// --- Topology Variants (SPSC, MPSC, SPMC) ---
+
+typedef struct {
+    FAAArrayQueue_t *queue;
+    uint64_t         items_per_producer;
+    uint64_t         total_items;
+} topology_ctx_t;
+
+static topology_ctx_t g_topology;
+
+int
+topology_producer(void *arg) {
+    int const tid = (int) (uintptr_t) arg;
+    for (uint64_t i = 0; i < g_topology.items_per_producer; ++i) {
+        // Encode the global ID + 1 so the item is never nullptr.
+        uint64_t const id = (uint64_t) tid * g_topology.items_per_producer + i;
+        faa_queue_enqueue(g_topology.queue, (void *) (uintptr_t) (id + 1), tid);
+        if (i % 50000 == 0) {
+            thrd_yield();
+        }
+    }
+    return 0;
+}
+
+int
+topology_consumer(void *arg) {
+    int const tid = (int) (uintptr_t) arg;
+
+    // A consumer must see each producer's items in increasing order.
+    uint64_t last_seen[MPMC_PRODUCERS];
+    for (int p = 0; p < MPMC_PRODUCERS; ++p) {
+        last_seen[p] = UINT64_MAX;
+    }
+
+    while (atomic_load_explicit(&g_dequeued_count, memory_order_acquire) < g_topology.total_items) {
+        void *item = faa_queue_dequeue(g_topology.queue, tid);
+        if (item == nullptr) {
+            thrd_yield();
+            continue;
+        }
+
+        uint64_t const id = (uint64_t) (uintptr_t) item - 1;
+        if (id >= g_topology.total_items) {
+            fprintf(stderr, "FATAL ERROR: Consumer %d dequeued invalid ID %w64u\n", tid, id);
+            abort();
+        }
+        uint64_t const producer = id / g_topology.items_per_producer;
+        if (last_seen[producer] != UINT64_MAX && id <= last_seen[producer]) {
+            fprintf(
+                stderr, "FATAL ERROR (Order): Consumer %d saw ID %w64u after %w64u\n", tid, id, last_seen[producer]
+            );
+            abort();
+        }
+        last_seen[producer] = id;
+
+        if (atomic_exchange_explicit(&g_verification[id], true, memory_order_acq_rel)) {
+            fprintf(stderr, "FATAL ERROR (Duplicate): Consumer %d dequeued ID %w64u twice\n", tid, id);
+            abort();
+        }
+        atomic_fetch_add_explicit(&g_dequeued_count, 1, memory_order_acq_rel);
+    }
+    return 0;
+}
+
+void
+run_topology_test(char const *label, FAATopology_t topology, int producers, int consumers) {
+    printf("\n--- Starting %s Stress Test (Producers: %d, Consumers: %d) ---\n", label, producers, consumers);
+    assert(producers <= MPMC_PRODUCERS && producers + consumers <= MPMC_TOTAL_THREADS);
+
+    FAAQueueConfig_t config = faa_queue_config_default();
+    config.topology         = topology;
+
+    g_topology.queue              = faa_queue_create_ex(producers + consumers, &config);
+    g_topology.items_per_producer = ITEMS_PER_PRODUCER;
+    g_topology.total_items        = (uint64_t) producers * ITEMS_PER_PRODUCER;
+    if (!g_topology.queue) {
+        fprintf(stderr, "Failed to create %s queue.\n", label);
+        exit(EXIT_FAILURE);
+    }
+
+    atomic_store(&g_dequeued_count, 0);
+    for (uint64_t i = 0; i < g_topology.total_items; ++i) {
+        atomic_store_explicit(&g_verification[i], false, memory_order_relaxed);
+    }
+
+    thrd_t threads[MPMC_TOTAL_THREADS];
+    for (int tid = 0; tid < producers + consumers; ++tid) {
+        thrd_start_t fn = tid < producers ? topology_producer : topology_consumer;
+        if (thrd_create(&threads[tid], fn, (void *) (uintptr_t) tid) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", tid);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int tid = 0; tid < producers + consumers; ++tid) {
+        thrd_join(threads[tid], nullptr);
+    }
+
+    bool success = atomic_load(&g_dequeued_count) == g_topology.total_items;
+    for (uint64_t i = 0; i < g_topology.total_items && success; ++i) {
+        if (!atomic_load_explicit(&g_verification[i], memory_order_relaxed)) {
+            fprintf(stderr, "ERROR (Missed): Item ID %w64u was never dequeued!\n", i);
+            success = false;
+        }
+    }
+    if (faa_queue_dequeue(g_topology.queue, 0) != nullptr) {
+        fprintf(stderr, "ERROR: Queue not empty after test completion!\n");
+        success = false;
+    }
+    faa_queue_destroy(g_topology.queue);
+
+    if (!success) {
+        printf("%s FAILURE: Queue operation failed verification.\n", label);
+        exit(EXIT_FAILURE);
+    }
+    printf("%s SUCCESS: Exactly-once and per-producer order verified.\n", label);
+}
+
+// --- Peek Under Concurrent Dequeues ---
+
+static constexpr int      PEEK_CONSUMERS = 4;
+static constexpr int      PEEK_PEEKERS   = 2;
+static constexpr uint64_t PEEK_ITEMS     = (uint64_t) FAA_BUFFER_SIZE * 2048;
+
+static _Atomic(bool)      g_peek_done    = false;
+
+int
+peek_producer(void *arg) {
+    (void) arg;
+    for (uint64_t i = 0; i < PEEK_ITEMS; ++i) {
+        faa_queue_enqueue(g_mpmc_queue, (void *) (uintptr_t) (i + 1), 0);
+    }
+    return 0;
+}
+
+int
+peek_consumer(void *arg) {
+    int const tid = (int) (uintptr_t) arg;
+    while (atomic_load_explicit(&g_dequeued_count, memory_order_acquire) < PEEK_ITEMS) {
+        if (faa_queue_dequeue(g_mpmc_queue, tid) != nullptr) {
+            atomic_fetch_add_explicit(&g_dequeued_count, 1, memory_order_acq_rel);
+        }
+    }
+    return 0;
+}
+
+// Peeks while consumers move the head across node boundaries. With a single
+// producer, the items a peeker sees never go backwards.
+int
+peek_thread(void *arg) {
+    int const tid  = (int) (uintptr_t) arg;
+    uint64_t  last = 0;
+    while (!atomic_load_explicit(&g_peek_done, memory_order_acquire)) {
+        uint64_t const v = (uint64_t) (uintptr_t) faa_queue_peek(g_mpmc_queue, tid);
+        if (v == 0) {
+            continue;
+        }
+        if (v > PEEK_ITEMS || v < last) {
+            fprintf(stderr, "FATAL ERROR: Peeker %d saw item %w64u after %w64u\n", tid, v, last);
+            abort();
+        }
+        last = v;
+    }
+    return 0;
+}
+
+void
+run_peek_stress_test(void) {
+    printf("\n--- Starting Peek Stress Test (Consumers: %d, Peekers: %d) ---\n", PEEK_CONSUMERS, PEEK_PEEKERS);
+
+    int const threads_n = 1 + PEEK_CONSUMERS + PEEK_PEEKERS;
+    g_mpmc_queue        = faa_queue_create(threads_n);
+    if (!g_mpmc_queue) {
+        fprintf(stderr, "Failed to create queue for peek test.\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_store(&g_dequeued_count, 0);
+    atomic_store(&g_peek_done, false);
+
+    thrd_t threads[threads_n];
+    for (int tid = 0; tid < threads_n; ++tid) {
+        thrd_start_t fn = tid == 0 ? peek_producer : tid <= PEEK_CONSUMERS ? peek_consumer : peek_thread;
+        if (thrd_create(&threads[tid], fn, (void *) (uintptr_t) tid) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", tid);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int tid = 0; tid <= PEEK_CONSUMERS; ++tid) {
+        thrd_join(threads[tid], nullptr);
+    }
+    atomic_store_explicit(&g_peek_done, true, memory_order_release);
+    for (int tid = PEEK_CONSUMERS + 1; tid < threads_n; ++tid) {
+        thrd_join(threads[tid], nullptr);
+    }
+
+    assert(faa_queue_peek(g_mpmc_queue, 0) == nullptr);
+    faa_queue_destroy(g_mpmc_queue);
+    g_mpmc_queue = nullptr;
+    printf("PEEK SUCCESS: %w64u items across %w64u nodes.\n", PEEK_ITEMS, PEEK_ITEMS / FAA_BUFFER_SIZE);
+}
+
+// --- Memory Budget Under Contention ---
+//
+// Producers take a credit per item and consumers return it, so the queue
+// never holds more than one node's worth of items. The budget leaves room for
+// that, so no enqueue may fail, even when several producers find the tail
+// full at once and only one of them gets the last node of the budget (or
+// frees the retired nodes while the others' scans return at once).
+
+static constexpr int      BUDGET_PRODUCERS = 8;
+static constexpr int      BUDGET_CONSUMERS = 2;
+static constexpr uint64_t BUDGET_NODES     = 4;
+static constexpr uint64_t BUDGET_ITEMS     = (uint64_t) FAA_BUFFER_SIZE * 1024;
+
+static _Atomic(int64_t)   g_budget_credits = 0;
+static _Atomic(uint64_t)  g_budget_failed  = 0;
+
+int
+budget_producer(void *arg) {
+    int const tid = (int) (uintptr_t) arg;
+    for (uint64_t i = 0; i < BUDGET_ITEMS / BUDGET_PRODUCERS; ++i) {
+        int64_t credits = atomic_load_explicit(&g_budget_credits, memory_order_relaxed);
+        do {
+            while (credits <= 0) {
+                thrd_yield();
+                credits = atomic_load_explicit(&g_budget_credits, memory_order_relaxed);
+            }
+        } while (!atomic_compare_exchange_weak_explicit(
+            &g_budget_credits, &credits, credits - 1, memory_order_acquire, memory_order_relaxed
+        ));
+        if (!faa_queue_enqueue(g_mpmc_queue, (void *) (uintptr_t) (i + 1), tid)) {
+            atomic_fetch_add_explicit(&g_budget_failed, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&g_budget_credits, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&g_dequeued_count, 1, memory_order_relaxed);
+        }
+    }
+    return 0;
+}
+
+int
+budget_consumer(void *arg) {
+    int const tid = (int) (uintptr_t) arg;
+    while (atomic_load_explicit(&g_dequeued_count, memory_order_acquire) < BUDGET_ITEMS) {
+        if (faa_queue_dequeue(g_mpmc_queue, tid) != nullptr) {
+            atomic_fetch_add_explicit(&g_dequeued_count, 1, memory_order_acq_rel);
+            atomic_fetch_add_explicit(&g_budget_credits, 1, memory_order_release);
+        }
+    }
+    return 0;
+}
+
+void
+run_budget_stress_test(void) {
+    printf(
+        "\n--- Starting Memory Budget Stress Test (Producers: %d, Consumers: %d, Budget: %w64u nodes) ---\n",
+        BUDGET_PRODUCERS,
+        BUDGET_CONSUMERS,
+        BUDGET_NODES
+    );
+
+    FAAQueueConfig_t config = faa_queue_config_default();
+    config.memory_budget    = BUDGET_NODES * sizeof(Node_t);
+    // Long enough for a producer preempted between taking the last node and
+    // linking it to get the CPU back.
+    config.wait_policy      = FAA_WAIT_SPIN_YIELD;
+    config.yield_limit      = 1024;
+
+    int const threads_n = BUDGET_PRODUCERS + BUDGET_CONSUMERS;
+    g_mpmc_queue        = faa_queue_create_ex(threads_n, &config);
+    if (!g_mpmc_queue) {
+        fprintf(stderr, "Failed to create queue for budget test.\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_store(&g_dequeued_count, 0);
+    atomic_store(&g_budget_credits, FAA_BUFFER_SIZE);
+    atomic_store(&g_budget_failed, 0);
+
+    thrd_t threads[threads_n];
+    for (int tid = 0; tid < threads_n; ++tid) {
+        thrd_start_t fn = tid < BUDGET_PRODUCERS ? budget_producer : budget_consumer;
+        if (thrd_create(&threads[tid], fn, (void *) (uintptr_t) tid) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", tid);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int tid = 0; tid < threads_n; ++tid) {
+        thrd_join(threads[tid], nullptr);
+    }
+
+    FAAQueueMemory_t usage;
+    faa_queue_memory_usage(g_mpmc_queue, &usage);
+    uint64_t const failed = atomic_load(&g_budget_failed);
+    if (failed != 0 || usage.failed_enqueues != 0) {
+        fprintf(stderr, "BUDGET FAILURE: %w64u enqueues failed with room in the queue.\n", failed);
+        exit(EXIT_FAILURE);
+    }
+    faa_queue_destroy(g_mpmc_queue);
+    g_mpmc_queue = nullptr;
+    printf("BUDGET SUCCESS: %w64u items, no enqueue failed.\n", BUDGET_ITEMS);
+}
+
 int
 main(void) {
     printf("C23 FAA Array Queue Example and Test Suite\n\n");
 
     run_basic_tests();
-    run_mpmc_test();
+    run_mpmc_test("default configuration", nullptr);
+
+    FAAQueueConfig_t elim_config = faa_queue_config_default();
+    elim_config.elimination_spin = 256;
+    run_mpmc_test("elimination enabled", &elim_config);
+
+    FAAQueueConfig_t arena_config = faa_queue_config_default();
+    arena_config.node_source      = FAA_NODES_ARENA;
+    run_mpmc_test("arena nodes", &arena_config);
+
+    run_wait_policy_tests();
+
+    run_topology_test("SPSC", FAA_TOPOLOGY_SPSC, 1, 1);
+    run_topology_test("MPSC", FAA_TOPOLOGY_MPSC, MPMC_PRODUCERS, 1);
+    run_topology_test("SPMC", FAA_TOPOLOGY_SPMC, 1, MPMC_CONSUMERS);
+
+    run_peek_stress_test();
+    run_budget_stress_test();
 
     printf("\nAll tests completed successfully.\n");
     return EXIT_SUCCESS;
@@ -0,0 +1,253 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "faaq.hpp"
+
+static constexpr int      HPP_PRODUCERS      = 4;
+static constexpr int      HPP_CONSUMERS      = 4;
+static constexpr uint32_t ITEMS_PER_PRODUCER = 250000;
+
+static constexpr int      HPP_TOTAL_THREADS  = HPP_PRODUCERS + HPP_CONSUMERS;
+static constexpr uint64_t HPP_TOTAL_ITEMS    = uint64_t{HPP_PRODUCERS} * ITEMS_PER_PRODUCER;
+
+static void
+check(bool ok, char const *what) {
+    if (!ok) {
+        fprintf(stderr, "FAILED! %s\n", what);
+        abort();
+    }
+}
+
+// Counts live instances, so that values left in a queue can be seen to be
+// destroyed with it.
+struct tracked {
+    static inline std::atomic<int> live = 0;
+
+    int                            value;
+
+    explicit tracked(int v) : value(v) { live++; }
+    tracked(tracked &&other) noexcept : value(other.value) { live++; }
+    tracked(tracked const &)            = delete;
+    tracked &operator=(tracked const &) = delete;
+    ~tracked() { live--; }
+};
+
+// Three bytes and a padding byte: stored inline.
+struct small {
+    uint16_t a;
+    uint8_t  b;
+};
+
+static_assert(faaq::queue<int>::stores_inline);
+static_assert(faaq::queue<small>::stores_inline);
+static_assert(faaq::queue<int *>::stores_inline);
+static_assert(!faaq::queue<uint64_t>::stores_inline);
+static_assert(faaq::queue<std::unique_ptr<int>>::stores_inline);
+static_assert(faaq::queue<std::unique_ptr<int[]>>::stores_inline);
+static_assert(!faaq::queue<std::unique_ptr<int, void (*)(int *)>>::stores_inline);
+static_assert(!faaq::queue<std::string>::stores_inline);
+
+void
+run_basic_tests() {
+    printf("--- Starting Basic C++ Front-End Tests ---\n");
+    int const count = static_cast<int>(FAA_BUFFER_SIZE) * 3 + 7;
+
+    {
+        faaq::queue<int> q(1);
+        check(!q.pop(0), "pop on an empty queue returned a value");
+        // Zero and negative values must survive the inline encoding.
+        for (int i = -count / 2; i < count / 2; i++) {
+            check(q.push(i, 0), "push failed");
+        }
+        for (int i = -count / 2; i < count / 2; i++) {
+            std::optional<int> v = q.pop(0);
+            check(v && *v == i, "int FIFO order");
+        }
+        check(q.empty(0), "queue not empty");
+    }
+    printf("Test 1 (Inline Values, FIFO Across Nodes): PASSED\n");
+
+    {
+        faaq::queue<small> q(1);
+        for (int i = 0; i < count; i++) {
+            check(q.push(small{static_cast<uint16_t>(i), static_cast<uint8_t>(i * 7)}, 0), "push failed");
+        }
+        for (int i = 0; i < count; i++) {
+            std::optional<small> v = q.pop(0);
+            check(v && v->a == static_cast<uint16_t>(i) && v->b == static_cast<uint8_t>(i * 7), "struct FIFO order");
+        }
+
+        std::vector<long>   storage(64);
+        faaq::queue<long *> p(1);
+        for (auto &x : storage) {
+            check(p.push(&x, 0), "push failed");
+        }
+        for (auto &x : storage) {
+            check(p.pop(0) == &x, "pointer FIFO order");
+        }
+    }
+    printf("Test 2 (Small Structs and Pointers): PASSED\n");
+
+    {
+        faaq::queue<std::unique_ptr<int>> q(1);
+        for (int i = 0; i < count; i++) {
+            check(q.push(std::make_unique<int>(i), 0), "push failed");
+        }
+        for (int i = 0; i < count; i++) {
+            std::optional<std::unique_ptr<int>> v = q.pop(0);
+            check(v && *v && **v == i, "move-only FIFO order");
+        }
+
+        faaq::queue<std::unique_ptr<int[]>> a(1);
+        for (int i = 0; i < count; i++) {
+            auto arr = std::make_unique<int[]>(2);
+            arr[1]   = i;
+            check(a.push(std::move(arr), 0), "push failed");
+            check(arr == nullptr, "pushed handle still owns its pointer");
+        }
+        for (int i = 0; i < count; i++) {
+            std::optional<std::unique_ptr<int[]>> v = a.pop(0);
+            check(v && *v && (*v)[1] == i, "array handle FIFO order");
+        }
+
+        faaq::queue<std::string> s(1);
+        std::string const        long_string(100, 'x');
+        check(s.push(long_string, 0), "push failed");
+        check(s.pop(0) == long_string, "string copy");
+    }
+    printf("Test 3 (Move-Only Handles and Boxed Values): PASSED\n");
+
+    {
+        faaq::queue<tracked> q(1);
+        for (int i = 0; i < 100; i++) {
+            check(q.push(tracked(i), 0), "push failed");
+        }
+        check(tracked::live == 100, "boxed values not live");
+        check(q.pop(0)->value == 0, "tracked FIFO order");
+
+        faaq::queue<std::unique_ptr<tracked>> h(1);
+        for (int i = 0; i < 100; i++) {
+            check(h.push(std::make_unique<tracked>(i), 0), "push failed");
+        }
+        check(tracked::live == 199, "handle values not live");
+        check(h.pop(0).value()->value == 0, "handle FIFO order");
+    }
+    check(tracked::live == 0, "values left in the queue were not destroyed");
+    printf("Test 4 (Destructor Releases Remaining Values): PASSED\n");
+
+    {
+        faaq::queue<int, FAA_BUFFER_SIZE, faaq::policy<faaq::hazard_pointers, faaq::no_wait, FAA_TOPOLOGY_SPSC>> q(2);
+        for (int i = 0; i < count; i++) {
+            check(q.push(i, 0), "push failed");
+        }
+        for (int i = 0; i < count; i++) {
+            check(q.pop(1) == i, "SPSC FIFO order");
+        }
+        check(!q.pop(1), "SPSC queue not empty");
+    }
+    printf("Test 5 (SPSC Policy): PASSED\n");
+
+    {
+        faaq::queue<int> q(2);
+        auto             a = q.get_handle();
+        auto             b = q.get_handle();
+        check(a.tid() != b.tid(), "handles share a tid");
+        bool threw = false;
+        try {
+            (void) q.get_handle();
+        } catch (std::length_error const &) {
+            threw = true;
+        }
+        check(threw, "third handle on a two-thread queue");
+
+        int const freed = b.tid();
+        {
+            auto moved = std::move(b);
+            check(moved.push(42), "push failed");
+        }
+        auto c = q.get_handle();
+        check(c.tid() == freed, "released tid not reused");
+        check(a.pop() == 42, "pop through handle");
+    }
+    printf("Test 6 (Thread ID Handles): PASSED\n");
+
+    printf("Basic tests finished successfully.\n");
+}
+
+// Runs HPP_PRODUCERS producers and HPP_CONSUMERS consumers, each with its own
+// handle, and checks exactly-once delivery and per-producer order. 'make'
+// builds the payload for an item number; 'id' recovers it.
+template <class T, class Make, class Id>
+void
+run_mpmc_test(char const *name, Make make, Id id) {
+    printf("\n--- Starting C++ MPMC Stress Test (%s) ---\n", name);
+    printf("Producers: %d, Consumers: %d\n", HPP_PRODUCERS, HPP_CONSUMERS);
+
+    faaq::queue<T>                       q(HPP_TOTAL_THREADS);
+    std::unique_ptr<std::atomic<bool>[]> seen = std::make_unique<std::atomic<bool>[]>(HPP_TOTAL_ITEMS);
+    std::atomic<uint64_t>                dequeued{0};
+
+    std::vector<std::thread>             threads;
+    for (int p = 0; p < HPP_PRODUCERS; p++) {
+        threads.emplace_back([&, p, h = q.get_handle()]() mutable {
+            for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; i++) {
+                check(h.push(make(uint64_t(p) * ITEMS_PER_PRODUCER + i)), "push failed");
+            }
+        });
+    }
+    for (int c = 0; c < HPP_CONSUMERS; c++) {
+        threads.emplace_back([&, h = q.get_handle()]() mutable {
+            uint64_t last_seen[HPP_PRODUCERS];
+            for (auto &l : last_seen) {
+                l = UINT64_MAX;
+            }
+            while (dequeued.load(std::memory_order_acquire) < HPP_TOTAL_ITEMS) {
+                std::optional<T> v = h.pop();
+                if (!v) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                uint64_t const n = id(*v);
+                check(n < HPP_TOTAL_ITEMS, "invalid item");
+                uint64_t const producer = n / ITEMS_PER_PRODUCER;
+                check(last_seen[producer] == UINT64_MAX || n > last_seen[producer], "per-producer order");
+                last_seen[producer] = n;
+                check(!seen[n].exchange(true, std::memory_order_acq_rel), "item dequeued twice");
+                dequeued.fetch_add(1, std::memory_order_acq_rel);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (uint64_t i = 0; i < HPP_TOTAL_ITEMS; i++) {
+        check(seen[i].load(std::memory_order_relaxed), "item never dequeued");
+    }
+    check(!q.pop(0), "queue not empty after the test");
+    printf("C++ SUCCESS: Exactly-once and per-producer order verified.\n");
+}
+
+int
+main() {
+    run_basic_tests();
+    run_mpmc_test<uint32_t>(
+        "inline uint32_t", [](uint64_t n) { return static_cast<uint32_t>(n); }, [](uint32_t v) { return uint64_t{v}; }
+    );
+    run_mpmc_test<std::unique_ptr<uint64_t>>(
+        "inline std::unique_ptr",
+        [](uint64_t n) { return std::make_unique<uint64_t>(n); },
+        [](std::unique_ptr<uint64_t> const &v) { return *v; }
+    );
+
+    printf("\nAll C++ front-end tests completed successfully.\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+#ifndef FAAQ_INLINE_H
+#define FAAQ_INLINE_H
+
+// Opt-in inline fast paths for faa_queue_enqueue() and faa_queue_dequeue().
+//
+// The common case of each operation (a slot in the current node, and for a
+// dequeue a slot whose item is already there) is compiled into the caller.
+// Everything else goes to the out-of-line paths in faaq.c: node allocation,
+// moving tail or head to the next node and retiring the old one, in-flight
+// slots, elimination, and the single-producer and single-consumer topologies.
+//
+// Arguments are checked with assert(), so the checks disappear with NDEBUG.
+// The exported functions check them in every build.
+
+#include <assert.h>
+
+#include "faaq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// --- Shared Helpers ---
+
+/**
+ * @brief CPU hint for spin-wait loops.
+ */
+static inline void
+faa_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield" ::: "memory");
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+/**
+ * @brief Orders a successful enqueue on a queue of the given topology before
+ * the caller's later loads, as a seq_cst fence would.
+ *
+ * For store-load handshakes that publish an item and then check for sleeping
+ * consumers. A multi-producer enqueue publishes its item with a locked RMW
+ * (the CAS into the slot, or into an elimination slot), which on x86 is
+ * already a full barrier, so only the compiler is fenced there. The
+ * single-producer enqueue publishes with plain release stores and always
+ * needs the fence, as does every enqueue on other architectures.
+ */
+static inline void
+faa_fence_after_enqueue(FAATopology_t topology) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (topology == FAA_TOPOLOGY_MPMC || topology == FAA_TOPOLOGY_MPSC) {
+        atomic_signal_fence(memory_order_seq_cst);
+        return;
+    }
+#else
+    (void) topology;
+#endif
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+// --- Out-of-Line Paths ---
+//
+// Exported for the inline functions below; not meant to be called directly.
+
+/**
+ * @brief faa_queue_enqueue() without argument validation.
+ */
+bool  faa_queue_enqueue_slow(FAAArrayQueue_t *q, void *item, int tid);
+
+/**
+ * @brief faa_queue_dequeue() without argument validation.
+ */
+void *faa_queue_dequeue_slow(FAAArrayQueue_t *q, int tid);
+
+/**
+ * @brief Finishes a multi-consumer dequeue that claimed slot 'idx' of 'lhead'
+ * and found it empty.
+ *
+ * The caller's hazard pointer (holder 'tid') must still protect 'lhead'. The
+ * slot is waited on according to the queue's wait policy; if the producer does
+ * not store its item in time the slot is burned and the dequeue starts over.
+ */
+void *faa_queue_dequeue_claimed_slow(FAAArrayQueue_t *q, int tid, Node_t *lhead, size_t idx);
+
+// --- Fast Paths ---
+
+/**
+ * @brief Inline equivalent of faa_queue_enqueue().
+ */
+static inline bool
+faa_queue_enqueue_inline(FAAArrayQueue_t *q, void *item, int tid) {
+    assert(q != nullptr);
+    assert(tid >= 0 && tid < q->max_threads && "Invalid TID");
+    assert(item != nullptr && item != q->taken_sentinel && item != q->elim_waiting);
+
+#ifndef FAAQ_PREEMPT_INJECTION
+    if (!q->single_producer && q->elim_slots == nullptr) {
+        hazptr_holder_t *h = &q->holders[tid];
+        Node_t          *ltail;
+        HAZPTR_PROTECT(ltail, h, &q->tail);
+        size_t const idx = atomic_fetch_add_explicit(&ltail->enqidx, 1, memory_order_relaxed);
+        if (idx < FAA_BUFFER_SIZE) {
+            void *expected = nullptr;
+            if (atomic_compare_exchange_strong_explicit(
+                    &ltail->items[idx], &expected, item, memory_order_release, memory_order_relaxed
+                )) {
+                hazptr_reset(h, nullptr);
+                return true;
+            }
+        }
+        // Full node or burned slot: the index is given up, as in the
+        // out-of-line loop, which takes a fresh one.
+        hazptr_reset(h, nullptr);
+    }
+#endif
+    return faa_queue_enqueue_slow(q, item, tid);
+}
+
+/**
+ * @brief Inline equivalent of faa_queue_dequeue().
+ */
+static inline void *
+faa_queue_dequeue_inline(FAAArrayQueue_t *q, int tid) {
+    assert(q != nullptr);
+    assert(tid >= 0 && tid < q->max_threads && "Invalid TID");
+
+    if (!q->single_consumer) {
+        hazptr_holder_t *h = &q->holders[tid];
+        Node_t          *lhead;
+        HAZPTR_PROTECT(lhead, h, &q->head);
+        size_t const deq_idx = atomic_load_explicit(&lhead->deqidx, memory_order_acquire);
+        size_t const enq_idx = atomic_load_explicit(&lhead->enqidx, memory_order_acquire);
+        if (deq_idx < enq_idx && deq_idx < FAA_BUFFER_SIZE) {
+            size_t const idx = atomic_fetch_add_explicit(&lhead->deqidx, 1, memory_order_relaxed);
+            if (idx < FAA_BUFFER_SIZE) {
+                // The slot is ours alone and producers only store into an
+                // empty slot, so once an item is seen it cannot change: a
+                // plain store marks it taken without the exchange.
+                void *item = atomic_load_explicit(&lhead->items[idx], memory_order_acquire);
+                if (item == nullptr) {
+                    return faa_queue_dequeue_claimed_slow(q, tid, lhead, idx);
+                }
+                atomic_store_explicit(&lhead->items[idx], q->taken_sentinel, memory_order_relaxed);
+                hazptr_reset(h, nullptr);
+                return item;
+            }
+        }
+        // Empty, or the head node is drained.
+        hazptr_reset(h, nullptr);
+    }
+    return faa_queue_dequeue_slow(q, tid);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAAQ_INLINE_H
@@ -0,0 +1,187 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "faaq_inline.h"
+#include "test_common.h"
+
+static constexpr int      INL_PRODUCERS      = 4;
+static constexpr int      INL_CONSUMERS      = 4;
+static constexpr uint64_t ITEMS_PER_PRODUCER = 500000;
+
+static constexpr int      INL_TOTAL_THREADS  = INL_PRODUCERS + INL_CONSUMERS;
+static constexpr uint64_t INL_TOTAL_ITEMS    = (uint64_t) INL_PRODUCERS * ITEMS_PER_PRODUCER;
+
+static FAAArrayQueue_t   *g_queue            = nullptr;
+
+static _Atomic(bool)      g_verification[INL_TOTAL_ITEMS];
+
+alignas(64) static _Atomic(uint64_t) g_dequeued_count = 0;
+
+static item_check_t const g_check = {
+    .seen               = g_verification,
+    .dequeued           = &g_dequeued_count,
+    .producers          = INL_PRODUCERS,
+    .items_per_producer = ITEMS_PER_PRODUCER,
+};
+
+// Pushes 'count' items through 'q' across several nodes, alternating between
+// the inline and the exported functions on both ends.
+static void
+check_fifo(FAAArrayQueue_t *q, uint64_t count) {
+    for (uint64_t i = 0; i < count; i++) {
+        bool const ok = i % 2 ? faa_queue_enqueue(q, encode_item(1, i), 0)
+                              : faa_queue_enqueue_inline(q, encode_item(1, i), 0);
+        if (!ok) {
+            fprintf(stderr, "FAILED! Enqueue %w64u failed\n", i);
+            abort();
+        }
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        void *item = i % 3 ? faa_queue_dequeue_inline(q, 0) : faa_queue_dequeue(q, 0);
+        if (item != encode_item(1, i)) {
+            fprintf(stderr, "FAILED! Expected %w64u, got %ju\n", i, (uintptr_t) item);
+            assert(false);
+        }
+    }
+    assert(faa_queue_dequeue_inline(q, 0) == nullptr);
+}
+
+void
+run_basic_tests(void) {
+    printf("--- Starting Basic Inline Fast Path Tests ---\n");
+    uint64_t const   count = FAA_BUFFER_SIZE * 3 + 7;
+
+    FAAArrayQueue_t *q     = faa_queue_create(1);
+    assert(q != nullptr);
+    assert(faa_queue_dequeue_inline(q, 0) == nullptr);
+    printf("Test 1 (Empty Dequeue): PASSED\n");
+
+    check_fifo(q, count);
+    printf("Test 2 (FIFO Across Nodes, Mixed Entry Points): PASSED\n");
+
+    // Test 3: A slot taken on the inline path is skipped by peek.
+    for (uint64_t i = 0; i < 3; i++) {
+        assert(faa_queue_enqueue_inline(q, encode_item(2, i), 0));
+    }
+    assert(faa_queue_dequeue_inline(q, 0) == encode_item(2, 0));
+    assert(faa_queue_peek(q, 0) == encode_item(2, 1));
+    assert(faa_queue_size_approx(q, 0) == 2);
+    assert(faa_queue_dequeue_inline(q, 0) == encode_item(2, 1));
+    assert(faa_queue_dequeue_inline(q, 0) == encode_item(2, 2));
+    assert(faa_queue_is_empty(q, 0));
+    printf("Test 3 (Peek and Size After Inline Dequeue): PASSED\n");
+    faa_queue_destroy(q);
+
+    // Test 4: Configurations the fast paths hand to faaq.c entirely.
+    static struct {
+        char const   *name;
+        FAATopology_t topology;
+        uint32_t      elimination_spin;
+    } const fallbacks[] = {
+        {"spsc",        FAA_TOPOLOGY_SPSC, 0  },
+        {"mpsc",        FAA_TOPOLOGY_MPSC, 0  },
+        {"spmc",        FAA_TOPOLOGY_SPMC, 0  },
+        {"elimination", FAA_TOPOLOGY_MPMC, 100},
+    };
+    for (size_t i = 0; i < sizeof(fallbacks) / sizeof(fallbacks[0]); i++) {
+        FAAQueueConfig_t cfg = faa_queue_config_default();
+        cfg.topology         = fallbacks[i].topology;
+        cfg.elimination_spin = fallbacks[i].elimination_spin;
+        q                    = faa_queue_create_ex(1, &cfg);
+        assert(q != nullptr);
+        check_fifo(q, count);
+        faa_queue_destroy(q);
+    }
+    printf("Test 4 (Single-Sided Topologies and Elimination): PASSED\n");
+
+    printf("Basic tests finished successfully.\n");
+}
+
+// Even producers use the inline path, odd ones the exported function.
+int
+producer_thread(void *arg) {
+    int tid = (int) (uintptr_t) arg;
+    for (uint64_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+        void *item = encode_item((uint64_t) tid, i);
+        if (tid % 2 == 0) {
+            faa_queue_enqueue_inline(g_queue, item, tid);
+        } else {
+            faa_queue_enqueue(g_queue, item, tid);
+        }
+        if (i % 50000 == 0) {
+            thrd_yield();
+        }
+    }
+    return 0;
+}
+
+int
+consumer_thread(void *arg) {
+    int const    tid = (int) (uintptr_t) arg;
+    item_order_t order;
+    item_order_init(&order);
+    while (item_check_pending(&g_check)) {
+        void *item = faa_queue_dequeue_inline(g_queue, tid);
+        if (item == nullptr) {
+            thrd_yield();
+            continue;
+        }
+        item_check_consume(&g_check, &order, tid, (uint64_t) (uintptr_t) item);
+    }
+    return 0;
+}
+
+void
+run_mpmc_test(char const *name, FAAWaitPolicy_t policy) {
+    printf("\n--- Starting Inline MPMC Stress Test (wait policy: %s) ---\n", name);
+    printf("Producers: %d, Consumers: %d\n", INL_PRODUCERS, INL_CONSUMERS);
+
+    FAAQueueConfig_t cfg = faa_queue_config_default();
+    cfg.wait_policy      = policy;
+    g_queue              = faa_queue_create_ex(INL_TOTAL_THREADS, &cfg);
+    if (!g_queue) {
+        fprintf(stderr, "Failed to create queue.\n");
+        exit(EXIT_FAILURE);
+    }
+    item_check_reset(&g_check);
+
+    thrd_t threads[INL_TOTAL_THREADS];
+    for (int tid = 0; tid < INL_TOTAL_THREADS; ++tid) {
+        thrd_start_t fn = tid < INL_PRODUCERS ? producer_thread : consumer_thread;
+        if (thrd_create(&threads[tid], fn, (void *) (uintptr_t) tid) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", tid);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int tid = 0; tid < INL_TOTAL_THREADS; ++tid) {
+        thrd_join(threads[tid], nullptr);
+    }
+
+    bool success = item_check_complete(&g_check);
+    if (faa_queue_dequeue_inline(g_queue, 0) != nullptr) {
+        fprintf(stderr, "ERROR: Queue not empty after test completion!\n");
+        success = false;
+    }
+    faa_queue_destroy(g_queue);
+    g_queue = nullptr;
+
+    if (!success) {
+        printf("INLINE FAILURE: verification failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("INLINE SUCCESS: Exactly-once and per-producer order verified.\n");
+}
+
+int
+main(void) {
+    run_basic_tests();
+    run_mpmc_test("none", FAA_WAIT_NONE);
+    run_mpmc_test("spin", FAA_WAIT_SPIN);
+
+    printf("\nAll inline fast path tests completed successfully.\n");
+    return EXIT_SUCCESS;
+}
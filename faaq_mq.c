@@ -0,0 +1,151 @@
+#define _GNU_SOURCE
+#include "faaq_mq.h"
+
+#include <assert.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+// Per-thread xorshift state for victim selection. Lazily seeded.
+static thread_local uint64_t tls_rng = 0;
+
+static inline uint64_t
+rng_next(int tid) {
+    uint64_t x = tls_rng;
+    if (x == 0) {
+        // splitmix64 of the tid and the state's address: distinct per thread.
+        x = ((uint64_t) (uintptr_t) &tls_rng ^ (uint64_t) tid) + 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        if (x == 0) {
+            x = 1;
+        }
+    }
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    tls_rng = x;
+    return x;
+}
+
+static inline int
+home_lane(FAAMultiQueue_t const *mq, int tid) {
+    int key = tid;
+    if (mq->lane_policy == FAA_LANE_BY_CPU) {
+        int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            key = cpu;
+        }
+    }
+    return key % mq->num_lanes;
+}
+
+FAAMultiQueue_t *
+faa_multiqueue_create(int num_lanes, int max_threads, FAALanePolicy_t lane_policy, FAAQueueConfig_t const *config) {
+    if (num_lanes <= 0 || max_threads <= 0) {
+        fprintf(stderr, "C23 FAAQueue Error: num_lanes and max_threads must be > 0.\n");
+        return nullptr;
+    }
+
+    FAAMultiQueue_t *mq = malloc(sizeof(FAAMultiQueue_t));
+    if (!mq) {
+        return nullptr;
+    }
+
+    mq->num_lanes   = num_lanes;
+    mq->max_threads = max_threads;
+    mq->lane_policy = lane_policy;
+    mq->lanes       = calloc(num_lanes, sizeof(FAAArrayQueue_t *));
+    if (!mq->lanes) {
+        free(mq);
+        return nullptr;
+    }
+
+    for (int i = 0; i < num_lanes; i++) {
+        mq->lanes[i] = faa_queue_create_ex(max_threads, config);
+        if (!mq->lanes[i]) {
+            faa_multiqueue_destroy(mq);
+            return nullptr;
+        }
+    }
+
+    return mq;
+}
+
+void
+faa_multiqueue_destroy(FAAMultiQueue_t *mq) {
+    if (!mq) {
+        return;
+    }
+
+    if (mq->lanes) {
+        for (int i = 0; i < mq->num_lanes; i++) {
+            faa_queue_destroy(mq->lanes[i]);
+        }
+        free(mq->lanes);
+    }
+
+    free(mq);
+}
+
+bool
+faa_multiqueue_enqueue(FAAMultiQueue_t *mq, void *item, int tid) {
+    assert(mq != nullptr);
+    return faa_queue_enqueue(mq->lanes[home_lane(mq, tid)], item, tid);
+}
+
+void *
+faa_multiqueue_dequeue(FAAMultiQueue_t *mq, int tid) {
+    assert(mq != nullptr);
+    int const home = home_lane(mq, tid);
+
+    void     *item = faa_queue_dequeue(mq->lanes[home], tid);
+    if (item != nullptr || mq->num_lanes == 1) {
+        return item;
+    }
+
+    // Home lane is empty. Steal from the fuller of two random lanes (the
+    // "power of two choices"), which keeps lane depths balanced without
+    // scanning every lane on each miss.
+    uint64_t const r = rng_next(tid);
+    int            a = (int) (r % (uint64_t) mq->num_lanes);
+    int            b = (int) ((r >> 32) % (uint64_t) mq->num_lanes);
+    if (faa_queue_size_approx(mq->lanes[b], tid) > faa_queue_size_approx(mq->lanes[a], tid)) {
+        int t = a;
+        a     = b;
+        b     = t;
+    }
+
+    item = faa_queue_dequeue(mq->lanes[a], tid);
+    if (item != nullptr) {
+        return item;
+    }
+
+    // Both choices missed. Sweep the remaining lanes once so that a nullptr
+    // result means every lane was observed empty.
+    for (int i = 1; i < mq->num_lanes; i++) {
+        int const lane = (home + i) % mq->num_lanes;
+        if (lane == a) {
+            continue;
+        }
+        item = faa_queue_dequeue(mq->lanes[lane], tid);
+        if (item != nullptr) {
+            return item;
+        }
+    }
+
+    return nullptr;
+}
+
+size_t
+faa_multiqueue_size_approx(FAAMultiQueue_t *mq, int tid) {
+    assert(mq != nullptr);
+    size_t total = 0;
+    for (int i = 0; i < mq->num_lanes; i++) {
+        total += faa_queue_size_approx(mq->lanes[i], tid);
+    }
+    return total;
+}
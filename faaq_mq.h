@@ -0,0 +1,94 @@
+#ifndef FAA_MULTIQUEUE_H
+#define FAA_MULTIQUEUE_H
+
+#include <stddef.h>
+
+#include "faaq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief How a thread is mapped to its home lane.
+ */
+typedef enum {
+    // Lane derived from the caller's tid. Stable, no system call.
+    FAA_LANE_BY_TID = 0,
+    // Lane derived from the CPU the caller is currently running on, so threads
+    // sharing a core also share a lane. Falls back to the tid if the CPU
+    // cannot be determined.
+    FAA_LANE_BY_CPU,
+} FAALanePolicy_t;
+
+/**
+ * @brief A relaxed-FIFO queue sharded over several FAAArrayQueue_t lanes.
+ *
+ * Producers enqueue to their home lane, so items from one producer keep their
+ * relative order as long as the producer's home lane does not change (always
+ * true with FAA_LANE_BY_TID). Consumers dequeue from their home lane first and
+ * otherwise steal from the fuller of two randomly chosen lanes. There is no
+ * ordering guarantee between lanes.
+ */
+typedef struct {
+    int               num_lanes;
+    int               max_threads;
+    FAALanePolicy_t   lane_policy;
+    FAAArrayQueue_t **lanes;
+} FAAMultiQueue_t;
+
+/**
+ * @brief Creates a multiqueue with 'num_lanes' lanes.
+ *
+ * @param num_lanes Number of internal queues. Must be > 0.
+ * @param max_threads The maximum number of threads that will access the
+ * multiqueue. Must be > 0. Each thread uses the same tid on every lane.
+ * @param lane_policy How threads are mapped to their home lane.
+ * @param config Configuration applied to every lane, or nullptr for defaults.
+ * @return A pointer to the new multiqueue, or nullptr on failure.
+ */
+[[nodiscard("Queue creation failure must be handled")]]
+FAAMultiQueue_t *faa_multiqueue_create(
+    int                     num_lanes,
+    int                     max_threads,
+    FAALanePolicy_t         lane_policy,
+    FAAQueueConfig_t const *config
+);
+
+/**
+ * @brief Destroys the multiqueue and all its lanes. Assumes quiescence.
+ */
+void             faa_multiqueue_destroy(FAAMultiQueue_t *mq);
+
+/**
+ * @brief Enqueues an item on the caller's home lane.
+ *
+ * @param mq Pointer to the multiqueue.
+ * @param item The item to enqueue (must not be nullptr).
+ * @param tid The thread ID of the caller (0 <= tid < max_threads).
+ * @return false if the home lane could not allocate a node (see
+ * faa_queue_enqueue()).
+ */
+bool             faa_multiqueue_enqueue(FAAMultiQueue_t *mq, void *item, int tid);
+
+/**
+ * @brief Dequeues an item, preferring the caller's home lane.
+ *
+ * Returns nullptr only after every lane has been observed empty once.
+ *
+ * @param mq Pointer to the multiqueue.
+ * @param tid The thread ID of the caller (0 <= tid < max_threads).
+ * @return The dequeued item, or nullptr if all lanes appear empty.
+ */
+void            *faa_multiqueue_dequeue(FAAMultiQueue_t *mq, int tid);
+
+/**
+ * @brief Sum of faa_queue_size_approx() over all lanes.
+ */
+size_t           faa_multiqueue_size_approx(FAAMultiQueue_t *mq, int tid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAA_MULTIQUEUE_H
@@ -0,0 +1,114 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_common.h"
+#include "faaq.h"
+#include "faaq_mq.h"
+
+// Scaling benchmark: a single FAAArrayQueue_t versus FAAMultiQueue_t for an
+// increasing number of threads (half producers, half consumers).
+
+static constexpr uint64_t ITEMS_PER_RUN = 8000000;
+
+static int const          THREAD_COUNTS[] = {2, 4, 8, 16, 32, 64};
+
+static void *
+single_create(int producers, int max_threads) {
+    (void) producers;
+    return faa_queue_create(max_threads);
+}
+
+static bool
+single_enqueue(void *queue, void *item, int tid) {
+    return faa_queue_enqueue(queue, item, tid);
+}
+
+static void *
+single_dequeue(void *queue, int tid) {
+    return faa_queue_dequeue(queue, tid);
+}
+
+static void
+single_destroy(void *queue) {
+    faa_queue_destroy(queue);
+}
+
+static void *
+mq_create(int producers, int max_threads) {
+    // One lane per producer: every producer owns its enqidx line.
+    return faa_multiqueue_create(producers, max_threads, FAA_LANE_BY_TID, nullptr);
+}
+
+static bool
+mq_enqueue(void *queue, void *item, int tid) {
+    return faa_multiqueue_enqueue(queue, item, tid);
+}
+
+static void *
+mq_dequeue(void *queue, int tid) {
+    return faa_multiqueue_dequeue(queue, tid);
+}
+
+static void
+mq_destroy(void *queue) {
+    faa_multiqueue_destroy(queue);
+}
+
+static bench_engine_t const ENGINES[] = {
+    {"faaq",       single_create, single_enqueue, single_dequeue, single_destroy},
+    {"multiqueue", mq_create,     mq_enqueue,     mq_dequeue,     mq_destroy    },
+};
+
+// Thread 'tid' runs on CPU 'tid' (modulo the online CPUs).
+static int g_cpus[CPU_SETSIZE];
+
+// Returns throughput in million items per second.
+static double
+run_once(bench_engine_t const *engine, int threads_n) {
+    bench_workload_t const workload = {
+        .producers = threads_n / 2,
+        .consumers = threads_n - threads_n / 2,
+        .items     = ITEMS_PER_RUN,
+        .cpus      = g_cpus,
+        .num_cpus  = bench_online_cpus() < CPU_SETSIZE ? bench_online_cpus() : CPU_SETSIZE,
+    };
+    bench_workload_result_t *r = bench_alloc(1, sizeof(bench_workload_result_t));
+    bench_run_workload(engine, &workload, r);
+    double const mops = (double) r->total_items * 1e3 / (double) r->ns;
+    free(r);
+    return mops;
+}
+
+int
+main(void) {
+    size_t const n_counts  = sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]);
+    size_t const n_engines = sizeof(ENGINES) / sizeof(ENGINES[0]);
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        g_cpus[cpu] = cpu;
+    }
+
+    printf("--- Multiqueue Scaling Benchmark ---\n");
+    printf("Items per run: %w64u, Online CPUs: %d\n", ITEMS_PER_RUN, bench_online_cpus());
+    printf("%-8s", "Threads");
+    for (size_t e = 0; e < n_engines; ++e) {
+        printf(" %14s", ENGINES[e].name);
+    }
+    printf(" %10s\n", "Speedup");
+
+    for (size_t c = 0; c < n_counts; ++c) {
+        double mops[n_engines];
+        for (size_t e = 0; e < n_engines; ++e) {
+            mops[e] = run_once(&ENGINES[e], THREAD_COUNTS[c]);
+        }
+        printf("%-8d", THREAD_COUNTS[c]);
+        for (size_t e = 0; e < n_engines; ++e) {
+            printf(" %9.2f Mops", mops[e]);
+        }
+        printf(" %9.2fx\n", mops[n_engines - 1] / mops[0]);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "faaq_mq.h"
+#include "test_common.h"
+
+static constexpr int      MQ_LANES           = 4;
+static constexpr int      MQ_PRODUCERS       = 4;
+static constexpr int      MQ_CONSUMERS       = 4;
+static constexpr uint64_t ITEMS_PER_PRODUCER = 500000;
+
+static constexpr int      MQ_TOTAL_THREADS   = MQ_PRODUCERS + MQ_CONSUMERS;
+static constexpr uint64_t MQ_TOTAL_ITEMS     = (uint64_t) MQ_PRODUCERS * ITEMS_PER_PRODUCER;
+
+static FAAMultiQueue_t   *g_mq               = nullptr;
+
+static _Atomic(bool)      g_verification[MQ_TOTAL_ITEMS];
+
+alignas(64) static _Atomic(uint64_t) g_dequeued_count = 0;
+
+static item_check_t const g_check = {
+    .seen               = g_verification,
+    .dequeued           = &g_dequeued_count,
+    .producers          = MQ_PRODUCERS,
+    .items_per_producer = ITEMS_PER_PRODUCER,
+};
+
+void
+run_basic_tests(void) {
+    printf("--- Starting Basic Multiqueue Tests ---\n");
+    FAAMultiQueue_t *mq = faa_multiqueue_create(MQ_LANES, MQ_LANES, FAA_LANE_BY_TID, nullptr);
+    assert(mq != nullptr);
+
+    assert(faa_multiqueue_dequeue(mq, 0) == nullptr);
+    printf("Test 1 (Empty Dequeue): PASSED\n");
+
+    // Test 2: A single producer's items stay in FIFO order, even when they
+    // are stolen by a consumer whose home lane is different.
+    uint64_t const count = FAA_BUFFER_SIZE * 2 + 50;
+    for (uint64_t i = 0; i < count; i++) {
+        faa_multiqueue_enqueue(mq, encode_item(1, i), 1);
+    }
+    assert(faa_multiqueue_size_approx(mq, 0) == count);
+    for (uint64_t i = 0; i < count; i++) {
+        void *item = faa_multiqueue_dequeue(mq, 0);
+        if (item != encode_item(1, i)) {
+            fprintf(stderr, "FAILED! Expected %w64u, got %ju\n", i, (uintptr_t) item);
+            assert(false);
+        }
+    }
+    assert(faa_multiqueue_dequeue(mq, 0) == nullptr);
+    printf("Test 2 (Per-Lane FIFO With Stealing): PASSED\n");
+
+    // Test 3: Items spread over every lane are all found by one consumer.
+    for (int tid = 0; tid < MQ_LANES; tid++) {
+        for (uint64_t i = 0; i < 100; i++) {
+            faa_multiqueue_enqueue(mq, encode_item((uint64_t) tid, i), tid);
+        }
+    }
+    uint64_t next_seq[MQ_LANES] = {};
+    for (uint64_t n = 0; n < MQ_LANES * 100; n++) {
+        void *item = faa_multiqueue_dequeue(mq, 0);
+        assert(item != nullptr);
+        uint64_t producer, seq;
+        decode_item(item, &producer, &seq);
+        assert(producer < MQ_LANES && seq == next_seq[producer]);
+        next_seq[producer]++;
+    }
+    assert(faa_multiqueue_dequeue(mq, 0) == nullptr);
+    printf("Test 3 (Lane Sweep): PASSED\n");
+
+    faa_multiqueue_destroy(mq);
+    printf("Basic tests finished successfully.\n");
+}
+
+int
+producer_thread(void *arg) {
+    int tid = (int) (uintptr_t) arg;
+    for (uint64_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+        faa_multiqueue_enqueue(g_mq, encode_item((uint64_t) tid, i), tid);
+        if (i % 50000 == 0) {
+            thrd_yield();
+        }
+    }
+    return 0;
+}
+
+int
+consumer_thread(void *arg) {
+    int const    tid = (int) (uintptr_t) arg;
+    item_order_t order;
+    item_order_init(&order);
+    while (item_check_pending(&g_check)) {
+        void *item = faa_multiqueue_dequeue(g_mq, tid);
+        if (item == nullptr) {
+            thrd_yield();
+            continue;
+        }
+        item_check_consume(&g_check, &order, tid, (uint64_t) (uintptr_t) item);
+    }
+    return 0;
+}
+
+void
+run_mpmc_test(void) {
+    printf("\n--- Starting Multiqueue MPMC Stress Test ---\n");
+    printf("Lanes: %d, Producers: %d, Consumers: %d\n", MQ_LANES, MQ_PRODUCERS, MQ_CONSUMERS);
+
+    g_mq = faa_multiqueue_create(MQ_LANES, MQ_TOTAL_THREADS, FAA_LANE_BY_TID, nullptr);
+    if (!g_mq) {
+        fprintf(stderr, "Failed to create multiqueue.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    thrd_t threads[MQ_TOTAL_THREADS];
+    for (int tid = 0; tid < MQ_TOTAL_THREADS; ++tid) {
+        thrd_start_t fn = tid < MQ_PRODUCERS ? producer_thread : consumer_thread;
+        if (thrd_create(&threads[tid], fn, (void *) (uintptr_t) tid) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", tid);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int tid = 0; tid < MQ_TOTAL_THREADS; ++tid) {
+        thrd_join(threads[tid], nullptr);
+    }
+
+    bool success = item_check_complete(&g_check);
+    if (faa_multiqueue_dequeue(g_mq, 0) != nullptr) {
+        fprintf(stderr, "ERROR: Multiqueue not empty after test completion!\n");
+        success = false;
+    }
+    faa_multiqueue_destroy(g_mq);
+    g_mq = nullptr;
+
+    if (!success) {
+        printf("MULTIQUEUE FAILURE: verification failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("MULTIQUEUE SUCCESS: Exactly-once and per-producer order verified.\n");
+}
+
+int
+main(void) {
+    run_basic_tests();
+    run_mpmc_test();
+
+    printf("\nAll multiqueue tests completed successfully.\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,591 @@
+#define _GNU_SOURCE
+#include "faaq_shm.h"
+
+#include "faaq_inline.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr static uint64_t FAA_SHM_MAGIC       = 0xFAA05A4D51554555ull;
+
+// Upper bound on hazard records, so a scan can snapshot them on the stack.
+constexpr static uint32_t FAA_SHM_MAX_HAZARDS = 4096;
+
+// Per-record retired list: a count followed by node indices.
+typedef struct {
+    uint32_t count;
+    uint32_t nodes[];
+} FAAShmRetired_t;
+
+static inline size_t
+align_up(size_t n, size_t a) {
+    return (n + a - 1) / a * a;
+}
+
+// --- Region Accessors ---
+
+static inline FAAShmNode_t *
+node_at(FAAShmQueue_t const *q, uint32_t idx) {
+    return (FAAShmNode_t *) (q->base + q->hdr->nodes_off) + idx;
+}
+
+static inline FAAShmHazard_t *
+hazard_at(FAAShmQueue_t const *q, uint32_t rec) {
+    return (FAAShmHazard_t *) (q->base + q->hdr->hazards_off) + rec;
+}
+
+static inline size_t
+retired_stride(uint32_t capacity) {
+    return align_up(sizeof(FAAShmRetired_t) + capacity * sizeof(uint32_t), FAA_ALIGNMENT);
+}
+
+static inline FAAShmRetired_t *
+retired_at(FAAShmQueue_t const *q, uint32_t rec) {
+    return (FAAShmRetired_t *) (q->base + q->hdr->retired_off + rec * retired_stride(q->hdr->retired_capacity));
+}
+
+static inline FAAShmProc_t *
+proc_at(FAAShmQueue_t const *q, uint32_t slot) {
+    return (FAAShmProc_t *) (q->base + q->hdr->procs_off) + slot;
+}
+
+static inline uint32_t
+hazard_index(FAAShmQueue_t const *q, int tid) {
+    return (uint32_t) q->slot * q->hdr->config.threads_per_proc + (uint32_t) tid;
+}
+
+// The freelist link of a free payload buffer is stored in its first bytes.
+static _Atomic(uint32_t) *
+payload_link(FAAShmQueue_t const *q, uint32_t idx) {
+    return (_Atomic(uint32_t) *) (q->base + q->hdr->payload_off + (size_t) idx * q->hdr->config.payload_size);
+}
+
+static _Atomic(uint32_t) *
+node_link(FAAShmQueue_t const *q, uint32_t idx) {
+    return &node_at(q, idx)->free_next;
+}
+
+// --- Tagged Index Stacks ---
+
+static inline uint64_t
+tagged(uint64_t tag, uint32_t idx) {
+    return tag << 32 | idx;
+}
+
+static uint32_t
+stack_pop(
+    FAAShmQueue_t const *q,
+    _Atomic(uint64_t)   *top,
+    _Atomic(uint32_t) *(*link)(FAAShmQueue_t const *, uint32_t)
+) {
+    uint64_t old = atomic_load_explicit(top, memory_order_acquire);
+    while (true) {
+        uint32_t const idx = (uint32_t) old;
+        if (idx == FAA_SHM_NIL) {
+            return FAA_SHM_NIL;
+        }
+        // The link may be stale if 'idx' was popped meanwhile; the tag makes
+        // the CAS below fail in that case.
+        uint32_t const next = atomic_load_explicit(link(q, idx), memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(
+                top, &old, tagged((old >> 32) + 1, next), memory_order_acquire, memory_order_acquire
+            )) {
+            return idx;
+        }
+    }
+}
+
+static void
+stack_push(
+    FAAShmQueue_t const *q,
+    _Atomic(uint64_t)   *top,
+    _Atomic(uint32_t) *(*link)(FAAShmQueue_t const *, uint32_t),
+    uint32_t             idx
+) {
+    uint64_t old = atomic_load_explicit(top, memory_order_relaxed);
+    do {
+        atomic_store_explicit(link(q, idx), (uint32_t) old, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(
+        top, &old, tagged((old >> 32) + 1, idx), memory_order_release, memory_order_relaxed
+    ));
+}
+
+// --- Hazard Pointers ---
+
+// Load-protect-validate on a node index, as HAZPTR_PROTECT does for pointers.
+static uint32_t
+protect(FAAShmHazard_t *hz, _Atomic(uint32_t) *src) {
+    uint32_t p = atomic_load_explicit(src, memory_order_relaxed);
+    while (true) {
+        atomic_store_explicit(&hz->node, p, memory_order_release);
+        atomic_thread_fence(memory_order_seq_cst);
+        uint32_t const v = atomic_load_explicit(src, memory_order_acquire);
+        if (p == v) {
+            return p;
+        }
+        p = v;
+    }
+}
+
+static inline void
+unprotect(FAAShmHazard_t *hz) {
+    atomic_store_explicit(&hz->node, FAA_SHM_NIL, memory_order_release);
+}
+
+// Frees every node on 'rec's retired list that no hazard pointer protects.
+// Returns the number of nodes freed.
+static uint32_t
+scan(FAAShmQueue_t *q, uint32_t rec) {
+    FAAShmRetired_t *r = retired_at(q, rec);
+    if (r->count == 0) {
+        return 0;
+    }
+
+    // Pairs with the fence in protect(): a hazard published before the node
+    // was unlinked is visible here.
+    atomic_thread_fence(memory_order_seq_cst);
+
+    uint32_t const n = q->hdr->hazard_count;
+    uint32_t       hazards[n];
+    for (uint32_t i = 0; i < n; i++) {
+        hazards[i] = atomic_load_explicit(&hazard_at(q, i)->node, memory_order_acquire);
+    }
+
+    uint32_t kept = 0, freed = 0;
+    for (uint32_t j = 0; j < r->count; j++) {
+        uint32_t const node = r->nodes[j];
+        bool           busy = false;
+        for (uint32_t i = 0; i < n && !busy; i++) {
+            busy = hazards[i] == node;
+        }
+        if (busy) {
+            r->nodes[kept++] = node;
+        } else {
+            stack_push(q, &q->hdr->node_free, node_link, node);
+            freed++;
+        }
+    }
+    r->count = kept;
+    return freed;
+}
+
+static void
+retire(FAAShmQueue_t *q, uint32_t rec, uint32_t node) {
+    FAAShmRetired_t *r = retired_at(q, rec);
+    assert(r->count < q->hdr->retired_capacity);
+    r->nodes[r->count++] = node;
+    // Nodes are retired once per FAA_BUFFER_SIZE items, so scanning every
+    // time is cheap, and it keeps the bounded pool from being stranded on
+    // retired lists. After a scan only protected nodes remain, at most one
+    // per hazard record, which is what the capacity allows for.
+    scan(q, rec);
+}
+
+// Takes a node from the pool and initializes it with 'item' in slot 0.
+// Returns FAA_SHM_NIL if the pool is exhausted.
+static uint32_t
+node_alloc(FAAShmQueue_t *q, uint32_t rec, uint64_t item) {
+    uint32_t idx = stack_pop(q, &q->hdr->node_free, node_link);
+    if (idx == FAA_SHM_NIL && scan(q, rec) > 0) {
+        idx = stack_pop(q, &q->hdr->node_free, node_link);
+    }
+    if (idx == FAA_SHM_NIL) {
+        return FAA_SHM_NIL;
+    }
+
+    // Nobody else references a free node; the CAS that links it publishes
+    // these stores.
+    FAAShmNode_t *node = node_at(q, idx);
+    atomic_store_explicit(&node->deqidx, 0, memory_order_relaxed);
+    atomic_store_explicit(&node->enqidx, 1, memory_order_relaxed);
+    atomic_store_explicit(&node->next, FAA_SHM_NIL, memory_order_relaxed);
+    atomic_store_explicit(&node->items[0], item, memory_order_relaxed);
+    for (size_t i = 1; i < FAA_BUFFER_SIZE; i++) {
+        atomic_store_explicit(&node->items[i], FAA_SHM_EMPTY, memory_order_relaxed);
+    }
+    return idx;
+}
+
+// --- Region Lifecycle ---
+
+FAAShmConfig_t
+faa_shm_config_default(void) {
+    return (FAAShmConfig_t) {
+        .max_procs        = FAA_SHM_DEFAULT_PROCS,
+        .threads_per_proc = FAA_SHM_DEFAULT_THREADS,
+        .node_count       = FAA_SHM_DEFAULT_NODES,
+        .payload_slots    = FAA_SHM_DEFAULT_SLOTS,
+        .payload_size     = FAA_SHM_DEFAULT_PAYLOAD,
+    };
+}
+
+// Maps the region behind 'fd' and claims a process slot. Takes ownership of
+// 'fd'.
+static FAAShmQueue_t *
+map_and_claim(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(FAAShmHeader_t)) {
+        fprintf(stderr, "C23 FAAQueue Error: Shared region is missing or truncated.\n");
+        close(fd);
+        return nullptr;
+    }
+
+    void *base = mmap(nullptr, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        perror("C23 FAAQueue Error: mmap of shared region failed");
+        close(fd);
+        return nullptr;
+    }
+
+    FAAShmHeader_t *hdr = base;
+    if (atomic_load_explicit(&hdr->magic, memory_order_acquire) != FAA_SHM_MAGIC || hdr->version != FAA_SHM_VERSION
+        || hdr->buffer_size != FAA_BUFFER_SIZE || hdr->region_size != (uint64_t) st.st_size) {
+        fprintf(stderr, "C23 FAAQueue Error: Shared region is not an initialized FAAQ region of this version.\n");
+        munmap(base, (size_t) st.st_size);
+        close(fd);
+        return nullptr;
+    }
+
+    FAAShmQueue_t *q = malloc(sizeof(FAAShmQueue_t));
+    if (!q) {
+        munmap(base, (size_t) st.st_size);
+        close(fd);
+        return nullptr;
+    }
+    *q = (FAAShmQueue_t) { .hdr = hdr, .base = base, .size = (size_t) st.st_size, .fd = fd, .slot = -1 };
+
+    // Claim a free slot; failing that, take over one whose owner has exited.
+    int32_t const self = (int32_t) getpid();
+    for (uint32_t pass = 0; pass < 2 && q->slot < 0; pass++) {
+        for (uint32_t s = 0; s < hdr->config.max_procs; s++) {
+            FAAShmProc_t *p     = proc_at(q, s);
+            int32_t       owner = atomic_load_explicit(&p->pid, memory_order_acquire);
+            if (pass == 0 ? owner != 0 : owner == 0 || kill(owner, 0) == 0 || errno != ESRCH) {
+                continue;
+            }
+            if (atomic_compare_exchange_strong_explicit(
+                    &p->pid, &owner, self, memory_order_acq_rel, memory_order_relaxed
+                )) {
+                q->slot = (int) s;
+                break;
+            }
+        }
+    }
+    if (q->slot < 0) {
+        fprintf(stderr, "C23 FAAQueue Error: All %u process slots are in use.\n", hdr->config.max_procs);
+        faa_shm_queue_detach(q);
+        return nullptr;
+    }
+
+    // A dead owner may have died holding hazard pointers. Its retired lists
+    // are kept and drained by this process from now on.
+    for (uint32_t t = 0; t < hdr->config.threads_per_proc; t++) {
+        unprotect(hazard_at(q, hazard_index(q, (int) t)));
+    }
+    return q;
+}
+
+FAAShmQueue_t *
+faa_shm_queue_create(char const *name, FAAShmConfig_t const *config) {
+    FAAShmConfig_t cfg = config ? *config : faa_shm_config_default();
+    cfg.payload_size   = (uint32_t) align_up(cfg.payload_size, FAA_ALIGNMENT);
+
+    if (cfg.max_procs == 0 || cfg.threads_per_proc == 0 || cfg.node_count < 2
+        || (uint64_t) cfg.max_procs * cfg.threads_per_proc > FAA_SHM_MAX_HAZARDS || cfg.node_count == FAA_SHM_NIL
+        || cfg.payload_slots == FAA_SHM_NIL || cfg.payload_size == 0) {
+        fprintf(stderr, "C23 FAAQueue Error: Invalid shared queue configuration.\n");
+        return nullptr;
+    }
+
+    // Layout: header | process slots | hazards | retired lists | nodes | payload.
+    uint32_t const hazard_count     = cfg.max_procs * cfg.threads_per_proc;
+    uint32_t const retired_capacity = hazard_count + 1;
+
+    FAAShmHeader_t layout           = {
+                  .version          = FAA_SHM_VERSION,
+                  .buffer_size      = FAA_BUFFER_SIZE,
+                  .config           = cfg,
+                  .hazard_count     = hazard_count,
+                  .retired_capacity = retired_capacity,
+    };
+    size_t off          = align_up(sizeof(FAAShmHeader_t), FAA_ALIGNMENT);
+    layout.procs_off    = off;
+    off                += align_up(cfg.max_procs * sizeof(FAAShmProc_t), FAA_ALIGNMENT);
+    layout.hazards_off  = off;
+    off                += align_up(hazard_count * sizeof(FAAShmHazard_t), FAA_ALIGNMENT);
+    layout.retired_off  = off;
+    off                += hazard_count * retired_stride(retired_capacity);
+    layout.nodes_off    = off;
+    off                += (size_t) cfg.node_count * sizeof(FAAShmNode_t);
+    layout.payload_off  = off;
+    off                += (size_t) cfg.payload_slots * cfg.payload_size;
+    layout.region_size  = align_up(off, (size_t) sysconf(_SC_PAGESIZE));
+
+    int fd = name ? shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600) : memfd_create("faaq_shm", MFD_CLOEXEC);
+    if (fd < 0) {
+        perror("C23 FAAQueue Error: Failed to create shared region");
+        return nullptr;
+    }
+    // ftruncate zero-fills, so every slot starts out FAA_SHM_EMPTY and every
+    // retired list empty.
+    if (ftruncate(fd, (off_t) layout.region_size) != 0) {
+        perror("C23 FAAQueue Error: Failed to size shared region");
+        close(fd);
+        if (name) {
+            shm_unlink(name);
+        }
+        return nullptr;
+    }
+
+    void *base = mmap(nullptr, layout.region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        perror("C23 FAAQueue Error: mmap of shared region failed");
+        close(fd);
+        if (name) {
+            shm_unlink(name);
+        }
+        return nullptr;
+    }
+
+    FAAShmHeader_t *hdr = base;
+    *hdr                = layout;
+    FAAShmQueue_t init  = { .hdr = hdr, .base = base, .size = layout.region_size, .fd = fd, .slot = -1 };
+
+    for (uint32_t i = 0; i < hazard_count; i++) {
+        atomic_init(&hazard_at(&init, i)->node, FAA_SHM_NIL);
+    }
+
+    // Node 0 is the initial sentinel; the rest form the freelist.
+    FAAShmNode_t *sentinel = node_at(&init, 0);
+    atomic_init(&sentinel->enqidx, 0);
+    atomic_init(&sentinel->next, FAA_SHM_NIL);
+    atomic_init(&hdr->head, 0);
+    atomic_init(&hdr->tail, 0);
+    for (uint32_t i = 1; i < cfg.node_count; i++) {
+        atomic_init(node_link(&init, i), i + 1 < cfg.node_count ? i + 1 : FAA_SHM_NIL);
+    }
+    atomic_init(&hdr->node_free, tagged(0, 1));
+
+    for (uint32_t i = 0; i < cfg.payload_slots; i++) {
+        atomic_init(payload_link(&init, i), i + 1 < cfg.payload_slots ? i + 1 : FAA_SHM_NIL);
+    }
+    atomic_init(&hdr->payload_free, tagged(0, cfg.payload_slots > 0 ? 0 : FAA_SHM_NIL));
+
+    // Publish the region; attach refuses it until the magic is in place.
+    atomic_store_explicit(&hdr->magic, FAA_SHM_MAGIC, memory_order_release);
+    munmap(base, layout.region_size);
+
+    return map_and_claim(fd);
+}
+
+FAAShmQueue_t *
+faa_shm_queue_attach(char const *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        perror("C23 FAAQueue Error: Failed to open shared region");
+        return nullptr;
+    }
+    return map_and_claim(fd);
+}
+
+FAAShmQueue_t *
+faa_shm_queue_attach_fd(int fd) {
+    int own = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own < 0) {
+        perror("C23 FAAQueue Error: Failed to duplicate shared region descriptor");
+        return nullptr;
+    }
+    return map_and_claim(own);
+}
+
+int
+faa_shm_queue_fd(FAAShmQueue_t const *q) {
+    assert(q != nullptr);
+    return q->fd;
+}
+
+void
+faa_shm_queue_detach(FAAShmQueue_t *q) {
+    if (!q) {
+        return;
+    }
+
+    if (q->slot >= 0) {
+        for (uint32_t t = 0; t < q->hdr->config.threads_per_proc; t++) {
+            uint32_t const rec = hazard_index(q, (int) t);
+            unprotect(hazard_at(q, rec));
+            scan(q, rec);
+        }
+        atomic_store_explicit(&proc_at(q, (uint32_t) q->slot)->pid, 0, memory_order_release);
+    }
+
+    munmap(q->base, q->size);
+    close(q->fd);
+    free(q);
+}
+
+int
+faa_shm_queue_unlink(char const *name) {
+    return shm_unlink(name);
+}
+
+// --- Queue Operations ---
+
+bool
+faa_shm_queue_enqueue(FAAShmQueue_t *q, uint64_t item, int tid) {
+    assert(q != nullptr);
+
+    if (item == FAA_SHM_EMPTY || item == FAA_SHM_TAKEN) {
+        fprintf(stderr, "C23 FAAQueue Error: Cannot enqueue a reserved item value.\n");
+        abort();
+    }
+    if (tid < 0 || (uint32_t) tid >= q->hdr->config.threads_per_proc) {
+        fprintf(stderr, "C23 FAAQueue Error: Invalid TID %d for enqueue.\n", tid);
+        abort();
+    }
+
+    FAAShmHeader_t *hdr = q->hdr;
+    uint32_t const  rec = hazard_index(q, tid);
+    FAAShmHazard_t *hz  = hazard_at(q, rec);
+
+    while (true) {
+        uint32_t const ltail = protect(hz, &hdr->tail);
+        FAAShmNode_t  *node  = node_at(q, ltail);
+
+        uint32_t const idx   = atomic_fetch_add_explicit(&node->enqidx, 1, memory_order_acq_rel);
+
+        if (idx >= FAA_BUFFER_SIZE) {
+            // This node is full.
+            if (ltail != atomic_load_explicit(&hdr->tail, memory_order_acquire)) {
+                continue;
+            }
+            uint32_t lnext = atomic_load_explicit(&node->next, memory_order_acquire);
+            if (lnext == FAA_SHM_NIL) {
+                uint32_t const fresh = node_alloc(q, rec, item);
+                if (fresh == FAA_SHM_NIL) {
+                    unprotect(hz);
+                    return false;
+                }
+                if (atomic_compare_exchange_strong_explicit(
+                        &node->next, &lnext, fresh, memory_order_release, memory_order_acquire
+                    )) {
+                    uint32_t expected = ltail;
+                    atomic_compare_exchange_strong_explicit(
+                        &hdr->tail, &expected, fresh, memory_order_release, memory_order_relaxed
+                    );
+                    unprotect(hz);
+                    return true;
+                }
+                // Another producer linked first; the fresh node was never
+                // published, so it goes straight back to the pool.
+                stack_push(q, &hdr->node_free, node_link, fresh);
+            } else {
+                uint32_t expected = ltail;
+                atomic_compare_exchange_strong_explicit(
+                    &hdr->tail, &expected, lnext, memory_order_release, memory_order_relaxed
+                );
+            }
+            continue;
+        }
+
+        uint64_t expected = FAA_SHM_EMPTY;
+        if (atomic_compare_exchange_strong_explicit(
+                &node->items[idx], &expected, item, memory_order_release, memory_order_relaxed
+            )) {
+            unprotect(hz);
+            return true;
+        }
+    }
+}
+
+uint64_t
+faa_shm_queue_dequeue(FAAShmQueue_t *q, int tid) {
+    assert(q != nullptr);
+
+    if (tid < 0 || (uint32_t) tid >= q->hdr->config.threads_per_proc) {
+        fprintf(stderr, "C23 FAAQueue Error: Invalid TID %d for dequeue.\n", tid);
+        return FAA_SHM_EMPTY;
+    }
+
+    FAAShmHeader_t *hdr = q->hdr;
+    uint32_t const  rec = hazard_index(q, tid);
+    FAAShmHazard_t *hz  = hazard_at(q, rec);
+
+    while (true) {
+        uint32_t const lhead = protect(hz, &hdr->head);
+        FAAShmNode_t  *node  = node_at(q, lhead);
+
+        if (atomic_load_explicit(&node->deqidx, memory_order_acquire)
+                >= atomic_load_explicit(&node->enqidx, memory_order_acquire)
+            && atomic_load_explicit(&node->next, memory_order_acquire) == FAA_SHM_NIL) {
+            break;
+        }
+
+        uint32_t const idx = atomic_fetch_add_explicit(&node->deqidx, 1, memory_order_acq_rel);
+
+        if (idx >= FAA_BUFFER_SIZE) {
+            // This node has been drained; move the head forward.
+            uint32_t const lnext = atomic_load_explicit(&node->next, memory_order_acquire);
+            if (lnext == FAA_SHM_NIL) {
+                break;
+            }
+            uint32_t expected = lhead;
+            if (atomic_compare_exchange_strong_explicit(
+                    &hdr->head, &expected, lnext, memory_order_release, memory_order_relaxed
+                )) {
+                unprotect(hz);
+                retire(q, rec, lhead);
+            }
+            continue;
+        }
+
+        // Give a producer that reserved this slot a moment to store its item
+        // before burning the slot (FAA_WAIT_SPIN).
+        for (uint32_t i = 0; i < FAA_DEFAULT_SPIN_LIMIT; i++) {
+            if (atomic_load_explicit(&node->items[idx], memory_order_relaxed) != FAA_SHM_EMPTY) {
+                break;
+            }
+            faa_cpu_relax();
+        }
+
+        uint64_t const item = atomic_exchange_explicit(&node->items[idx], FAA_SHM_TAKEN, memory_order_acq_rel);
+        if (item == FAA_SHM_EMPTY) {
+            continue;
+        }
+
+        unprotect(hz);
+        return item;
+    }
+
+    unprotect(hz);
+    return FAA_SHM_EMPTY;
+}
+
+// --- Payload Pool ---
+
+uint64_t
+faa_shm_payload_alloc(FAAShmQueue_t *q) {
+    assert(q != nullptr);
+    uint32_t const idx = stack_pop(q, &q->hdr->payload_free, payload_link);
+    if (idx == FAA_SHM_NIL) {
+        return 0;
+    }
+    return q->hdr->payload_off + (uint64_t) idx * q->hdr->config.payload_size;
+}
+
+void
+faa_shm_payload_free(FAAShmQueue_t *q, uint64_t offset) {
+    assert(q != nullptr);
+    FAAShmHeader_t const *hdr = q->hdr;
+    assert(offset >= hdr->payload_off && (offset - hdr->payload_off) % hdr->config.payload_size == 0);
+    uint32_t const idx = (uint32_t) ((offset - hdr->payload_off) / hdr->config.payload_size);
+    assert(idx < hdr->config.payload_slots);
+    stack_push(q, &q->hdr->payload_free, payload_link, idx);
+}
@@ -0,0 +1,242 @@
+#ifndef FAA_SHM_QUEUE_H
+#define FAA_SHM_QUEUE_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "faaq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Inter-process variant of the FAA array queue.
+//
+// Every shared structure lives in one file-backed region (shm_open or memfd)
+// that each process maps at its own address, so nothing in the region holds a
+// pointer: nodes are linked by index and items are 64-bit offsets into the
+// region. Nodes come from a fixed pool inside the region and are reclaimed
+// with hazard pointers whose records also live in the region, keyed by the
+// process slot a process claims when it attaches.
+
+// Layout version, bumped whenever the shared layout changes.
+constexpr static uint32_t FAA_SHM_VERSION         = 1;
+
+// Null node index.
+constexpr static uint32_t FAA_SHM_NIL             = UINT32_MAX;
+
+// Item values reserved by the queue: an empty slot and a consumed slot.
+constexpr static uint64_t FAA_SHM_EMPTY           = 0;
+constexpr static uint64_t FAA_SHM_TAKEN           = UINT64_MAX;
+
+// Defaults used by faa_shm_config_default().
+constexpr static uint32_t FAA_SHM_DEFAULT_PROCS   = 16;
+constexpr static uint32_t FAA_SHM_DEFAULT_THREADS = 4;
+constexpr static uint32_t FAA_SHM_DEFAULT_NODES   = 64;
+constexpr static uint32_t FAA_SHM_DEFAULT_SLOTS   = 16384;
+constexpr static uint32_t FAA_SHM_DEFAULT_PAYLOAD = 256;
+
+typedef struct {
+    alignas(FAA_ALIGNMENT) _Atomic(uint32_t) deqidx;
+
+    alignas(FAA_ALIGNMENT) _Atomic(uint32_t) enqidx;
+
+    // Index of the successor node, FAA_SHM_NIL if none.
+    alignas(FAA_ALIGNMENT) _Atomic(uint32_t) next;
+    // Freelist link, only meaningful while the node is on the freelist.
+    _Atomic(uint32_t)        free_next;
+
+    alignas(FAA_ALIGNMENT) _Atomic(uint64_t) items[FAA_BUFFER_SIZE];
+} FAAShmNode_t;
+
+// One hazard pointer, on its own line. Holds a node index or FAA_SHM_NIL.
+typedef struct {
+    alignas(FAA_ALIGNMENT) _Atomic(uint32_t) node;
+} FAAShmHazard_t;
+
+// Owner of a process slot. 0 means the slot is free.
+typedef struct {
+    alignas(FAA_ALIGNMENT) _Atomic(int32_t) pid;
+} FAAShmProc_t;
+
+/**
+ * @brief Layout parameters, fixed when the region is created.
+ */
+typedef struct {
+    // Processes that can be attached at the same time.
+    uint32_t max_procs;
+    // Threads per process that may use the queue (0 <= tid < threads_per_proc).
+    uint32_t threads_per_proc;
+    // Nodes in the in-region pool. Bounds the queue at roughly
+    // (node_count - 1) * FAA_BUFFER_SIZE items.
+    uint32_t node_count;
+    // Payload buffers and their size in bytes (rounded up to FAA_ALIGNMENT).
+    uint32_t payload_slots;
+    uint32_t payload_size;
+} FAAShmConfig_t;
+
+/**
+ * @brief Header at offset 0 of the region. All offsets are from the region
+ * start.
+ */
+typedef struct {
+    // Set last by the creator; attach fails until it matches.
+    _Atomic(uint64_t) magic;
+    uint32_t          version;
+    uint32_t          buffer_size;
+    uint64_t          region_size;
+    FAAShmConfig_t    config;
+    uint32_t          hazard_count;     // max_procs * threads_per_proc
+    uint32_t          retired_capacity; // per hazard record
+    uint64_t          procs_off;
+    uint64_t          hazards_off;
+    uint64_t          retired_off;
+    uint64_t          nodes_off;
+    uint64_t          payload_off;
+
+    alignas(FAA_ALIGNMENT) _Atomic(uint32_t) head;
+
+    alignas(FAA_ALIGNMENT) _Atomic(uint32_t) tail;
+
+    // Treiber stacks of free node and payload indices. The upper 32 bits hold
+    // a tag that changes on every pop to defeat ABA.
+    alignas(FAA_ALIGNMENT) _Atomic(uint64_t) node_free;
+
+    alignas(FAA_ALIGNMENT) _Atomic(uint64_t) payload_free;
+} FAAShmHeader_t;
+
+/**
+ * @brief Process-local handle to a mapped region.
+ */
+typedef struct {
+    FAAShmHeader_t *hdr;
+    char           *base;
+    size_t          size;
+    int             fd;
+    // Process slot claimed at attach time.
+    int             slot;
+} FAAShmQueue_t;
+
+// ----------------------------------------------------------------------------
+// Public API
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Returns the default layout parameters.
+ */
+FAAShmConfig_t faa_shm_config_default(void);
+
+/**
+ * @brief Creates and initializes a new region and attaches to it.
+ *
+ * @param name Name passed to shm_open() (e.g. "/ingest"), which must not exist
+ * yet. If nullptr, an anonymous memfd is used instead; share it with other
+ * processes through fork() or SCM_RIGHTS and faa_shm_queue_attach_fd().
+ * @param config Layout parameters, or nullptr for the defaults.
+ * @return A handle to the new queue, or nullptr on failure.
+ */
+[[nodiscard("Queue creation failure must be handled")]]
+FAAShmQueue_t *faa_shm_queue_create(char const *name, FAAShmConfig_t const *config);
+
+/**
+ * @brief Attaches to a region created under 'name'.
+ *
+ * Claims a free process slot. A slot whose owner has died is reclaimed: its
+ * hazard pointers are cleared and its pending retired nodes are inherited.
+ *
+ * @return A handle, or nullptr if the region is missing, incompatible or all
+ * process slots are in use.
+ */
+[[nodiscard("Queue attach failure must be handled")]]
+FAAShmQueue_t *faa_shm_queue_attach(char const *name);
+
+/**
+ * @brief Attaches to the region behind 'fd'. The descriptor is duplicated, so
+ * the caller keeps ownership of 'fd'.
+ *
+ * A child created by fork() must call this (or faa_shm_queue_attach()) rather
+ * than use the parent's handle, since the slot belongs to the parent.
+ */
+[[nodiscard("Queue attach failure must be handled")]]
+FAAShmQueue_t *faa_shm_queue_attach_fd(int fd);
+
+/**
+ * @brief Returns the descriptor backing the region.
+ */
+int            faa_shm_queue_fd(FAAShmQueue_t const *q);
+
+/**
+ * @brief Releases the process slot and unmaps the region. No thread of the
+ * calling process may be using the handle.
+ *
+ * Nodes this process retired but could not free yet stay in the region and
+ * are freed by the next process that claims the slot. The region itself
+ * persists until it is unlinked (shm_open) or its last descriptor and mapping
+ * are gone (memfd).
+ */
+void           faa_shm_queue_detach(FAAShmQueue_t *q);
+
+/**
+ * @brief Removes the name of a region created with shm_open().
+ */
+int            faa_shm_queue_unlink(char const *name);
+
+/**
+ * @brief Enqueues an item.
+ *
+ * @param q Handle to the queue.
+ * @param item The item, usually an offset from faa_shm_payload_alloc(). Must
+ * not be FAA_SHM_EMPTY or FAA_SHM_TAKEN.
+ * @param tid The caller's thread ID within its process (0 <= tid <
+ * threads_per_proc).
+ * @return false if the node pool is exhausted. The queue is unchanged.
+ */
+[[nodiscard("A full queue must be handled")]]
+bool           faa_shm_queue_enqueue(FAAShmQueue_t *q, uint64_t item, int tid);
+
+/**
+ * @brief Dequeues an item.
+ *
+ * @param q Handle to the queue.
+ * @param tid The caller's thread ID within its process.
+ * @return The item, or FAA_SHM_EMPTY if the queue is empty.
+ */
+uint64_t       faa_shm_queue_dequeue(FAAShmQueue_t *q, int tid);
+
+/**
+ * @brief Takes a payload buffer from the shared pool.
+ *
+ * @return Offset of the buffer, or 0 if the pool is exhausted. Offsets are
+ * never FAA_SHM_EMPTY or FAA_SHM_TAKEN, so they can be enqueued directly.
+ */
+uint64_t       faa_shm_payload_alloc(FAAShmQueue_t *q);
+
+/**
+ * @brief Returns a payload buffer to the shared pool. Any process may free a
+ * buffer allocated by another one.
+ */
+void           faa_shm_payload_free(FAAShmQueue_t *q, uint64_t offset);
+
+/**
+ * @brief Translates a payload offset into this process's address.
+ */
+static inline void *
+faa_shm_payload_ptr(FAAShmQueue_t const *q, uint64_t offset) {
+    return q->base + offset;
+}
+
+/**
+ * @brief Size in bytes of every payload buffer.
+ */
+static inline size_t
+faa_shm_payload_size(FAAShmQueue_t const *q) {
+    return q->hdr->config.payload_size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAA_SHM_QUEUE_H
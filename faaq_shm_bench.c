@@ -0,0 +1,260 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench_common.h"
+#include "faaq_shm.h"
+
+// Two-process message passing: a producer process hands fixed-size messages
+// to a consumer process, once through the shared-memory queue (payload in the
+// region, offset in the queue) and once over a Unix stream socket, which is
+// what the queue is meant to replace.
+
+static constexpr uint64_t MESSAGES        = 2000000;
+
+static uint32_t const     MESSAGE_SIZES[] = {64, 256, 1024};
+
+// The consumer touches every message so neither transport gets away without
+// moving the bytes. Returns a checksum of the message.
+static inline uint64_t
+consume_message(unsigned char const *msg, size_t size) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, msg + i, sizeof(word));
+        sum += word;
+    }
+    return sum;
+}
+
+// Writes the message sequence number into the first word and fills the rest.
+static inline void
+fill_message(unsigned char *msg, size_t size, uint64_t seq) {
+    memcpy(msg, &seq, sizeof(seq));
+    memset(msg + sizeof(seq), (int) (seq & 0xFF), size - sizeof(seq));
+}
+
+// The child reports readiness over 'ready' once it is set up, so the parent
+// only times the transfer itself.
+static void
+signal_ready(int ready) {
+    char const c = 1;
+    if (write(ready, &c, 1) != 1) {
+        _exit(EXIT_FAILURE);
+    }
+}
+
+static void
+await_ready(int ready) {
+    char c;
+    if (read(ready, &c, 1) != 1) {
+        fprintf(stderr, "Consumer process failed to start.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void
+await_child(pid_t pid) {
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+        fprintf(stderr, "Consumer process failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// --- Shared-Memory Queue ---
+
+static void
+shm_consumer(int fd, int ready, size_t size) {
+    FAAShmQueue_t *q = faa_shm_queue_attach_fd(fd);
+    if (!q) {
+        _exit(EXIT_FAILURE);
+    }
+    bench_pin_thread(1);
+    signal_ready(ready);
+
+    uint64_t sum = 0;
+    for (uint64_t n = 0; n < MESSAGES;) {
+        uint64_t const off = faa_shm_queue_dequeue(q, 0);
+        if (off == FAA_SHM_EMPTY) {
+            sched_yield();
+            continue;
+        }
+        unsigned char const *msg = faa_shm_payload_ptr(q, off);
+        uint64_t             seq;
+        memcpy(&seq, msg, sizeof(seq));
+        if (seq != n) {
+            fprintf(stderr, "FATAL: expected message %w64u, got %w64u\n", n, seq);
+            _exit(EXIT_FAILURE);
+        }
+        sum += consume_message(msg, size);
+        faa_shm_payload_free(q, off);
+        n++;
+    }
+    faa_shm_queue_detach(q);
+    _exit(sum != 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// Returns nanoseconds per message.
+static double
+run_shm(uint32_t size) {
+    FAAShmConfig_t cfg = faa_shm_config_default();
+    cfg.payload_size   = size;
+    FAAShmQueue_t *q   = faa_shm_queue_create(nullptr, &cfg);
+    int            ready[2];
+    if (!q || pipe(ready) != 0) {
+        fprintf(stderr, "Failed to set up the shared-memory run.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t const pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        shm_consumer(faa_shm_queue_fd(q), ready[1], size);
+    }
+    close(ready[1]);
+    bench_pin_thread(0);
+    await_ready(ready[0]);
+
+    uint64_t const start = bench_now_ns();
+    for (uint64_t n = 0; n < MESSAGES; n++) {
+        uint64_t off;
+        // Both pools are bounded; wait for the consumer to return buffers.
+        while ((off = faa_shm_payload_alloc(q)) == 0) {
+            sched_yield();
+        }
+        fill_message(faa_shm_payload_ptr(q, off), size, n);
+        while (!faa_shm_queue_enqueue(q, off, 0)) {
+            sched_yield();
+        }
+    }
+    await_child(pid);
+    uint64_t const elapsed = bench_now_ns() - start;
+
+    close(ready[0]);
+    faa_shm_queue_detach(q);
+    return (double) elapsed / (double) MESSAGES;
+}
+
+// --- Unix Socket Baseline ---
+
+static bool
+read_full(int fd, unsigned char *buf, size_t size) {
+    while (size > 0) {
+        ssize_t const n = read(fd, buf, size);
+        if (n <= 0) {
+            return false;
+        }
+        buf  += n;
+        size -= (size_t) n;
+    }
+    return true;
+}
+
+static bool
+write_full(int fd, unsigned char const *buf, size_t size) {
+    while (size > 0) {
+        ssize_t const n = write(fd, buf, size);
+        if (n <= 0) {
+            return false;
+        }
+        buf  += n;
+        size -= (size_t) n;
+    }
+    return true;
+}
+
+static void
+socket_consumer(int sock, int ready, size_t size) {
+    unsigned char *msg = malloc(size);
+    if (!msg) {
+        _exit(EXIT_FAILURE);
+    }
+    bench_pin_thread(1);
+    signal_ready(ready);
+
+    uint64_t sum = 0;
+    for (uint64_t n = 0; n < MESSAGES; n++) {
+        if (!read_full(sock, msg, size)) {
+            _exit(EXIT_FAILURE);
+        }
+        uint64_t seq;
+        memcpy(&seq, msg, sizeof(seq));
+        if (seq != n) {
+            fprintf(stderr, "FATAL: expected message %w64u, got %w64u\n", n, seq);
+            _exit(EXIT_FAILURE);
+        }
+        sum += consume_message(msg, size);
+    }
+    free(msg);
+    _exit(sum != 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// Returns nanoseconds per message.
+static double
+run_socket(uint32_t size) {
+    int            sv[2], ready[2];
+    unsigned char *msg = malloc(size);
+    if (!msg || socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0 || pipe(ready) != 0) {
+        fprintf(stderr, "Failed to set up the socket run.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t const pid = fork();
+    if (pid == 0) {
+        close(sv[0]);
+        close(ready[0]);
+        socket_consumer(sv[1], ready[1], size);
+    }
+    close(sv[1]);
+    close(ready[1]);
+    bench_pin_thread(0);
+    await_ready(ready[0]);
+
+    uint64_t const start = bench_now_ns();
+    for (uint64_t n = 0; n < MESSAGES; n++) {
+        fill_message(msg, size, n);
+        if (!write_full(sv[0], msg, size)) {
+            fprintf(stderr, "Socket write failed.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    await_child(pid);
+    uint64_t const elapsed = bench_now_ns() - start;
+
+    close(sv[0]);
+    close(ready[0]);
+    free(msg);
+    return (double) elapsed / (double) MESSAGES;
+}
+
+int
+main(void) {
+    printf("--- Two-Process Message Passing (FAAQ Shared Memory vs Unix Socket) ---\n");
+    printf("Messages per run: %w64u, Online CPUs: %d\n", MESSAGES, bench_online_cpus());
+    printf(
+        "%-10s %14s %14s %14s %14s %10s\n", "Size (B)", "shm ns/msg", "shm Mmsg/s", "sock ns/msg", "sock Mmsg/s", "Speedup"
+    );
+
+    for (size_t i = 0; i < sizeof(MESSAGE_SIZES) / sizeof(MESSAGE_SIZES[0]); i++) {
+        double const shm  = run_shm(MESSAGE_SIZES[i]);
+        double const sock = run_socket(MESSAGE_SIZES[i]);
+        printf(
+            "%-10u %14.1f %14.2f %14.1f %14.2f %9.2fx\n",
+            MESSAGE_SIZES[i],
+            shm,
+            1e3 / shm,
+            sock,
+            1e3 / sock,
+            sock / shm
+        );
+    }
+
+    return EXIT_SUCCESS;
+}
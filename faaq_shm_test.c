@@ -0,0 +1,256 @@
+#define _GNU_SOURCE
+#include <assert.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "faaq_shm.h"
+#include "test_common.h"
+
+static constexpr int      SHM_PRODUCERS      = 2;
+static constexpr int      SHM_CONSUMERS      = 2;
+static constexpr uint64_t ITEMS_PER_PRODUCER = 400000;
+static constexpr uint64_t SHM_TOTAL_ITEMS    = (uint64_t) SHM_PRODUCERS * ITEMS_PER_PRODUCER;
+
+// Verification state shared by all test processes (an anonymous shared
+// mapping, separate from the queue region).
+typedef struct {
+    _Atomic(uint64_t) dequeued;
+    _Atomic(bool)     seen[SHM_TOTAL_ITEMS];
+} shared_check_t;
+
+static item_check_t
+item_check_of(shared_check_t *shared) {
+    return (item_check_t) {
+        .seen               = shared->seen,
+        .dequeued           = &shared->dequeued,
+        .producers          = SHM_PRODUCERS,
+        .items_per_producer = ITEMS_PER_PRODUCER,
+    };
+}
+
+static FAAShmConfig_t
+small_config(void) {
+    FAAShmConfig_t cfg = faa_shm_config_default();
+    cfg.node_count     = 4;
+    cfg.payload_slots  = 64;
+    return cfg;
+}
+
+void
+run_basic_tests(void) {
+    printf("--- Starting Basic Shared-Memory Queue Tests ---\n");
+    FAAShmConfig_t const cfg = small_config();
+    FAAShmQueue_t       *q   = faa_shm_queue_create(nullptr, &cfg);
+    assert(q != nullptr);
+
+    assert(faa_shm_queue_dequeue(q, 0) == FAA_SHM_EMPTY);
+    printf("Test 1 (Empty Dequeue): PASSED\n");
+
+    // Test 2: Pass many more items than the pool holds, in batches that span
+    // node boundaries, so that nodes must be retired and reused.
+    uint64_t const batch = FAA_BUFFER_SIZE * 2 + 100;
+    uint64_t       next  = 1;
+    for (int round = 0; round < 20; round++) {
+        for (uint64_t i = 0; i < batch; i++) {
+            assert(faa_shm_queue_enqueue(q, next + i, 0));
+        }
+        for (uint64_t i = 0; i < batch; i++) {
+            uint64_t const item = faa_shm_queue_dequeue(q, 0);
+            if (item != next + i) {
+                fprintf(stderr, "FAILED! Expected %w64u, got %w64u\n", next + i, item);
+                assert(false);
+            }
+        }
+        next += batch;
+    }
+    assert(faa_shm_queue_dequeue(q, 0) == FAA_SHM_EMPTY);
+    printf("Test 2 (FIFO With Node Reuse): PASSED\n");
+
+    // Test 3: A full pool makes enqueue fail without losing items, and the
+    // queue recovers once it is drained.
+    uint64_t accepted = 0;
+    while (faa_shm_queue_enqueue(q, accepted + 1, 0)) {
+        accepted++;
+    }
+    assert(accepted >= (uint64_t) (cfg.node_count - 2) * FAA_BUFFER_SIZE);
+    for (uint64_t i = 0; i < accepted; i++) {
+        assert(faa_shm_queue_dequeue(q, 0) == i + 1);
+    }
+    assert(faa_shm_queue_dequeue(q, 0) == FAA_SHM_EMPTY);
+    assert(faa_shm_queue_enqueue(q, 42, 0));
+    assert(faa_shm_queue_dequeue(q, 0) == 42);
+    printf("Test 3 (Pool Exhaustion, %w64u items accepted): PASSED\n", accepted);
+
+    // Test 4: Payload buffers are distinct, aligned and recycled.
+    uint64_t offsets[64];
+    for (uint32_t i = 0; i < cfg.payload_slots; i++) {
+        offsets[i] = faa_shm_payload_alloc(q);
+        assert(offsets[i] != 0 && offsets[i] % FAA_ALIGNMENT == 0);
+        for (uint32_t j = 0; j < i; j++) {
+            assert(offsets[j] != offsets[i]);
+        }
+        *(uint32_t *) faa_shm_payload_ptr(q, offsets[i]) = i;
+    }
+    assert(faa_shm_payload_alloc(q) == 0);
+    faa_shm_payload_free(q, offsets[7]);
+    assert(faa_shm_payload_alloc(q) == offsets[7]);
+    for (uint32_t i = 0; i < cfg.payload_slots; i++) {
+        faa_shm_payload_free(q, offsets[i]);
+    }
+    printf("Test 4 (Payload Pool): PASSED\n");
+
+    // Test 5: A second handle (its own process slot) sees the same queue.
+    FAAShmQueue_t *other = faa_shm_queue_attach_fd(faa_shm_queue_fd(q));
+    assert(other != nullptr && other->slot != q->slot);
+    uint64_t const off = faa_shm_payload_alloc(q);
+    *(uint64_t *) faa_shm_payload_ptr(q, off) = 0xC0FFEE;
+    assert(faa_shm_queue_enqueue(q, off, 0));
+    uint64_t const got = faa_shm_queue_dequeue(other, 0);
+    assert(got == off && *(uint64_t *) faa_shm_payload_ptr(other, got) == 0xC0FFEE);
+    faa_shm_payload_free(other, got);
+    faa_shm_queue_detach(other);
+    printf("Test 5 (Second Attachment): PASSED\n");
+
+    faa_shm_queue_detach(q);
+    printf("Basic tests finished successfully.\n");
+}
+
+void
+run_dead_owner_test(void) {
+    printf("\n--- Starting Dead Process Slot Test ---\n");
+    FAAShmConfig_t cfg = small_config();
+    cfg.max_procs      = 2;
+    FAAShmQueue_t *q   = faa_shm_queue_create(nullptr, &cfg);
+    assert(q != nullptr);
+
+    // The child takes the last slot and exits without detaching.
+    pid_t const pid = fork();
+    if (pid == 0) {
+        FAAShmQueue_t *child = faa_shm_queue_attach_fd(faa_shm_queue_fd(q));
+        if (!child || !faa_shm_queue_enqueue(child, 7, 0)) {
+            _exit(EXIT_FAILURE);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+
+    FAAShmQueue_t *heir = faa_shm_queue_attach_fd(faa_shm_queue_fd(q));
+    assert(heir != nullptr);
+    assert(faa_shm_queue_dequeue(heir, 0) == 7);
+    faa_shm_queue_detach(heir);
+    faa_shm_queue_detach(q);
+    printf("DEAD OWNER SUCCESS: Slot of an exited process was reclaimed.\n");
+}
+
+static void
+producer_process(int fd, int producer) {
+    FAAShmQueue_t *q = faa_shm_queue_attach_fd(fd);
+    if (!q) {
+        _exit(EXIT_FAILURE);
+    }
+    for (uint64_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+        // The pool is bounded; wait for consumers to free nodes.
+        while (!faa_shm_queue_enqueue(q, encode_item_u64((uint64_t) producer, i), 0)) {
+            sched_yield();
+        }
+    }
+    faa_shm_queue_detach(q);
+    _exit(EXIT_SUCCESS);
+}
+
+static void
+consumer_process(int fd, int consumer, shared_check_t *shared) {
+    FAAShmQueue_t *q = faa_shm_queue_attach_fd(fd);
+    if (!q) {
+        _exit(EXIT_FAILURE);
+    }
+
+    // A failed check aborts, which the parent sees as a failed child.
+    item_check_t const check = item_check_of(shared);
+    item_order_t       order;
+    item_order_init(&order);
+    while (item_check_pending(&check)) {
+        uint64_t const item = faa_shm_queue_dequeue(q, 0);
+        if (item == FAA_SHM_EMPTY) {
+            sched_yield();
+            continue;
+        }
+        item_check_consume(&check, &order, consumer, item);
+    }
+    faa_shm_queue_detach(q);
+    _exit(EXIT_SUCCESS);
+}
+
+void
+run_multiprocess_test(void) {
+    printf("\n--- Starting Multi-Process Stress Test ---\n");
+    printf("Producer processes: %d, Consumer processes: %d\n", SHM_PRODUCERS, SHM_CONSUMERS);
+
+    FAAShmConfig_t const cfg = small_config();
+    FAAShmQueue_t       *q   = faa_shm_queue_create(nullptr, &cfg);
+    shared_check_t      *check =
+        mmap(nullptr, sizeof(shared_check_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (!q || check == MAP_FAILED) {
+        fprintf(stderr, "Failed to set up the multi-process test.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t pids[SHM_PRODUCERS + SHM_CONSUMERS];
+    for (int i = 0; i < SHM_PRODUCERS + SHM_CONSUMERS; i++) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            perror("fork");
+            exit(EXIT_FAILURE);
+        }
+        if (pids[i] == 0) {
+            if (i < SHM_PRODUCERS) {
+                producer_process(faa_shm_queue_fd(q), i);
+            } else {
+                consumer_process(faa_shm_queue_fd(q), i - SHM_PRODUCERS, check);
+            }
+        }
+    }
+
+    bool success = true;
+    for (int i = 0; i < SHM_PRODUCERS + SHM_CONSUMERS; i++) {
+        int status = 0;
+        waitpid(pids[i], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            fprintf(stderr, "ERROR: Child process %d failed.\n", i);
+            success = false;
+        }
+    }
+
+    item_check_t const items = item_check_of(check);
+    success                  = success && item_check_complete(&items);
+    if (faa_shm_queue_dequeue(q, 0) != FAA_SHM_EMPTY) {
+        fprintf(stderr, "ERROR: Queue not empty after test completion!\n");
+        success = false;
+    }
+    faa_shm_queue_detach(q);
+    munmap(check, sizeof(shared_check_t));
+
+    if (!success) {
+        printf("SHM FAILURE: verification failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("SHM SUCCESS: Exactly-once and per-producer order verified across processes.\n");
+}
+
+int
+main(void) {
+    run_basic_tests();
+    run_dead_owner_test();
+    run_multiprocess_test();
+
+    printf("\nAll shared-memory queue tests completed successfully.\n");
+    return EXIT_SUCCESS;
+}
@@ -252,6 +252,7 @@ domain_do_reclamation(hazptr_domain_t *domain, hazptr_count_t claimed_count) {
     while (true) {
         hazptr_obj_t *retired_lists[HP_NUM_SHARDS];
         bool          extracted_any = false;
+        bool          reclaimed_any = false;
 
         // Extract retired objects from all shards atomically.
         for (int i = 0; i < HP_NUM_SHARDS; ++i) {
@@ -307,6 +308,7 @@ domain_do_reclamation(hazptr_domain_t *domain, hazptr_count_t claimed_count) {
                         if (current->reclaim) {
                             current->reclaim(current);
                         }
+                        reclaimed_any = true;
                         // Adjust the count of items we are responsible for.
                         // Can go negative if we reclaim more than initially claimed.
                         rcount--;
@@ -349,7 +351,14 @@ domain_do_reclamation(hazptr_domain_t *domain, hazptr_count_t claimed_count) {
             if (done) {
                 break; // Exit the reclamation loop.
             }
-            // If not done but rcount is 0, loop again to process remaining items.
+            // Objects that are still protected went back to shard 0. If this
+            // pass reclaimed nothing, another pass would only spin until their
+            // holders move on, which a preempted holder may not do for a whole
+            // time slice. Leave them for the next reclamation.
+            if (!reclaimed_any) {
+                break;
+            }
+            // Otherwise loop again to process remaining items.
         }
     }
 
@@ -454,3 +463,9 @@ hazptr_cleanup(void) {
 
     domain_do_reclamation(domain, rcount);
 }
+
+hazptr_count_t
+hazptr_retired_count(void) {
+    hazptr_count_t const rcount = atomic_load_explicit(&default_domain.retired_count, memory_order_relaxed);
+    return rcount > 0 ? rcount : 0;
+}
@@ -8,11 +8,27 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define HP_CACHE_LINE_SIZE   64   // Assumed cache line size for alignment
+
+// Reclamation tuning. Overridable at build time (e.g. -DHP_NUM_SHARDS=16 in
+// CFLAGS) so that hp_bench can compare settings; the library and its users
+// must be built with the same values.
+#ifndef HP_TLC_CAPACITY
 #define HP_TLC_CAPACITY      8    // Capacity of the Thread Local Cache
+#endif
+#ifndef HP_NUM_SHARDS
 #define HP_NUM_SHARDS        8    // Number of retired list shards (MUST be power of 2)
+#endif
+#ifndef HP_RCOUNT_THRESHOLD
 #define HP_RCOUNT_THRESHOLD  1000 // Base threshold for reclamation
+#endif
+#ifndef HP_HCOUNT_MULTIPLIER
 #define HP_HCOUNT_MULTIPLIER 2    // Dynamic threshold multiplier
+#endif
 
 // ----------------------------------------------------------------------------
 // Forward Declarations and Types
@@ -43,9 +59,21 @@ void hazptr_retire(hazptr_obj_t *obj, hazptr_reclaim_fn reclaim_fn);
 
 /**
  * @brief Manually triggers reclamation. Useful for shutdown or testing.
+ *
+ * Reclaims every retired object that is not protected. Objects that are still
+ * protected stay retired until a later reclamation; the call does not wait for
+ * their holders. If another thread is already reclaiming, returns at once.
  */
 void hazptr_cleanup(void);
 
+/**
+ * @brief Returns the number of retired objects awaiting reclamation.
+ *
+ * A relaxed snapshot for monitoring. Objects claimed by a reclamation scan in
+ * progress are not counted, so the value can dip while a scan runs.
+ */
+hazptr_count_t hazptr_retired_count(void);
+
 struct hazptr_rec {
     alignas(HP_CACHE_LINE_SIZE) _Atomic(void const *) ptr;
     hazptr_rec_t    *next;
@@ -80,6 +108,13 @@ hazptr_reset(hazptr_holder_t *h, void const *ptr) {
     }
 }
 
+// The unqualified pointer type held by an atomic source.
+#ifdef __cplusplus
+#define HAZPTR_VALUE_TYPE_(src_ptr_) decltype(atomic_load_explicit((src_ptr_), memory_order_relaxed))
+#else
+#define HAZPTR_VALUE_TYPE_(src_ptr_) typeof_unqual(*(src_ptr_))
+#endif
+
 /**
  * @brief Macro for the standard Load-Protect-Validate pattern.
  *
@@ -97,12 +132,12 @@ hazptr_reset(hazptr_holder_t *h, void const *ptr) {
  * @param h_ Pointer to the hazptr_holder_t.
  * @param src_ptr_ Pointer to the atomic source pointer (_Atomic(T*)*).
  */
-// Utilizes C23 typeof_unqual for type safety.
+// Utilizes C23 typeof_unqual for type safety (decltype when compiled as C++).
 #define HAZPTR_PROTECT(result_, h_, src_ptr_)                                                                          \
     do {                                                                                                               \
         /* Determine the raw pointer type (e.g., T*) */                                                                \
-        typeof_unqual(*(src_ptr_)) p_;                                                                                 \
-        typeof_unqual(*(src_ptr_)) v_;                                                                                 \
+        HAZPTR_VALUE_TYPE_(src_ptr_) p_;                                                                               \
+        HAZPTR_VALUE_TYPE_(src_ptr_) v_;                                                                               \
                                                                                                                        \
         /* Initial relaxed load optimization */                                                                        \
         p_ = atomic_load_explicit((src_ptr_), memory_order_relaxed);                                                   \
@@ -127,4 +162,8 @@ hazptr_reset(hazptr_holder_t *h, void const *ptr) {
         }                                                                                                              \
     } while (0)
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // HP_H
@@ -0,0 +1,431 @@
+#define _GNU_SOURCE
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "bench_common.h"
+#include "hp.h"
+
+// Microbenchmarks for the hazard pointer domain in hp.c: the cost of
+// HAZPTR_PROTECT with and without a writer moving the source pointer,
+// hazptr_retire throughput as threads are added, the time a reclamation scan
+// takes as hazard pointer records accumulate, and holder init/destroy with
+// the thread local cache hitting and missing. Changes to HP_TLC_CAPACITY,
+// HP_NUM_SHARDS or HP_RCOUNT_THRESHOLD should be measured here; all of them
+// can be set from CFLAGS.
+//
+// The domain is global and never shrinks, so the sections run from the one
+// that grows it least to the one that grows it most.
+
+static constexpr uint64_t PROTECT_OPS     = 10000000;
+static constexpr uint64_t RETIRES_PER_RUN = 2000000;
+static constexpr int      SCAN_ROUNDS     = 64;
+static constexpr int      SCAN_BATCH      = 512;
+static constexpr uint64_t HOLDER_OPS      = 2000000;
+static constexpr int      HOLDER_BATCH    = 64;
+
+static int const          HPREC_COUNTS[]  = {16, 64, 256, 1024, 4096};
+
+typedef struct {
+    hazptr_obj_t base;
+    uint64_t     payload;
+} bench_obj_t;
+
+// Per-thread result, padded so threads never share a line.
+typedef struct {
+    alignas(128) uint64_t cycles;
+    uint64_t ops;
+} thread_slot_t;
+
+static bench_barrier_t      g_barrier;
+static atomic_uint_fast64_t g_reclaimed;
+
+static void
+obj_reclaim(hazptr_obj_t *obj) {
+    ((bench_obj_t *) obj)->payload = 0;
+    atomic_fetch_add_explicit(&g_reclaimed, 1, memory_order_relaxed);
+}
+
+// Thread counts 1, 2, 4, ... up to the online CPUs, always ending there.
+static int
+next_threads(int threads) {
+    int const max = bench_online_cpus();
+    if (threads >= max) {
+        return 0;
+    }
+    return threads * 2 < max ? threads * 2 : max;
+}
+
+static thrd_t *
+start_threads(int n, thrd_start_t fn, void *args, size_t arg_size) {
+    thrd_t *threads = calloc((size_t) n, sizeof(thrd_t));
+    if (!threads) {
+        fprintf(stderr, "Failed to allocate benchmark state.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (thrd_create(&threads[i], fn, (char *) args + (size_t) i * arg_size) != thrd_success) {
+            fprintf(stderr, "Failed to create thread %d.\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return threads;
+}
+
+static void
+join_threads(thrd_t *threads, int n) {
+    for (int i = 0; i < n; ++i) {
+        thrd_join(threads[i], nullptr);
+    }
+    free(threads);
+}
+
+// --- HAZPTR_PROTECT Cost ---
+//
+// Readers protect the same source pointer in a loop and read through it. In
+// the contended case one more thread keeps storing a different object into
+// the source, so readers take cache misses on it and fail validation. A plain
+// acquire load of the source is the floor.
+
+typedef enum {
+    READ_LOAD,
+    READ_PROTECT,
+} read_mode_t;
+
+typedef struct {
+    alignas(128) _Atomic(bench_obj_t *) source;
+    alignas(128) atomic_bool stop;
+    bench_obj_t    objs[2];
+    read_mode_t    mode;
+    thread_slot_t *slots;
+} protect_ctx_t;
+
+typedef struct {
+    protect_ctx_t *ctx;
+    int            tid;
+} protect_arg_t;
+
+static int
+protect_reader(void *arg) {
+    protect_arg_t const *a   = arg;
+    protect_ctx_t       *ctx = a->ctx;
+    hazptr_holder_t      h;
+    uint64_t             sum = 0;
+    bench_pin_thread(a->tid);
+    hazptr_holder_init(&h);
+
+    bench_barrier_wait(&g_barrier);
+    uint64_t const start = RDTSC();
+    if (ctx->mode == READ_LOAD) {
+        for (uint64_t i = 0; i < PROTECT_OPS; ++i) {
+            sum += atomic_load_explicit(&ctx->source, memory_order_acquire)->payload;
+        }
+    } else {
+        for (uint64_t i = 0; i < PROTECT_OPS; ++i) {
+            bench_obj_t *p;
+            HAZPTR_PROTECT(p, &h, &ctx->source);
+            sum += p->payload;
+        }
+    }
+    uint64_t const end = RDTSC();
+
+    hazptr_holder_destroy(&h);
+    ctx->slots[a->tid].cycles = end - start;
+    ctx->slots[a->tid].ops    = sum; // Keeps the loads alive.
+    return 0;
+}
+
+static int
+protect_writer(void *arg) {
+    protect_arg_t const *a      = arg;
+    protect_ctx_t       *ctx    = a->ctx;
+    uint64_t             stores = 0;
+    bench_pin_thread(a->tid);
+
+    bench_barrier_wait(&g_barrier);
+    while (!atomic_load_explicit(&ctx->stop, memory_order_relaxed)) {
+        atomic_store_explicit(&ctx->source, &ctx->objs[stores & 1], memory_order_release);
+        stores++;
+    }
+    ctx->slots[a->tid].ops = stores;
+    return 0;
+}
+
+// Returns cycles per read, averaged over the readers.
+static double
+run_protect(int readers, read_mode_t mode, bool writer) {
+    int const      threads_n = readers + writer;
+    protect_ctx_t *ctx       = aligned_alloc(128, sizeof(protect_ctx_t));
+    thread_slot_t *slots     = aligned_alloc(128, (size_t) threads_n * sizeof(thread_slot_t));
+    protect_arg_t *args      = calloc((size_t) threads_n, sizeof(protect_arg_t));
+    if (!ctx || !slots || !args || !bench_barrier_init(&g_barrier, threads_n + 1)) {
+        fprintf(stderr, "Failed to allocate benchmark state.\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->objs[0] = (bench_obj_t) {.payload = 1};
+    ctx->objs[1] = (bench_obj_t) {.payload = 2};
+    ctx->mode    = mode;
+    ctx->slots   = slots;
+    atomic_init(&ctx->source, &ctx->objs[0]);
+    atomic_init(&ctx->stop, false);
+    for (int tid = 0; tid < threads_n; ++tid) {
+        args[tid] = (protect_arg_t) {.ctx = ctx, .tid = tid};
+    }
+
+    thrd_t *reader_threads = start_threads(readers, protect_reader, args, sizeof(protect_arg_t));
+    thrd_t *writer_threads = nullptr;
+    if (writer) {
+        writer_threads = start_threads(1, protect_writer, &args[readers], sizeof(protect_arg_t));
+    }
+    bench_barrier_wait(&g_barrier);
+    join_threads(reader_threads, readers);
+    atomic_store_explicit(&ctx->stop, true, memory_order_relaxed);
+    if (writer) {
+        join_threads(writer_threads, 1);
+    }
+
+    uint64_t cycles = 0;
+    for (int tid = 0; tid < readers; ++tid) {
+        cycles += slots[tid].cycles;
+    }
+    bench_barrier_destroy(&g_barrier);
+    free(args);
+    free(slots);
+    free(ctx);
+    return (double) cycles / ((double) readers * PROTECT_OPS);
+}
+
+static void
+run_protect_benchmark(void) {
+    printf("\n--- HAZPTR_PROTECT Cost (%w64u reads per thread) ---\n", PROTECT_OPS);
+    printf("%8s %14s %14s %16s %10s\n", "Readers", "Load cyc", "Protect cyc", "Contended cyc", "Overhead");
+    for (int readers = 1; readers != 0; readers = next_threads(readers)) {
+        double const load      = run_protect(readers, READ_LOAD, false);
+        double const protect   = run_protect(readers, READ_PROTECT, false);
+        double const contended = run_protect(readers, READ_PROTECT, true);
+        printf("%8d %14.2f %14.2f %16.2f %9.1fx\n", readers, load, protect, contended, protect / load);
+    }
+}
+
+// --- Retire Throughput ---
+//
+// Every thread retires its share of RETIRES_PER_RUN objects that nobody
+// protects. Whoever pushes the retired count over the threshold runs the
+// scan inline, so the cost per retire includes the amortized reclamation.
+
+typedef struct {
+    bench_obj_t   *objs;
+    uint64_t       count;
+    thread_slot_t *slot;
+    int            tid;
+} retire_arg_t;
+
+static int
+retire_worker(void *arg) {
+    retire_arg_t const *a = arg;
+    bench_pin_thread(a->tid);
+
+    bench_barrier_wait(&g_barrier);
+    uint64_t const start = RDTSC();
+    for (uint64_t i = 0; i < a->count; ++i) {
+        hazptr_retire(&a->objs[i].base, obj_reclaim);
+    }
+    a->slot->cycles = RDTSC() - start;
+    return 0;
+}
+
+static void
+run_retire_benchmark(void) {
+    printf("\n--- hazptr_retire Throughput (%w64u retires per run) ---\n", RETIRES_PER_RUN);
+    printf("%8s %14s %14s %16s\n", "Threads", "Mretires/s", "Cycles/retire", "Reclaimed inline");
+    for (int threads = 1; threads != 0; threads = next_threads(threads)) {
+        uint64_t const per_thread = RETIRES_PER_RUN / (uint64_t) threads;
+        bench_obj_t   *objs       = calloc(per_thread * (uint64_t) threads, sizeof(bench_obj_t));
+        thread_slot_t *slots      = aligned_alloc(128, (size_t) threads * sizeof(thread_slot_t));
+        retire_arg_t  *args       = calloc((size_t) threads, sizeof(retire_arg_t));
+        if (!objs || !slots || !args || !bench_barrier_init(&g_barrier, threads + 1)) {
+            fprintf(stderr, "Failed to allocate benchmark state.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int tid = 0; tid < threads; ++tid) {
+            args[tid] = (retire_arg_t) {
+                .objs = objs + per_thread * (uint64_t) tid, .count = per_thread, .slot = &slots[tid], .tid = tid
+            };
+        }
+        atomic_store_explicit(&g_reclaimed, 0, memory_order_relaxed);
+
+        thrd_t *workers = start_threads(threads, retire_worker, args, sizeof(retire_arg_t));
+        bench_barrier_wait(&g_barrier);
+        uint64_t const start_ns = bench_now_ns();
+        join_threads(workers, threads);
+        uint64_t const elapsed_ns = bench_now_ns() - start_ns;
+
+        // Whatever is left below the threshold is reclaimed here.
+        uint64_t const total            = per_thread * (uint64_t) threads;
+        uint64_t const reclaimed_inline = atomic_load_explicit(&g_reclaimed, memory_order_relaxed);
+        hazptr_cleanup();
+        uint64_t const reclaimed = atomic_load_explicit(&g_reclaimed, memory_order_relaxed);
+        if (reclaimed != total) {
+            fprintf(stderr, "Error: %w64u of %w64u objects reclaimed.\n", reclaimed, total);
+            exit(EXIT_FAILURE);
+        }
+
+        uint64_t cycles = 0;
+        for (int tid = 0; tid < threads; ++tid) {
+            cycles += slots[tid].cycles;
+        }
+        printf(
+            "%8d %14.2f %14.2f %15.1f%%\n",
+            threads,
+            (double) total * 1e3 / (double) elapsed_ns,
+            (double) cycles / (double) total,
+            100.0 * (double) reclaimed_inline / (double) total
+        );
+        bench_barrier_destroy(&g_barrier);
+        free(args);
+        free(slots);
+        free(objs);
+    }
+}
+
+// --- Scan Time vs Records ---
+//
+// Holds 'count' holders, each protecting a distinct address, retires a batch
+// that stays below the threshold and times hazptr_cleanup(). The scan walks
+// every record the domain has ever allocated, so its cost grows with the
+// peak number of holders, not the current one.
+
+static void
+run_scan_benchmark(void) {
+    printf("\n--- Reclamation Scan Time (%d objects retired per scan) ---\n", SCAN_BATCH);
+    printf("%10s %14s %12s %14s %14s\n", "Records", "Median cyc", "Median us", "Cyc/record", "Cyc/object");
+
+    size_t const     n_counts      = sizeof(HPREC_COUNTS) / sizeof(HPREC_COUNTS[0]);
+    int const        max_count     = HPREC_COUNTS[n_counts - 1];
+    double const     cycles_per_ns = bench_cycles_per_ns();
+    double           samples[SCAN_ROUNDS], scratch[SCAN_ROUNDS];
+    bench_obj_t     *objs          = calloc(SCAN_BATCH, sizeof(bench_obj_t));
+    hazptr_holder_t *holders       = calloc((size_t) max_count, sizeof(hazptr_holder_t));
+    // Protected addresses, distinct from every retired object.
+    char            *dummies       = malloc((size_t) max_count);
+    if (!objs || !holders || !dummies) {
+        fprintf(stderr, "Failed to allocate benchmark state.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t c = 0; c < n_counts; ++c) {
+        int const count = HPREC_COUNTS[c];
+        for (int i = 0; i < count; ++i) {
+            hazptr_holder_init(&holders[i]);
+            hazptr_reset(&holders[i], dummies + i);
+        }
+
+        for (int round = 0; round < SCAN_ROUNDS; ++round) {
+            for (int i = 0; i < SCAN_BATCH; ++i) {
+                hazptr_retire(&objs[i].base, obj_reclaim);
+            }
+            uint64_t const start = RDTSC();
+            hazptr_cleanup();
+            samples[round] = (double) (RDTSC() - start);
+        }
+
+        bench_summary_t s;
+        bench_summarize(samples, SCAN_ROUNDS, scratch, &s);
+        printf(
+            "%10d %14.0f %12.2f %14.2f %14.2f\n",
+            count,
+            s.median,
+            s.median / cycles_per_ns / 1e3,
+            s.median / count,
+            s.median / SCAN_BATCH
+        );
+
+        for (int i = 0; i < count; ++i) {
+            hazptr_holder_destroy(&holders[i]);
+        }
+    }
+    free(dummies);
+    free(holders);
+    free(objs);
+}
+
+// --- Holder Init/Destroy ---
+//
+// A hit pairs hazptr_holder_init with hazptr_holder_destroy on a warm thread
+// local cache. For misses the cache is first emptied by pinning its records
+// in other holders, so every init pops the domain's shared stack, and then
+// refilled, so every destroy pushes back onto it.
+
+static void
+run_holder_benchmark(void) {
+    printf("\n--- Holder Init/Destroy (TLC capacity %d) ---\n", HP_TLC_CAPACITY);
+    printf("%-18s %14s\n", "Path", "Cycles/op");
+
+    hazptr_holder_t h;
+    uint64_t        start = RDTSC();
+    for (uint64_t i = 0; i < HOLDER_OPS; ++i) {
+        hazptr_holder_init(&h);
+        hazptr_holder_destroy(&h);
+    }
+    printf("%-18s %14.2f\n", "init+destroy, hit", (double) (RDTSC() - start) / HOLDER_OPS);
+
+    hazptr_holder_t pins[HP_TLC_CAPACITY], batch[HOLDER_BATCH];
+    // Make sure the domain stack holds enough records for a whole batch.
+    for (int i = 0; i < HP_TLC_CAPACITY; ++i) {
+        hazptr_holder_init(&pins[i]);
+    }
+    for (int i = 0; i < HOLDER_BATCH; ++i) {
+        hazptr_holder_init(&batch[i]);
+    }
+    for (int i = 0; i < HOLDER_BATCH; ++i) {
+        hazptr_holder_destroy(&batch[i]);
+    }
+    for (int i = 0; i < HP_TLC_CAPACITY; ++i) {
+        hazptr_holder_destroy(&pins[i]);
+    }
+
+    uint64_t       init_cycles = 0, destroy_cycles = 0;
+    uint64_t const rounds      = HOLDER_OPS / HOLDER_BATCH;
+    for (uint64_t r = 0; r < rounds; ++r) {
+        for (int i = 0; i < HP_TLC_CAPACITY; ++i) {
+            hazptr_holder_init(&pins[i]);
+        }
+        start = RDTSC();
+        for (int i = 0; i < HOLDER_BATCH; ++i) {
+            hazptr_holder_init(&batch[i]);
+        }
+        init_cycles += RDTSC() - start;
+
+        for (int i = 0; i < HP_TLC_CAPACITY; ++i) {
+            hazptr_holder_destroy(&pins[i]);
+        }
+        start = RDTSC();
+        for (int i = 0; i < HOLDER_BATCH; ++i) {
+            hazptr_holder_destroy(&batch[i]);
+        }
+        destroy_cycles += RDTSC() - start;
+    }
+    printf("%-18s %14.2f\n", "init, miss", (double) init_cycles / (double) (rounds * HOLDER_BATCH));
+    printf("%-18s %14.2f\n", "destroy, miss", (double) destroy_cycles / (double) (rounds * HOLDER_BATCH));
+}
+
+int
+main(void) {
+    printf("--- Hazard Pointer Benchmarks ---\n");
+    printf(
+        "Online CPUs: %d, HP_TLC_CAPACITY: %d, HP_NUM_SHARDS: %d, HP_RCOUNT_THRESHOLD: %d\n",
+        bench_online_cpus(),
+        HP_TLC_CAPACITY,
+        HP_NUM_SHARDS,
+        HP_RCOUNT_THRESHOLD
+    );
+
+    run_holder_benchmark();
+    run_protect_benchmark();
+    run_retire_benchmark();
+    run_scan_benchmark();
+    return EXIT_SUCCESS;
+}
@@ -139,19 +139,85 @@ verify_results(void) {
     uint64_t created   = atomic_load(&g_objects_created);
     uint64_t reclaimed = atomic_load(&g_objects_reclaimed);
     uint64_t read_ops  = atomic_load(&g_read_operations);
+    int64_t  backlog   = hazptr_retired_count();
 
     printf("\n--- Verification Results ---\n");
     printf("Total Read Operations: %w64u\n", read_ops);
     printf("Objects Created:       %w64u\n", created);
     printf("Objects Reclaimed:     %w64u\n", reclaimed);
+    printf("Retired Backlog:       %w64d\n", backlog);
     printf("----------------------------\n");
 
-    return created == reclaimed;
+    return created == reclaimed && backlog == 0;
+}
+
+// --- Reclamation With a Pinned Object ---
+
+// Kept protected by pin_holder_thread until g_pin_release is set, like a
+// reader preempted in the middle of a read.
+_Atomic(Node_t *) g_pinned            = nullptr;
+_Atomic(bool)     g_pin_ready         = false;
+_Atomic(bool)     g_pin_release       = false;
+
+int
+pin_holder_thread(void *arg) {
+    (void) arg;
+    hazptr_holder_t h;
+    hazptr_holder_init(&h);
+    Node_t *pinned;
+    HAZPTR_PROTECT(pinned, &h, &g_pinned);
+    atomic_store_explicit(&g_pin_ready, true, memory_order_release);
+
+    while (!atomic_load_explicit(&g_pin_release, memory_order_acquire)) {
+        thrd_sleep(&(struct timespec) { .tv_nsec = 1000000 }, nullptr);
+    }
+    assert(pinned->magic == MAGIC_NUMBER);
+    hazptr_holder_destroy(&h);
+    return 0;
+}
+
+// A retired object that stays protected must neither keep the reclaimer
+// looping nor hold back other objects that can be reclaimed.
+static void
+run_pinned_object_test(void) {
+    printf("Pinned Object Reclamation: ");
+    uint64_t const others = 3 * HP_RCOUNT_THRESHOLD;
+
+    atomic_store(&g_pinned, node_create(UINT64_MAX));
+    thrd_t holder;
+    if (thrd_create(&holder, pin_holder_thread, nullptr) != thrd_success) {
+        perror("Failed to create holder thread");
+        exit(EXIT_FAILURE);
+    }
+    while (!atomic_load_explicit(&g_pin_ready, memory_order_acquire)) {
+        thrd_yield();
+    }
+
+    uint64_t const reclaimed_before = atomic_load(&g_objects_reclaimed);
+    Node_t *const  pinned           = atomic_exchange(&g_pinned, nullptr);
+    hazptr_retire(&pinned->base, node_reclaim);
+    // Enough retirements to trigger reclamation from hazptr_retire() itself.
+    for (uint64_t i = 0; i < others; ++i) {
+        hazptr_retire(&node_create(i)->base, node_reclaim);
+    }
+    hazptr_cleanup();
+    assert(atomic_load(&g_objects_reclaimed) - reclaimed_before == others);
+    assert(hazptr_retired_count() == 1);
+
+    atomic_store_explicit(&g_pin_release, true, memory_order_release);
+    thrd_join(holder, nullptr);
+    hazptr_cleanup();
+    assert(atomic_load(&g_objects_reclaimed) - reclaimed_before == others + 1);
+    assert(hazptr_retired_count() == 0);
+    printf("PASSED\n\n");
 }
 
 int
 main(void) {
     printf("C23 Hazard Pointer Concurrent MWMR Stress Test\n");
+
+    run_pinned_object_test();
+
     printf("Readers: %d, Writers: %d, Duration: %dms\n", NUM_READERS, NUM_WRITERS, TEST_DURATION_MS);
 
     atomic_store(&g_shared_ptr, node_create(0));
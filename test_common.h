@@ -0,0 +1,136 @@
+#ifndef FAAQ_TEST_COMMON_H
+#define FAAQ_TEST_COMMON_H
+
+// Helpers shared by the stress tests. Header-only; every function is static so
+// each test gets its own copy.
+//
+// Producers push items that encode the producer in the high bits and a 1-based
+// sequence number in the low bits, so an item is never nullptr (or
+// FAA_SHM_EMPTY). Consumers pass every item they dequeue to
+// item_check_consume(), which checks that each item arrives exactly once and
+// that a consumer sees each producer's items in increasing order.
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr int ITEM_CHECK_MAX_PRODUCERS = 64;
+
+// --- Item Encoding ---
+
+static inline uint64_t
+encode_item_u64(uint64_t producer, uint64_t seq) {
+    return (producer << 32) | (seq + 1);
+}
+
+static inline void
+decode_item_u64(uint64_t item, uint64_t *producer, uint64_t *seq) {
+    *producer = item >> 32;
+    *seq      = (item & 0xFFFFFFFFu) - 1;
+}
+
+static inline void *
+encode_item(uint64_t producer, uint64_t seq) {
+    return (void *) (uintptr_t) encode_item_u64(producer, seq);
+}
+
+static inline void
+decode_item(void *item, uint64_t *producer, uint64_t *seq) {
+    decode_item_u64((uint64_t) (uintptr_t) item, producer, seq);
+}
+
+// --- Exactly-Once and Order Checker ---
+
+// State shared by all consumers of one run. 'seen' holds one flag per item
+// (producers * items_per_producer); it and 'dequeued' may live in memory shared
+// between processes.
+typedef struct {
+    _Atomic(bool)     *seen;
+    _Atomic(uint64_t) *dequeued;
+    int                producers;
+    uint64_t           items_per_producer;
+} item_check_t;
+
+// One consumer's view: the last sequence number it saw from each producer.
+typedef struct {
+    uint64_t last_seen[ITEM_CHECK_MAX_PRODUCERS];
+} item_order_t;
+
+static inline uint64_t
+item_check_total(item_check_t const *check) {
+    return (uint64_t) check->producers * check->items_per_producer;
+}
+
+static inline void
+item_check_reset(item_check_t const *check) {
+    for (uint64_t i = 0; i < item_check_total(check); i++) {
+        atomic_store_explicit(&check->seen[i], false, memory_order_relaxed);
+    }
+    atomic_store(check->dequeued, 0);
+}
+
+// True while some item has not been consumed yet.
+static inline bool
+item_check_pending(item_check_t const *check) {
+    return atomic_load_explicit(check->dequeued, memory_order_acquire) < item_check_total(check);
+}
+
+static inline void
+item_order_init(item_order_t *order) {
+    for (int p = 0; p < ITEM_CHECK_MAX_PRODUCERS; p++) {
+        order->last_seen[p] = UINT64_MAX;
+    }
+}
+
+// Records 'item' as dequeued by 'consumer'. Aborts if the item is invalid,
+// out of order for its producer, or already seen.
+static inline void
+item_check_consume(item_check_t const *check, item_order_t *order, int consumer, uint64_t item) {
+    uint64_t producer, seq;
+    decode_item_u64(item, &producer, &seq);
+    if (producer >= (uint64_t) check->producers || seq >= check->items_per_producer) {
+        fprintf(stderr, "FATAL ERROR: Consumer %d dequeued invalid item %w64u\n", consumer, item);
+        abort();
+    }
+    if (order->last_seen[producer] != UINT64_MAX && seq <= order->last_seen[producer]) {
+        fprintf(
+            stderr,
+            "FATAL ERROR (Order): Consumer %d saw producer %w64u item %w64u after %w64u\n",
+            consumer,
+            producer,
+            seq,
+            order->last_seen[producer]
+        );
+        abort();
+    }
+    order->last_seen[producer] = seq;
+
+    uint64_t const id          = producer * check->items_per_producer + seq;
+    if (atomic_exchange_explicit(&check->seen[id], true, memory_order_acq_rel)) {
+        fprintf(stderr, "FATAL ERROR (Duplicate): Consumer %d dequeued ID %w64u twice\n", consumer, id);
+        abort();
+    }
+    atomic_fetch_add_explicit(check->dequeued, 1, memory_order_acq_rel);
+}
+
+// After the run: true if every item was consumed. Reports the first missing
+// one otherwise.
+static inline bool
+item_check_complete(item_check_t const *check) {
+    uint64_t const total    = item_check_total(check);
+    uint64_t const dequeued = atomic_load(check->dequeued);
+    if (dequeued != total) {
+        fprintf(stderr, "ERROR: Count mismatch! Expected %w64u, Got %w64u.\n", total, dequeued);
+        return false;
+    }
+    for (uint64_t i = 0; i < total; i++) {
+        if (!atomic_load_explicit(&check->seen[i], memory_order_relaxed)) {
+            fprintf(stderr, "ERROR (Missed): Item ID %w64u was never dequeued!\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // FAAQ_TEST_COMMON_H